@@ -60,6 +60,8 @@
 
 /* Local includes. */
 #include "led.h"
+#include "image_confirm.h"
+#include "boot_record.h"
 
 /* AWS library includes. */
 #include "iot_system_init.h"
@@ -174,6 +176,12 @@ static void prvMiscInitialization( void )
     printf("**Booting to Blinky Application.");
     printf("Version: %d.%d.%d ** \r\n \r\n", APP_VERSION_MAJOR, APP_VERSION_MINOR, APP_VERSION_BUILD );
 
+    /* Print the boot timings handed over by the bootloader. */
+    boot_record_print();
+
+    /* Run the health check of this image if it is on trial. */
+    image_confirm_start();
+
 }
 
 /**
@@ -232,6 +240,9 @@ void vApplicationIdleHook( void )
 {
     /* Toggle the led. */
     toggle_user_led((const uint32_t)LED_TOGGLE_INTERVAL_MS);
+
+    /* Heartbeat of the image health check: no task starves the CPU. */
+    image_confirm_report(IMAGE_CONFIRM_CHECK_IDLE);
 }
 /*-----------------------------------------------------------*/
 /**
@@ -343,6 +354,7 @@ static void prvWifiConnect(void)
     }
 
     configPRINTF(("Wi-Fi configuration successful. \r\n"));
+    image_confirm_report(IMAGE_CONFIRM_CHECK_NETWORK);
     vTaskDelay( mainLOGGING_WIFI_STATUS_DELAY);
 }
 
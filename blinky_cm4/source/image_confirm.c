@@ -0,0 +1,224 @@
+/******************************************************************************
+* File Name: image_confirm.c
+*
+* Description: This file contains the health check of this image while the
+* bootloader runs it on trial with the watchdog running. The application
+* reports its health checks with image_confirm_report(). The check task
+* services the watchdog only in the periods where the heartbeats were
+* reported, and confirms the image (boot_set_confirmed()) once all the checks
+* passed for IMAGE_CONFIRM_HEALTHY_MS. The watchdog is then disabled. If the
+* image is not confirmed within IMAGE_CONFIRM_TIMEOUT_MS, or a heartbeat
+* stops, the watchdog resets the device into the bootloader, which counts the
+* trial attempt.
+*
+*******************************************************************************
+* (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software ("EULA").
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress's integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* FreeRTOS header file. */
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <stdio.h>
+
+#include "cy_pdl.h"
+#include "sysflash/sysflash.h"
+#include "bootutil/bootutil.h"
+
+#include "boot_record.h"
+#include "image_confirm.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define IMAGE_CONFIRM_TASK_STACK_SIZE   (configMINIMAL_STACK_SIZE * 4)
+
+/* Just above the idle task: the check itself doesn't run if a task starves
+ * the CPU.
+ */
+#define IMAGE_CONFIRM_TASK_PRIORITY     (tskIDLE_PRIORITY + 1)
+
+/* Check period. Must be shorter than the watchdog reset time. */
+#define IMAGE_CONFIRM_POLL_MS           (1000u)
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Health checks reported since the last check period. */
+static volatile uint32_t image_confirm_checks;
+
+/*******************************************************************************
+* Function Name: is_image_confirmed
+********************************************************************************
+* Summary:
+*  Reads the image_ok flag of the primary slot trailer.
+*
+* Return:
+*  true if the image has been confirmed.
+*
+*******************************************************************************/
+static bool is_image_confirmed(void)
+{
+    struct boot_swap_state state;
+
+    return (boot_read_swap_state_by_id(FLASH_AREA_IMAGE_PRIMARY(0), &state) == 0) &&
+           (state.image_ok == BOOT_FLAG_SET);
+}
+
+/*******************************************************************************
+* Function Name: image_confirm_take_checks
+********************************************************************************
+* Summary:
+*  Returns the health checks reported so far, and clears the heartbeats for
+*  the next check period.
+*
+* Return:
+*  IMAGE_CONFIRM_CHECK_xxx flags.
+*
+*******************************************************************************/
+static uint32_t image_confirm_take_checks(void)
+{
+    uint32_t checks;
+
+    taskENTER_CRITICAL();
+    checks = image_confirm_checks;
+    image_confirm_checks &= ~IMAGE_CONFIRM_HEARTBEATS;
+    taskEXIT_CRITICAL();
+
+    return checks;
+}
+
+/*******************************************************************************
+* Function Name: image_confirm_task
+********************************************************************************
+* Summary:
+*  Runs the health check of the image on trial every IMAGE_CONFIRM_POLL_MS.
+*  The watchdog is serviced if the heartbeats were reported in the period,
+*  and the image is confirmed once all the checks passed for
+*  IMAGE_CONFIRM_HEALTHY_MS.
+*
+* Parameters:
+*  arg - unused
+*
+*******************************************************************************/
+static void image_confirm_task(void *arg)
+{
+    TickType_t start = xTaskGetTickCount();
+    uint32_t healthy_ms = 0;
+    uint32_t checks;
+
+    (void)arg;
+
+    for (;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(IMAGE_CONFIRM_POLL_MS));
+
+        checks = image_confirm_take_checks();
+
+        if ((checks & IMAGE_CONFIRM_HEARTBEATS) != IMAGE_CONFIRM_HEARTBEATS)
+        {
+            /* Not serviced: the watchdog resets the device if it lasts. */
+            printf("Image health check failed (0x%x).\r\n", (unsigned)checks);
+            healthy_ms = 0;
+            continue;
+        }
+
+        Cy_WDT_ClearWatchdog();
+
+        healthy_ms = ((checks & IMAGE_CONFIRM_CHECKS_ALL) == IMAGE_CONFIRM_CHECKS_ALL) ?
+                     (healthy_ms + IMAGE_CONFIRM_POLL_MS) : 0u;
+
+        if ((healthy_ms >= IMAGE_CONFIRM_HEALTHY_MS) &&
+            (boot_set_confirmed() == 0) && is_image_confirmed())
+        {
+            Cy_WDT_Unlock();
+            Cy_WDT_Disable();
+            Cy_WDT_Lock();
+            printf("Image confirmed, watchdog disabled.\r\n");
+            break;
+        }
+
+        if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(IMAGE_CONFIRM_TIMEOUT_MS))
+        {
+            /* Let the watchdog reset the device. */
+            printf("Image not confirmed in %u ms, waiting for watchdog reset.\r\n",
+                   (unsigned)IMAGE_CONFIRM_TIMEOUT_MS);
+            break;
+        }
+    }
+
+    vTaskDelete(NULL);
+}
+
+/*******************************************************************************
+* Function Name: image_confirm_report
+********************************************************************************
+* Summary:
+*  Reports health checks of the application. A heartbeat is reported in each
+*  check period, e.g. from a loop of the task it covers; the other checks
+*  once they pass. Can be called from the idle hook.
+*
+* Parameters:
+*  checks - IMAGE_CONFIRM_CHECK_xxx flags.
+*
+*******************************************************************************/
+void image_confirm_report(uint32_t checks)
+{
+    if ((image_confirm_checks & checks) != checks)
+    {
+        taskENTER_CRITICAL();
+        image_confirm_checks |= checks;
+        taskEXIT_CRITICAL();
+    }
+}
+
+/*******************************************************************************
+* Function Name: image_confirm_start
+********************************************************************************
+* Summary:
+*  Starts the health check task if the bootloader reports that this image is
+*  on trial. Call before the scheduler is started.
+*
+*******************************************************************************/
+void image_confirm_start(void)
+{
+    const boot_record_t *record = boot_record_get();
+
+    if ((record != NULL) && ((record->flags & BOOT_RECORD_FLAG_TRIAL) != 0u))
+    {
+        /* Clear the count accumulated since the bootloader enabled it. */
+        Cy_WDT_ClearWatchdog();
+
+        (void)xTaskCreate(image_confirm_task, "ImgConfirm",
+                          IMAGE_CONFIRM_TASK_STACK_SIZE, NULL,
+                          IMAGE_CONFIRM_TASK_PRIORITY, NULL);
+    }
+}
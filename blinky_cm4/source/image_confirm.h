@@ -0,0 +1,70 @@
+/******************************************************************************
+* File Name: image_confirm.h
+*
+* Description: This file contains the declarations of the health check that
+* services the watchdog and confirms this image while the bootloader runs it
+* on trial.
+*
+*******************************************************************************
+* (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software ("EULA").
+*
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress's integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SOURCE_IMAGE_CONFIRM_H_
+#define SOURCE_IMAGE_CONFIRM_H_
+
+#include <stdint.h>
+
+/* Health checks reported by the application with image_confirm_report().
+ * A heartbeat must be reported again in each check period; the other checks
+ * are reported once.
+ */
+#define IMAGE_CONFIRM_CHECK_IDLE        (1u << 0)   /* Heartbeat: the idle task runs. */
+#define IMAGE_CONFIRM_CHECK_NETWORK     (1u << 1)   /* Connected to the Wi-Fi AP. */
+
+#define IMAGE_CONFIRM_HEARTBEATS        (IMAGE_CONFIRM_CHECK_IDLE)
+#define IMAGE_CONFIRM_CHECKS_ALL        (IMAGE_CONFIRM_CHECK_IDLE | IMAGE_CONFIRM_CHECK_NETWORK)
+
+/* Time given to the image to confirm itself, in milliseconds. */
+#ifndef IMAGE_CONFIRM_TIMEOUT_MS
+#define IMAGE_CONFIRM_TIMEOUT_MS        (300000u)
+#endif
+
+/* Time all the checks must pass before the image is confirmed, in
+ * milliseconds.
+ */
+#ifndef IMAGE_CONFIRM_HEALTHY_MS
+#define IMAGE_CONFIRM_HEALTHY_MS        (30000u)
+#endif
+
+void image_confirm_start(void);
+void image_confirm_report(uint32_t checks);
+
+#endif /* SOURCE_IMAGE_CONFIRM_H_ */
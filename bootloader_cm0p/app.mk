@@ -82,6 +82,7 @@ SOURCES+=\
 
 INCLUDES+=\
     ./config\
+    ../common/include\
     ./config/mcuboot_config\
     $(MCUBOOT_PATH)/boot/bootutil/include\
     $(MCUBOOT_PATH)/boot/bootutil/src\
@@ -117,4 +118,40 @@ INCLUDES+=\
     $(MBEDTLS_PATH)/include\
     $(MBEDTLS_PATH)/include/mbedtls\
     $(MBEDTLS_PATH)/crypto/include\
-    $(MBEDTLS_PATH)/crypto/include/mbedtls
\ No newline at end of file
+    $(MBEDTLS_PATH)/crypto/include/mbedtls
+
+################################################################################
+# Crypto backend
+################################################################################
+
+# MCUboot implements the ECDSA P-256 verification in bootutil (tinycrypt) and
+# in MCUBootApp (mbedTLS); keep the one of the selected backend. The mbedTLS
+# ASN.1 parser is used by both to read the public keys.
+ifeq ($(CRYPTO_BACKEND), TINYCRYPT)
+TINYCRYPT_PATH=$(MCUBOOT_PATH)/ext/tinycrypt/lib
+
+SOURCES:=$(filter-out $(MCUBOOTAPP_PATH)/image_ec256_mbedtls.c, $(SOURCES))
+SOURCES+=\
+    $(wildcard $(TINYCRYPT_PATH)/source/*.c)
+
+INCLUDES+=\
+    $(TINYCRYPT_PATH)/include
+else
+SOURCES:=$(filter-out $(MCUBOOT_PATH)/boot/bootutil/src/image_ec256.c, $(SOURCES))
+
+# With EN_EC_PRECOMP=1, bootutil_verify_sig() is implemented by
+# source/ec_precomp.c, with the keys decoded at build time.
+ifeq ($(EN_EC_PRECOMP), 1)
+SOURCES:=$(filter-out $(MCUBOOTAPP_PATH)/image_ec256_mbedtls.c, $(SOURCES))
+endif
+
+# MCUboot unwraps the key of encrypted images (MCUBOOT_ENCRYPT_EC256) with
+# tinycrypt, whatever the crypto backend.
+ifeq ($(EN_ENC_IMAGES), 1)
+TINYCRYPT_PATH=$(MCUBOOT_PATH)/ext/tinycrypt/lib
+SOURCES+=\
+    $(wildcard $(TINYCRYPT_PATH)/source/*.c)
+INCLUDES+=\
+    $(TINYCRYPT_PATH)/include
+endif
+endif
\ No newline at end of file
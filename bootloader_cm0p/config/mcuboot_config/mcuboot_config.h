@@ -34,9 +34,13 @@
 /* Uncomment for RSA signature support */
 //#define MCUBOOT_SIGN_RSA
 
-/* Uncomment for ECDSA signatures using curve P-256. */
-// #define MCUBOOT_SIGN_EC256
-// #define NUM_ECC_BYTES (256 / 8)     // P-256 curve size in bytes, rnok: to make compilable
+/* ECDSA signatures using curve P-256. Selected with EN_SIGN_EC256 in
+ * common/make_support/shared_config.mk, which also signs the CM4 apps.
+ */
+#ifdef CY_BOOT_SIGN_EC256
+#define MCUBOOT_SIGN_EC256
+#define NUM_ECC_BYTES (256 / 8)     // P-256 curve size in bytes
+#endif
 
 // #define MCUBOOT_SIGN_EC
 
@@ -48,8 +52,29 @@
  * existing image with the update image, is also available.
  */
 
-/* Uncomment to enable the overwrite-only code path. */
+/* Selected with MCUBOOT_UPGRADE_MODE in common/make_support/shared_config.mk:
+ * overwrite-only by default, or swap-using-move. Swap-using-move needs no
+ * scratch area; the sectors of the image slots are reported in units of the
+ * external memory erase size (see ext_flash_map.c).
+ */
+#ifdef CY_BOOT_SWAP_MOVE
+#define MCUBOOT_SWAP_USING_MOVE 1
+#else
 #define MCUBOOT_OVERWRITE_ONLY
+#endif
+
+/*
+ * Encrypted images
+ *
+ * Selected with EN_ENC_IMAGES in the Makefile. The images in the secondary
+ * slot are encrypted with AES-128-CTR, the key being wrapped with ECIES-P256
+ * (imgtool --encrypt). MCUboot decrypts them while they are installed; the
+ * private key is generated from ENC_KEY by common/script/enc_key.py.
+ */
+#ifdef CY_BOOT_ENC_IMAGES
+#define MCUBOOT_ENC_IMAGES
+#define MCUBOOT_ENCRYPT_EC256
+#endif
 
 #ifdef MCUBOOT_OVERWRITE_ONLY
 /* Uncomment to only erase and overwrite those slot 0 sectors needed
@@ -65,10 +90,14 @@
  * available.
  */
 
-/* Uncomment to use ARM's mbedTLS cryptographic primitives */
+/* Selected with CRYPTO_BACKEND in the Makefile: ARM's mbedTLS (software or
+ * with the Crypto block) by default, or Tinycrypt.
+ */
+#ifdef CY_BOOT_USE_TINYCRYPT
+#define MCUBOOT_USE_TINYCRYPT
+#else
 #define MCUBOOT_USE_MBED_TLS
-/* Uncomment to use Tinycrypt's. */
-/* #define MCUBOOT_USE_TINYCRYPT */
+#endif
 
 /*
  * Always check the signature of the image in slot 0 before booting,
@@ -140,9 +169,18 @@
  * "assert" is used. */
 //#define MCUBOOT_HAVE_ASSERT_H
 
+/*
+ * Watchdog feeding
+ *
+ * Feeds the PSoC 6 WDT. MCUboot calls this between the flash operations of
+ * an upgrade, and the bootloader calls it between the erase/program steps
+ * of a rollback. It has no effect when the WDT is not enabled.
+ */
+#include "cy_wdt.h"
+
 #define MCUBOOT_WATCHDOG_FEED()         \
     do {                                \
-        /* TODO: to be implemented */   \
+        Cy_WDT_ClearWatchdog();         \
     } while (0)
 
 #endif /* MCUBOOT_CONFIG_H */
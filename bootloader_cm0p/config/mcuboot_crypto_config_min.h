@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2020 Cypress Semiconductor Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file    mcuboot_crypto_config_min.h
+ *
+ * \brief   Minimal mbed TLS configuration of the bootloader (EN_MIN_CRYPTO=1).
+ *
+ * Only the primitives used by the bootloader are enabled: SHA-256 for the
+ * image hash, ECDSA P-256 signature verification, and HMAC-SHA256 for the
+ * key derivation of encrypted images. Use mcuboot_crypto_config.h (EN_MIN_CRYPTO=0) for other
+ * signature types, e.g. MCUBOOT_SIGN_RSA.
+ */
+
+#ifndef MBEDTLS_CONFIG_H
+#define MBEDTLS_CONFIG_H
+
+/* System support */
+#define MBEDTLS_HAVE_ASM
+
+/* mbed TLS feature support */
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECP_NIST_OPTIM
+
+/* mbed TLS modules */
+#define MBEDTLS_ASN1_PARSE_C        /* Public key and signature parsing. */
+#define MBEDTLS_ASN1_WRITE_C        /* Required by MBEDTLS_ECDSA_C. */
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_ECP_C
+#define MBEDTLS_MD_C                /* HMAC of the key derivation of encrypted images. */
+#define MBEDTLS_OID_C
+#define MBEDTLS_SHA256_C
+
+/* Encrypted images (EN_ENC_IMAGES=1): AES-128-CTR decryption of the images. */
+#ifdef CY_BOOT_ENC_IMAGES
+#define MBEDTLS_AES_C
+#define MBEDTLS_CIPHER_MODE_CTR
+#endif
+
+/* Module configuration: P-256 is the largest group used. */
+#define MBEDTLS_MPI_MAX_SIZE        32
+#define MBEDTLS_ECP_MAX_BITS        256
+
+/* Target and application specific configurations (crypto acceleration). */
+#if defined(MBEDTLS_USER_CONFIG_FILE)
+#include MBEDTLS_USER_CONFIG_FILE
+#endif
+
+#include "mbedtls/check_config.h"
+
+#endif /* MBEDTLS_CONFIG_H */
@@ -42,6 +42,7 @@
 
 /* Standard headers. */
 #include <stdio.h>
+#include <string.h>
 
 /* Driver header files. */
 #include "cy_pdl.h"
@@ -54,15 +55,35 @@
 #include "cycfg_pins.h"
 
 /* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
 #include "bootutil/image.h"
 #include "bootutil/bootutil.h"
 #include "bootutil/sign_key.h"
 #include "bootutil/bootutil_log.h"
+#include "bootutil_priv.h"
 
 /*  Flash access headers. */
 #include "flash_map_backend/flash_map_backend.h"
 #include "cy_smif_psoc6.h"
 #include "sysflash.h"
+#include "ext_flash_map.h"
+
+/* Local headers. */
+#include "boot_timer.h"
+#include "boot_trace.h"
+#include "flash_copy.h"
+#include "image_info.h"
+#include "image_verify.h"
+#include "lz_stream.h"
+#include "qspi_info.h"
+#include "qspi_cache.h"
+#include "smif_cache.h"
+#include "crypto_bench.h"
+#include "rollback_journal.h"
+#include "delta_patch.h"
+#include "lkg_slot.h"
+#include "trial_boot.h"
+#include "enc_image.h"
 
 /*******************************************************************************
 * Macros
@@ -83,6 +104,21 @@
 /* Button status: GPIO will read LOW, if pressed. */
 #define USER_BTN_PRESSED        (0)
 
+/* Round a size up/down to a multiple of the internal flash row size. */
+#define ROW_ALIGN_UP(x)         (((x) + CY_FLASH_SIZEOF_ROW - 1UL) & ~(CY_FLASH_SIZEOF_ROW - 1UL))
+#define ROW_ALIGN_DOWN(x)       ((x) & ~(CY_FLASH_SIZEOF_ROW - 1UL))
+
+/* Mask of all the images updated by MCUboot, bit n for image n. */
+#define ALL_IMAGES_MASK         ((1UL << MCUBOOT_IMAGE_NUMBER) - 1UL)
+
+/* The fused verification boots the copied image without boot_go(). Without
+ * image signatures it would accept the image on its SHA-256 alone: it is
+ * only used when the signature is checked as well.
+ */
+#if defined(CY_BOOT_FUSED_VERIFY) && defined(MCUBOOT_SIGN_EC256)
+#define ROLLBACK_FUSED_VERIFY
+#endif
+
 /* User button interrupt configurations.  */
 static cy_stc_sysint_t user_btn_isr_cfg =
 {
@@ -96,12 +132,45 @@ static cy_stc_sysint_t user_btn_isr_cfg =
 ********************************************************************************/
 static volatile bool is_user_button_pressed = false ;
 
+#ifdef CY_BOOT_TRIAL_BOOT
+/* Set when CM4 is started with an image on trial. */
+static bool is_trial_boot = false;
+#endif
+
+/* Offset of the primary slot from which the ongoing transfer started. */
+static uint32_t transfer_start_off = 0;
+
+/* Decompressor state, used when the factory app is stored compressed. */
+static lz_stream_t fact_lz_stream;
+
+#ifdef CY_BOOT_ENC_IMAGES
+/* Decryption state, used when the factory app is encrypted. */
+static enc_image_t fact_enc;
+#endif
+
+#ifdef ROLLBACK_FUSED_VERIFY
+/* State of the verification fused with the factory app transfer. */
+static image_verify_t fact_verify;
+#endif
+
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+/* State of the verification of the primary slots after boot_go() failed. */
+static image_verify_t check_verify;
+#endif
+
 /*******************************************************************************
 * Function Prototypes
 ********************************************************************************/
-static cy_rslt_t transfer_factory_image(void);
+static void transfer_progress_callback(uint32_t bytes_done, uint32_t bytes_total);
+static void get_factory_flash_area(uint32_t image, struct flash_area *fap);
+static cy_rslt_t transfer_image(uint32_t image, uint32_t images, uint32_t source,
+                                struct boot_rsp *rsp);
 static void do_boot(struct boot_rsp *rsp, char *msg);
-static void rollback_to_factory_image(void);
+static void rollback_to_image(uint32_t images, uint32_t source);
+static void do_rollback(uint32_t images, uint32_t source);
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+static uint32_t get_invalid_images(void);
+#endif
 static void user_button_callback(void);
 static void deinit_hw(void);
 
@@ -134,43 +203,148 @@ static void deinit_hw(void)
     Cy_GPIO_Port_Deinit(CYBSP_UART_RX_PORT);
     Cy_GPIO_Port_Deinit(CYBSP_UART_TX_PORT);
     qspi_deinit(QSPI_SLAVE_SELECT_LINE);
+
+#ifdef CY_BOOT_USE_WDT
+    /* CM4 applications of this example do not service the WDT. */
+    Cy_WDT_Disable();
+#endif
+
+#ifdef CY_BOOT_TRIAL_BOOT
+    /* An image on trial is started with the WDT running. The CM4 app services
+     * it until the image is confirmed: a hang resets the device and the next
+     * boot is counted as another attempt.
+     */
+    if (is_trial_boot)
+    {
+        Cy_WDT_Init();
+        Cy_WDT_Enable();
+    }
+#endif
 }
 
 /******************************************************************************
- * Function Name: transfer_factory_image
+ * Function Name: get_factory_flash_area
  ******************************************************************************
  * Summary:
- *  This function does a simple sanity check on factory app and transfers it 
- *  from external memory to primary slot, if found valid. 
- *  Asserts on critical errors.
+ *  Factory app is stored in external flash. Flash map doesn't have any
+ *  flash_area entry for the factory app. To be compatible with MCUboot
+ *  smif wrappers, this function populates a dummy flash_area structure with
+ *  necessary details. With two images, each image has its own factory app.
+ *  Note: For read operation, "fa_device_id", "fa_off" and "fa_size" are
+ *  sufficient. Just populating them.
  *
  * Parameters:
- *  none
+ *  image - Index of the image.
+ *  fap   - Flash area structure to be populated.
+ *
+ ******************************************************************************/
+static void get_factory_flash_area(uint32_t image, struct flash_area *fap)
+{
+    memset(fap, 0, sizeof(*fap));
+    fap->fa_device_id = FLASH_DEVICE_EXTERNAL_FLASH(CY_BOOT_EXTERNAL_DEVICE_INDEX);
+    fap->fa_off = CY_SMIF_BASE_MEM_OFFSET;
+    fap->fa_size = CY_FACT_APP_SIZE;
+
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+    if (image == 1UL)
+    {
+        fap->fa_off += CY_FACT_APP_2_OFFSET;
+        fap->fa_size = CY_FACT_APP_2_SIZE;
+    }
+#else
+    (void)image;
+#endif
+}
+
+/******************************************************************************
+ * Function Name: transfer_progress_callback
+ ******************************************************************************
+ * Summary:
+ *  Progress callback of the copy engine, invoked once per erase unit.
+ *  Commits the progress to the rollback journal and reports the progress of
+ *  the transfer in steps of 10%.
+ *
+ * Parameters:
+ *  bytes_done  - Number of bytes written to primary slot by the copy engine.
+ *  bytes_total - Number of bytes to be written by the copy engine.
+ *
+ ******************************************************************************/
+static void transfer_progress_callback(uint32_t bytes_done, uint32_t bytes_total)
+{
+    static uint32_t last_percent = 0;
+    uint32_t percent = (uint32_t)(((uint64_t)(transfer_start_off + bytes_done) * 100ULL) /
+            (transfer_start_off + bytes_total));
+
+    /* Journal updates are amortized over ROLLBACK_JOURNAL_STRIDE bytes. */
+    rollback_journal_commit(transfer_start_off + bytes_done);
+
+    if ((bytes_done == 0) || ((percent / 10UL) != (last_percent / 10UL)))
+    {
+        BOOT_LOG_INF("Transferred %3u%%", (unsigned int)percent);
+    }
+
+    last_percent = percent;
+}
+
+/******************************************************************************
+ * Function Name: transfer_image
+ ******************************************************************************
+ * Summary:
+ *  This function parses the header and TLV area of the factory app, or of the
+ *  last-known-good image, and transfers it from external memory to primary
+ *  slot, if found valid. Only
+ *  the rows covering the image and the image trailer are erased and copied.
+ *  A compressed factory app (see lz_stream.h) is decompressed on the fly, and
+ *  an encrypted one (see enc_image.h) is decrypted on the fly.
+ *  With CY_BOOT_FUSED_VERIFY and image signatures enabled, the image is also
+ *  hashed as it is copied and its hash and signature are verified against
+ *  its TLVs without a second pass over the primary slot.
+ *  Asserts on critical errors. A last-known-good image that can't be parsed
+ *  is reported to the caller instead, before anything is written.
+ *
+ * Parameters:
+ *  image  - Index of the image to be restored.
+ *  images - Mask of the images restored by the ongoing rollback, recorded in
+ *           the rollback journal.
+ *  source - Source of the image (ROLLBACK_SOURCE_xxx).
+ *  rsp    - Filled with the boot response when image 0 was verified while
+ *           being copied. "br_hdr" is left untouched otherwise.
  *
  * Return
  * status of operation cy_rslt_t
  *
  ******************************************************************************/
-static cy_rslt_t transfer_factory_image(void)
+static cy_rslt_t transfer_image(uint32_t image, uint32_t images, uint32_t source,
+                                struct boot_rsp *rsp)
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
     struct flash_area fap_extf;
     const struct flash_area *fap_primary = NULL;
-    uint8_t ram_buf[CY_FLASH_SIZEOF_ROW] = {0};
-    uint32_t index = 0 , bytes_to_copy = 0 , prim_slot_off = 0, fact_img_off = 0 ;
-    uint32_t image_magic = 0 ;
-
-    /* Factory app is stored in external flash. Flash map doesn't have any
-     * flash_area entry for the factory app. To be compatible with MCUboot
-     * smif wrappers, populate a dummy flash_area structure with necessary
-     * details.
-     * Note: For read operation, only "fa_device_id" is sufficient. 
-     * Just populating it.
-     */
-    fap_extf.fa_device_id = FLASH_DEVICE_EXTERNAL_FLASH(CY_BOOT_EXTERNAL_DEVICE_INDEX);
+    struct image_header fact_hdr;
+    lz_stream_hdr_t lz_hdr;
+    flash_copy_src_t copy_src = {0};
+    flash_copy_hooks_t copy_hooks = {0};
+    flash_copy_stats_t copy_stats = {0};
+    uint32_t image_size = 0, bytes_to_copy = 0, trailer_off = 0;
+    const char *name = (source == ROLLBACK_SOURCE_LKG) ? "last-known-good image" : "factory app";
+
+#ifndef ROLLBACK_FUSED_VERIFY
+    (void)rsp;
+#endif
+
+    copy_src.name = name;
+
+    if (source == ROLLBACK_SOURCE_LKG)
+    {
+        lkg_slot_get_area(&fap_extf);
+    }
+    else
+    {
+        get_factory_flash_area(image, &fap_extf);
+    }
 
     /* Open primary slot. */
-    result = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fap_primary);
+    result = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(image), &fap_primary);
 
     if(result != CY_RSLT_SUCCESS)
     {
@@ -179,33 +353,117 @@ static cy_rslt_t transfer_factory_image(void)
         /* Critical error: asserting. */
         CY_ASSERT(0);
     }
+    else if (lz_stream_probe(&fap_extf, &lz_hdr))
+    {
+        /* Compressed factory app: the container holds the image size. The
+         * image itself is validated by MCUboot once it is decompressed.
+         */
+        BOOT_LOG_INF("Compressed '%s' found (%u -> %u bytes)", name,
+                (unsigned int)lz_hdr.comp_size, (unsigned int)lz_hdr.image_size);
+
+        image_size = lz_hdr.image_size;
+        copy_src.read = lz_stream_read;
+        copy_src.ctx = &fact_lz_stream;
+        result = lz_stream_init(&fact_lz_stream, &fap_extf, &lz_hdr);
+    }
     else
     {
-        result = psoc6_smif_read((const struct flash_area *)&fap_extf,
-                CY_SMIF_BASE_MEM_OFFSET, (void *)&image_magic, sizeof(image_magic));
+        /* Parse the header and the TLV area to find the true image size. */
+        copy_src.read = flash_copy_read_area;
+        copy_src.ctx = &fap_extf;
+        result = image_info_read(&fap_extf, &fact_hdr, &image_size);
+
+#ifdef CY_BOOT_ENC_IMAGES
+        /* Encrypted image: the payload is decrypted as it is read, inside
+         * the copy loop. The header and the TLVs are stored in clear.
+         */
+        if ((result == CY_RSLT_SUCCESS) && enc_image_is_encrypted(&fact_hdr))
+        {
+            BOOT_LOG_INF("'%s' is encrypted", name);
+
+            result = enc_image_init(&fact_enc, &fap_extf, &fact_hdr, &copy_src);
+            copy_src.read = enc_image_read;
+            copy_src.ctx = &fact_enc;
+        }
+#endif
     }
 
-    if(result != CY_RSLT_SUCCESS)
+    if ((result != CY_RSLT_SUCCESS) && (source == ROLLBACK_SOURCE_LKG))
     {
-        BOOT_LOG_ERR("Failed to read 'factory app' magic from external memory\r\n");
+        BOOT_LOG_ERR("Failed to parse '%s' in external memory\r\n", name);
 
-        /* Critical error: asserting. */
-        CY_ASSERT(0);
+        /* Nothing was written yet: the caller discards the last-known-good
+         * image and rolls back to the factory app instead.
+         */
+#ifdef CY_BOOT_ENC_IMAGES
+        if (copy_src.read == enc_image_read)
+        {
+            enc_image_free(&fact_enc);
+        }
+#endif
+        flash_area_close(fap_primary);
+
+        return result;
     }
-    else if(image_magic != IMAGE_MAGIC)
+
+    if(result != CY_RSLT_SUCCESS)
     {
-        BOOT_LOG_ERR("Invalid image magic 0x%08x !\r\n", (int)image_magic);
+        BOOT_LOG_ERR("Failed to parse '%s' in external memory\r\n", name);
 
         /* Critical error: asserting. */
         CY_ASSERT(0);
     }
     else
     {
-        BOOT_LOG_INF("Valid image magic found");
-        BOOT_LOG_INF("Erasing primary slot. Please wait for a while...\r\n");
+        BOOT_LOG_INF("Valid '%s' found", name);
+
+        /* Partition size of internal flash and that of external flash
+         * need not be same always. Only the rows covering the image
+         * (header + payload + TLVs) and the image trailer at the end of the
+         * primary slot are erased and written. The rest of the primary slot
+         * is not covered by the image hash and is left untouched.
+         */
+        trailer_off = ROW_ALIGN_DOWN(fap_primary->fa_size -
+                boot_trailer_sz(flash_area_align(fap_primary)));
+
+        /* "trailer_off" is row-aligned: comparing the unaligned size also
+         * rejects the sizes for which ROW_ALIGN_UP() wraps around.
+         */
+        bytes_to_copy = ROW_ALIGN_UP(image_size);
+
+        if (image_size > trailer_off)
+        {
+            BOOT_LOG_ERR("'%s' of %u bytes doesn't fit primary slot !", name,
+                    (unsigned int)image_size);
+
+            /* Critical error: asserting. */
+            CY_ASSERT(0);
+        }
+
+        BOOT_LOG_INF("Image size %u bytes, erasing 0x%x bytes of primary slot.",
+                (unsigned int)image_size,
+                (unsigned int)(bytes_to_copy + fap_primary->fa_size - trailer_off));
+
+        /* Resume an interrupted transfer of the same image, if any.
+         * Otherwise, record the start of a new transfer in the journal.
+         */
+        transfer_start_off = 0;
+
+        if (rollback_journal_get_resume(image, source, bytes_to_copy, &transfer_start_off))
+        {
+            BOOT_LOG_INF("Resuming transfer from offset 0x%x",
+                    (unsigned int)transfer_start_off);
+        }
+        else if (rollback_journal_start(image, images, source, bytes_to_copy) != CY_RSLT_SUCCESS)
+        {
+            BOOT_LOG_WRN("Failed to start rollback journal, transfer can't be resumed");
+        }
 
-        /* Erase primary slot completely. */
-        result = flash_area_erase(fap_primary, 0, fap_primary->fa_size);
+        /* Erase the trailer of the primary slot. The image area is erased
+         * by the copy engine, one subsector just before it is written.
+         */
+        result = flash_area_erase(fap_primary, trailer_off,
+                fap_primary->fa_size - trailer_off);
     }
 
     if (result != CY_RSLT_SUCCESS)
@@ -217,62 +475,93 @@ static cy_rslt_t transfer_factory_image(void)
     }
     else
     {
-        /* Initialize the parameters required for copy operation.
-         * Partition size of internal flash and that of external flash
-         * need not be same always. External flash might have bigger size
-         * reserved for factory application  than the primary slot size.
-         * However, image can't be larger than that of primary partition size.
-         * So, always copy "fap_primary->fa_size" bytes from external flash to
-         * primary slot during Rollback.
-         */
-        bytes_to_copy = fap_primary->fa_size;
-        fact_img_off = CY_SMIF_BASE_MEM_OFFSET;
-        prim_slot_off = 0;
-
-        BOOT_LOG_INF("Transferring 'factory app' to 'primary slot'");
+        BOOT_LOG_INF("Transferring '%s' to 'primary slot'", name);
         BOOT_LOG_INF("Please wait for a while...\r\n");
 
-        /* Copy factory app to primary slot.
-         * Read from external memory and then write to primary slot in
-         * chunks of "CY_FLASH_SIZEOF_ROW" bytes. status of the transfer will be
-         * returned to caller.
+        /* Copy the image to primary slot.
+         * The copy engine erases the primary slot one subsector at a time,
+         * reads (and decompresses, if needed) from external memory and writes
+         * to primary slot in chunks of "CY_FLASH_SIZEOF_ROW" bytes.
+         * Rows of primary slot that already hold the image are not
+         * erased nor programmed with CY_BOOT_SKIP_UNCHANGED.
+         * A resumed transfer of a compressed image decompresses and
+         * drops the bytes below "transfer_start_off".
+         * Status of the transfer will be returned to caller.
          */
-        CY_ASSERT((bytes_to_copy % CY_FLASH_SIZEOF_ROW) == 0);
-        while (index < bytes_to_copy)
-        {
-            /* Read from QSPI. */
-            result = psoc6_smif_read((const struct flash_area *) &fap_extf,
-                    fact_img_off, ram_buf, CY_FLASH_SIZEOF_ROW);
-            if (result != CY_RSLT_SUCCESS)
-            {
-                BOOT_LOG_ERR("failed to read factory app @ offset 0x%8x",
-                        (int )fact_img_off);
-                break;
-            }
+        copy_hooks.progress_cb = transfer_progress_callback;
 
-            /* Write to Internal flash. */
-            result = flash_area_write(fap_primary, prim_slot_off, ram_buf, CY_FLASH_SIZEOF_ROW);
+#ifdef ROLLBACK_FUSED_VERIFY
+        /* A resumed transfer doesn't stream the whole image: it is left to
+         * boot_go() for verification.
+         */
+        if (transfer_start_off == 0)
+        {
+            image_verify_start(&fact_verify);
+            copy_hooks.row_cb = image_verify_row;
+            copy_hooks.row_ctx = &fact_verify;
+        }
+#endif
 
-            if (result != CY_RSLT_SUCCESS)
-            {
-                BOOT_LOG_ERR("failed to write primary slot @ offset 0x%8x",
-                        (int )prim_slot_off);
-                break;
-            }
+        result = flash_copy_to_int(&copy_src, transfer_start_off, fap_primary,
+                transfer_start_off, bytes_to_copy - transfer_start_off,
+                &copy_hooks, &copy_stats);
+    }
 
-            fact_img_off += CY_FLASH_SIZEOF_ROW;
-            prim_slot_off += CY_FLASH_SIZEOF_ROW;
-            index += CY_FLASH_SIZEOF_ROW;
+#ifdef ROLLBACK_FUSED_VERIFY
+    if ((result == CY_RSLT_SUCCESS) && (copy_hooks.row_cb != NULL))
+    {
+        /* The primary slot is memory-mapped: read it back with a CRC only.
+         * With two images, boot_go() runs after the rollback in any case.
+         */
+        if ((image_verify_check(&fact_verify, fap_primary, bytes_to_copy) == CY_RSLT_SUCCESS) &&
+            (image_verify_readback(&fact_verify, fap_primary->fa_off, bytes_to_copy) ==
+             CY_RSLT_SUCCESS) && (MCUBOOT_IMAGE_NUMBER == 1))
+        {
+            rsp->br_hdr = &fact_verify.hdr;
+            rsp->br_flash_dev_id = fap_primary->fa_device_id;
+            rsp->br_image_off = fap_primary->fa_off;
+        }
+        else
+        {
+            BOOT_LOG_WRN("Fused verification failed, falling back to boot_go()");
         }
     }
+#endif
 
     /* Cleanup the resources acquired. */
     flash_area_close(fap_primary);
 
+#ifdef CY_BOOT_ENC_IMAGES
+    if (copy_src.read == enc_image_read)
+    {
+        enc_image_free(&fact_enc);
+    }
+#endif
+
     if (result == CY_RSLT_SUCCESS)
     {
         /* Copy operation is successful. */
-        BOOT_LOG_INF("factory app copied to primary slot successfully");
+        BOOT_LOG_INF("%s copied to primary slot successfully", name);
+        flash_copy_print_stats(&copy_stats);
+        boot_trace_add_rows((copy_stats.bytes_copied - copy_stats.bytes_blank -
+                             copy_stats.bytes_unchanged) / CY_FLASH_SIZEOF_ROW,
+                            copy_stats.bytes_blank / CY_FLASH_SIZEOF_ROW,
+                            copy_stats.bytes_unchanged / CY_FLASH_SIZEOF_ROW);
+
+#ifdef CY_BOOT_ENC_IMAGES
+        if (copy_src.read == enc_image_read)
+        {
+            BOOT_LOG_INF("Key unwrapped in %u us, decryption took %u us of the copy (%u%%)",
+                    (unsigned int)fact_enc.unwrap_us, (unsigned int)fact_enc.decrypt_us,
+                    (unsigned int)((copy_stats.elapsed_us != 0UL) ?
+                    (((uint64_t)fact_enc.decrypt_us * 100ULL) / copy_stats.elapsed_us) : 0UL));
+        }
+#endif
+
+        if (rollback_journal_complete() != CY_RSLT_SUCCESS)
+        {
+            BOOT_LOG_WRN("Failed to complete rollback journal");
+        }
     }
 
     return result;
@@ -297,10 +586,19 @@ static void do_boot(struct boot_rsp *rsp, char *msg)
     CY_ASSERT(msg != NULL);
 
     BOOT_LOG_INF("Starting %s on CM4. Please wait...", msg);
+    boot_trace_print();
 
+    boot_trace_start(BOOT_STAGE_CM4_DELAY);
     cy_retarget_io_wait_tx_complete(CYBSP_UART_HW, CM4_BOOT_DELAY_MS);
+    boot_trace_end(BOOT_STAGE_CM4_DELAY);
 
+    boot_trace_start(BOOT_STAGE_DEINIT);
     deinit_hw();
+    boot_trace_end(BOOT_STAGE_DEINIT);
+
+    /* Publish the boot timings to CM4 and stop the boot timer. */
+    boot_trace_publish();
+    boot_timer_deinit();
 
     Cy_SysEnableCM4(app_addr);
 
@@ -311,44 +609,198 @@ static void do_boot(struct boot_rsp *rsp, char *msg)
 }
 
 /******************************************************************************
- * Function Name: rollback_to_factory_image
+ * Function Name: rollback_to_image
  ******************************************************************************
  * Summary:
- *  This function validates the primary slot and start CM4 boot, if a valid
- *  image is found in primary slot. Never returns on successful boot of factory app
- *  and asserts on failure.
+ *  This function copies the factory app of the requested images to their
+ *  primary slots, validates the primary slots and start CM4 boot, if valid
+ *  images are found. Image 0 can be restored from the last-known-good slot
+ *  instead. Never returns on successful boot and asserts on failure, except
+ *  when the last-known-good image can't be parsed or fails validation. The time spent copying
+ *  and verifying the image is logged, for comparing the fused and the
+ *  boot_go() verification paths.
+ *
+ * Parameters:
+ *  images - Mask of the images to be rolled back, bit n for image n.
+ *  source - Source of image 0 (ROLLBACK_SOURCE_xxx). The other images are
+ *           restored from their factory app.
  *
  ******************************************************************************/
-static void rollback_to_factory_image(void)
+static void rollback_to_image(uint32_t images, uint32_t source)
 {
-    struct boot_rsp rsp;
+    char *name = (source == ROLLBACK_SOURCE_LKG) ? "Last-known-good app" : "Factory app";
+    struct boot_rsp rsp = {0};
+    uint32_t start_us = boot_timer_get_us();
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t image;
+    int rc;
 
-    if(transfer_factory_image() != CY_RSLT_SUCCESS)
+    boot_trace_set_flags(BOOT_RECORD_FLAG_ROLLBACK);
+    boot_trace_start(BOOT_STAGE_TRANSFER);
+
+    for (image = 0UL; (image < MCUBOOT_IMAGE_NUMBER) && (result == CY_RSLT_SUCCESS); image++)
+    {
+        if ((images & (1UL << image)) != 0UL)
+        {
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+            BOOT_LOG_INF("Rolling back image %u", (unsigned int)image);
+#endif
+            result = transfer_image(image, images,
+                    (image == 0UL) ? source : ROLLBACK_SOURCE_FACTORY, &rsp);
+        }
+    }
+
+    boot_trace_end(BOOT_STAGE_TRANSFER);
+
+    if ((result != CY_RSLT_SUCCESS) && (source == ROLLBACK_SOURCE_LKG))
+     {
+         /* The caller falls back to the factory app. */
+         BOOT_LOG_ERR("%s transfer failed !", name);
+         return;
+     }
+
+    if(result != CY_RSLT_SUCCESS)
      {
-         BOOT_LOG_ERR("factory app transfer failed !");
+         BOOT_LOG_ERR("%s transfer failed !", name);
          CY_ASSERT(0);
      }
 
+     /* Image copied and verified while streaming: no second pass needed. */
+     if (rsp.br_hdr != NULL)
+     {
+         boot_trace_set_flags(BOOT_RECORD_FLAG_FUSED_VERIFY);
+         BOOT_LOG_INF("%s validated successfully", name);
+         BOOT_LOG_INF("Copy + verify took %u ms (fused)",
+                 (unsigned int)((boot_timer_get_us() - start_us) / 1000UL));
+
+         /* Run boot process, never return. */
+         do_boot(&rsp, name);
+     }
+
      /* Image successfully copied to primary slot at this point. 
       * Now, verify the copied image and boot to it. 
       * All pending updates are cleared on POR and no more updates pending
       * at this point. 
       */
-     if (boot_go(&rsp) == 0)
+     boot_trace_start(BOOT_STAGE_BOOT_GO);
+     rc = boot_go(&rsp);
+     boot_trace_end(BOOT_STAGE_BOOT_GO);
+
+     if (rc == 0)
      {
-         BOOT_LOG_INF("factory app validated successfully");
+         BOOT_LOG_INF("%s validated successfully", name);
+         BOOT_LOG_INF("Copy + verify took %u ms (boot_go)",
+                 (unsigned int)((boot_timer_get_us() - start_us) / 1000UL));
 
         /* Run boot process, never return. */
-         do_boot(&rsp, "Factory app");
+         do_boot(&rsp, name);
      }
 
-     /* Assert on failure to rollback. */
-     BOOT_LOG_ERR("factory app validation failed");
-     BOOT_LOG_ERR("Can't Rollback, asserting!!");
+     BOOT_LOG_ERR("%s validation failed", name);
+
+     /* Assert on failure to rollback. The caller falls back to the factory
+      * app when the last-known-good image fails.
+      */
+     if (source != ROLLBACK_SOURCE_LKG)
+     {
+         BOOT_LOG_ERR("Can't Rollback, asserting!!");
 
-     CY_ASSERT(0);
+         CY_ASSERT(0);
+     }
 }
 
+/******************************************************************************
+ * Function Name: do_rollback
+ ******************************************************************************
+ * Summary:
+ *  Rolls back the requested images. With CY_BOOT_LKG_SLOT, image 0 is first
+ *  restored from the last-known-good slot, unless primary slot already holds
+ *  that image; the factory app is used if the last-known-good image is not
+ *  available or fails validation. Never returns.
+ *
+ * Parameters:
+ *  images - Mask of the images to be rolled back, bit n for image n.
+ *  source - ROLLBACK_SOURCE_FACTORY to skip the last-known-good slot, e.g.
+ *           when resuming an interrupted transfer of the factory app.
+ *
+ ******************************************************************************/
+static void do_rollback(uint32_t images, uint32_t source)
+{
+#ifdef CY_BOOT_LKG_SLOT
+    if ((source == ROLLBACK_SOURCE_LKG) && ((images & 1UL) != 0UL) &&
+        lkg_slot_is_valid() && !lkg_slot_is_current())
+    {
+        BOOT_LOG_INF("Rolling back to last-known-good image");
+
+        /* Returns only if the image can't be restored or fails validation. */
+        rollback_to_image(images, ROLLBACK_SOURCE_LKG);
+
+        BOOT_LOG_WRN("Discarding last-known-good image, rolling back to factory app");
+        (void)lkg_slot_invalidate();
+    }
+#else
+    (void)source;
+#endif
+
+    /* Never return from here. */
+    rollback_to_image(images, ROLLBACK_SOURCE_FACTORY);
+}
+
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+/******************************************************************************
+ * Function Name: get_invalid_images
+ ******************************************************************************
+ * Summary:
+ *  Verifies the image in the primary slot of each image after boot_go()
+ *  failed, to roll back only the images that are not valid.
+ *
+ * Return:
+ *  uint32_t - Mask of the invalid images, bit n for image n. All the images
+ *             when none is found invalid.
+ *
+ ******************************************************************************/
+static uint32_t get_invalid_images(void)
+{
+    const struct flash_area *fap;
+    struct image_header hdr;
+    uint32_t length = 0;
+    uint32_t invalid = 0UL;
+    uint32_t image;
+    cy_rslt_t result;
+    bool valid;
+
+    for (image = 0UL; image < MCUBOOT_IMAGE_NUMBER; image++)
+    {
+        fap = NULL;
+        valid = false;
+        result = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(image), &fap);
+
+        if (result == CY_RSLT_SUCCESS)
+        {
+            result = image_info_read(fap, &hdr, &length);
+        }
+
+        if ((result == CY_RSLT_SUCCESS) && (length <= fap->fa_size))
+        {
+            valid = (image_verify_mapped(&check_verify, fap, length) == CY_RSLT_SUCCESS);
+        }
+
+        if (!valid)
+        {
+            BOOT_LOG_INF("Image %u is not valid", (unsigned int)image);
+            invalid |= (1UL << image);
+        }
+
+        if (fap != NULL)
+        {
+            flash_area_close(fap);
+        }
+    }
+
+    return (invalid != 0UL) ? invalid : ALL_IMAGES_MASK;
+}
+#endif
+
 /******************************************************************************
  * Function Name: main
  ******************************************************************************
@@ -362,22 +814,74 @@ int main(void)
 {
     struct boot_rsp rsp;
     cy_rslt_t result = CY_RSLT_SUCCESS;
+    int rc;
+    bool sfdp_cached = false;
+    uint32_t images = 0UL;
+    uint32_t source = ROLLBACK_SOURCE_FACTORY;
+#if defined(CY_BOOT_LKG_SLOT) || defined(CY_BOOT_TRIAL_BOOT)
+    int swap_type;
+#endif
+#ifdef CY_BOOT_TRIAL_BOOT
+    uint32_t attempt = 0;
+#endif
+    uint32_t failed_images = ALL_IMAGES_MASK;
+#ifdef CY_BOOT_QSPI_BENCH
+    struct flash_area fap_extf;
+#endif
+
+    /* Start the cycle counter used for timing the bootloader operations.
+     * It runs at the reset clock until the clocks are configured.
+     */
+    boot_timer_init();
 
     /* Initialize system resources and peripherals. */
+    boot_trace_start(BOOT_STAGE_INIT_CYCFG);
     init_cycfg_all();
+    boot_timer_rebase();
+    boot_trace_end(BOOT_STAGE_INIT_CYCFG);
+
+#ifdef CY_BOOT_USE_WDT
+    /* Enable the WDT. It is fed by MCUboot during upgrades and by the copy
+     * engine during rollback, between the bounded flash operations.
+     */
+    Cy_WDT_Init();
+    Cy_WDT_Enable();
+#endif
 
     /* Initialize retarget-io to redirect the printf output. */
+    boot_trace_start(BOOT_STAGE_RETARGET_IO);
     result = cy_retarget_io_pdl_init(CY_RETARGET_IO_BAUDRATE);
+    boot_trace_end(BOOT_STAGE_RETARGET_IO);
     CY_ASSERT(result == CY_RSLT_SUCCESS);
 
     /* Enable interrupts. */
     __enable_irq();
 
-    /* Initialize QSPI NOR flash using SFDP. */
-    result = qspi_init_sfdp(QSPI_SLAVE_SELECT_LINE);
+    /* Initialize QSPI NOR flash using SFDP. The SFDP discovery result is
+     * cached in internal flash and reused while the part doesn't change.
+     */
+    boot_trace_start(BOOT_STAGE_QSPI_INIT);
+    result = qspi_cache_init(QSPI_SLAVE_SELECT_LINE, &sfdp_cached);
+    boot_trace_end(BOOT_STAGE_QSPI_INIT);
+
     if( result == CY_RSLT_SUCCESS)
     {
-        BOOT_LOG_INF("External Memory initialization using SFDP mode.");
+        BOOT_LOG_INF("External Memory initialization using %s.",
+                sfdp_cached ? "cached SFDP result" : "SFDP mode");
+
+        if (sfdp_cached)
+        {
+            boot_trace_set_flags(BOOT_RECORD_FLAG_SFDP_CACHED);
+        }
+
+        /* Report the read mode selected from SFDP. */
+        qspi_info_print();
+
+#ifdef CY_BOOT_QSPI_BENCH
+        /* Measure the read throughput over the factory app area. */
+        get_factory_flash_area(0UL, &fap_extf);
+        (void)qspi_info_benchmark(&fap_extf, QSPI_INFO_BENCH_SIZE);
+#endif
     }
     else
     {
@@ -387,11 +891,100 @@ int main(void)
         CY_ASSERT(0);
     }
 
+#ifdef CY_BOOT_CRYPTO_BENCH
+    /* Measure the hash throughput and the signature verification time. */
+    (void)crypto_bench_run();
+#endif
+
+    /* A rollback interrupted by a reset or a power failure leaves primary
+     * slot partially written. Resume it from the last committed point.
+     */
+    if (rollback_journal_is_pending(&images, &source))
+    {
+        BOOT_LOG_INF("Detected interrupted Rollback");
+        BOOT_LOG_INF("Resuming the Rollback...\r\n");
+
+        /* Never return from here. */
+        do_rollback(images, source);
+    }
+
+#ifdef CY_BOOT_DELTA_OTA
+    /* A pending delta image is expanded into the new image, which boot_go()
+     * then validates and installs. A delta image that can't be expanded is
+     * left invalid and discarded by boot_go().
+     */
+    if (delta_patch_apply() != CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_ERR("Failed to expand delta image !");
+    }
+#endif
+
+#if defined(CY_BOOT_LKG_SLOT) || defined(CY_BOOT_TRIAL_BOOT)
+    swap_type = boot_swap_type();
+#endif
+
+#ifdef CY_BOOT_TRIAL_BOOT
+    /* An image installed by a test upgrade is booted on trial. */
+    if (swap_type == BOOT_SWAP_TYPE_TEST)
+    {
+        trial_boot_arm();
+    }
+#endif
+
+#ifdef CY_BOOT_LKG_SLOT
+    /* Keep the image in primary slot as last-known-good before an upgrade
+     * replaces it, if it was confirmed. A revert of a test image doesn't
+     * save anything.
+     */
+    if ((swap_type == BOOT_SWAP_TYPE_TEST) || (swap_type == BOOT_SWAP_TYPE_PERM))
+    {
+        if (lkg_slot_save() != CY_RSLT_SUCCESS)
+        {
+            BOOT_LOG_WRN("Last-known-good slot not updated");
+        }
+    }
+#endif
+
     /* Perform upgrade if pending and check primary slot is valid or not. */
-    if (boot_go(&rsp) == 0)
+    boot_trace_start(BOOT_STAGE_BOOT_GO);
+    rc = boot_go(&rsp);
+    boot_trace_end(BOOT_STAGE_BOOT_GO);
+
+#ifdef CY_BOOT_SMIF_CACHE
+    /* Reads of the secondary slot served from the SMIF read cache. */
+    smif_cache_print();
+#endif
+
+    if (rc == 0)
     {
         BOOT_LOG_INF("Application validated successfully !");
 
+#ifdef CY_BOOT_TRIAL_BOOT
+        /* An image on trial that the application didn't confirm within
+         * CY_BOOT_TRIAL_ATTEMPTS boots is rolled back without user action.
+         */
+        switch (trial_boot_check(&attempt))
+        {
+            case TRIAL_BOOT_EXPIRED:
+                BOOT_LOG_INF("Rollback initiated automatically \r\n");
+
+                /* Never return from here. */
+                do_rollback(1UL, ROLLBACK_SOURCE_LKG);
+                break;
+
+            case TRIAL_BOOT_ACTIVE:
+                BOOT_LOG_INF("Trial boot %u of %u", (unsigned int)attempt,
+                        (unsigned int)CY_BOOT_TRIAL_ATTEMPTS);
+                boot_trace_set_flags(BOOT_RECORD_FLAG_TRIAL);
+                is_trial_boot = true;
+                break;
+
+            default:
+                /* Image not on trial, or confirmed. */
+                break;
+        }
+#endif
+
         /* We have a valid image in primary slot. Check if user wants
          * to initiate rollback. Rollback can be initiated only if user button
          * is held pressed during this stage. otherwise device will jump to
@@ -404,7 +997,7 @@ int main(void)
             BOOT_LOG_INF("Rollback initiated at startup \r\n") ;
 
             /* Never return from here. */
-            rollback_to_factory_image();
+            do_rollback(ALL_IMAGES_MASK, ROLLBACK_SOURCE_LKG);
         }
 
         /* User button event not detected, boot to application. */
@@ -416,6 +1009,11 @@ int main(void)
          * Wait for user input for further actions.
          */
 
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+        /* Only the images that fail validation are rolled back. */
+        failed_images = get_invalid_images();
+#endif
+
         /* Configure GPIO interrupt vector for Port 0. */
         Cy_SysInt_Init(&user_btn_isr_cfg, user_button_callback);
         NVIC_EnableIRQ((IRQn_Type)user_btn_isr_cfg.intrSrc);
@@ -423,6 +1021,15 @@ int main(void)
         /* Console message and inform user that an action is expected. */
         BOOT_LOG_INF("No Upgrade available !");
         BOOT_LOG_INF("No valid image found in primary slot !");
+
+#ifdef CY_BOOT_USE_WDT
+        /* Nothing feeds the WDT while waiting for the user, and its interrupt
+         * is not enabled to wake up the core: stop it until the button is
+         * pressed.
+         */
+        Cy_WDT_Disable();
+#endif
+
         BOOT_LOG_INF("Press and release user button to initiate Rollback \r\n");
         
         do
@@ -445,8 +1052,14 @@ int main(void)
         /* Reset the button status. */
         is_user_button_pressed = false;
 
+#ifdef CY_BOOT_USE_WDT
+        /* Restart the WDT for the rollback. */
+        Cy_WDT_Init();
+        Cy_WDT_Enable();
+#endif
+
         /* This function never returns. */
-        rollback_to_factory_image();
+        do_rollback(failed_images, ROLLBACK_SOURCE_LKG);
     }
 
     return 0;
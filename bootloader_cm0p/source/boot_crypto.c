@@ -0,0 +1,402 @@
+/******************************************************************************
+ * File Name: boot_crypto.c
+ *
+ * Description: This file implements the SHA-256 and HMAC-SHA256 primitives of
+ * the bootloader modules with the crypto backend MCUboot is built with:
+ * mbedTLS (software or Crypto block) or tinycrypt. The bootloader modules then
+ * hash with the same code as MCUboot.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <string.h>
+
+/* Local headers. */
+#include "boot_crypto.h"
+
+#if defined(MCUBOOT_USE_TINYCRYPT)
+#include "tinycrypt/constants.h"
+#include "tinycrypt/hmac.h"
+#ifdef CY_BOOT_ENC_IMAGES
+#include "tinycrypt/ctr_mode.h"
+#include "tinycrypt/ecc_dh.h"
+#endif
+#else
+#include "mbedtls/md.h"
+#ifdef CY_BOOT_ENC_IMAGES
+#include "mbedtls/ecp.h"
+#endif
+#endif
+
+#ifdef CY_BOOT_ENC_IMAGES
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Size of an uncompressed P-256 public key: 0x04, X, Y. */
+#define BOOT_EC_P256_PUB_SIZE   (1U + (2U * BOOT_EC_P256_SIZE))
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void boot_aes_ctr_counter(uint8_t *counter, uint32_t off);
+#endif
+
+/******************************************************************************
+ * Function Name: boot_sha256_start
+ ******************************************************************************
+ * Summary:
+ *  Starts a SHA-256 computation.
+ *
+ ******************************************************************************/
+int boot_sha256_start(boot_sha256_context *ctx)
+{
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    return (tc_sha256_init(ctx) == TC_CRYPTO_SUCCESS) ? 0 : -1;
+#else
+    mbedtls_sha256_init(ctx);
+    return mbedtls_sha256_starts_ret(ctx, 0);
+#endif
+}
+
+/******************************************************************************
+ * Function Name: boot_sha256_update
+ ******************************************************************************
+ * Summary:
+ *  Hashes the next part of the data.
+ *
+ ******************************************************************************/
+int boot_sha256_update(boot_sha256_context *ctx, const void *data, uint32_t len)
+{
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    return (tc_sha256_update(ctx, (const uint8_t *)data, len) == TC_CRYPTO_SUCCESS) ? 0 : -1;
+#else
+    return mbedtls_sha256_update_ret(ctx, (const unsigned char *)data, len);
+#endif
+}
+
+/******************************************************************************
+ * Function Name: boot_sha256_finish
+ ******************************************************************************
+ * Summary:
+ *  Completes the computation and writes the 32-byte digest.
+ *
+ ******************************************************************************/
+int boot_sha256_finish(boot_sha256_context *ctx, uint8_t *hash)
+{
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    return (tc_sha256_final(hash, ctx) == TC_CRYPTO_SUCCESS) ? 0 : -1;
+#else
+    return mbedtls_sha256_finish_ret(ctx, hash);
+#endif
+}
+
+/******************************************************************************
+ * Function Name: boot_sha256_free
+ ******************************************************************************
+ * Summary:
+ *  Clears the state of a computation.
+ *
+ ******************************************************************************/
+void boot_sha256_free(boot_sha256_context *ctx)
+{
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    memset(ctx, 0, sizeof(*ctx));
+#else
+    mbedtls_sha256_free(ctx);
+#endif
+}
+
+/******************************************************************************
+ * Function Name: boot_sha256
+ ******************************************************************************
+ * Summary:
+ *  Computes the SHA-256 digest of a buffer.
+ *
+ ******************************************************************************/
+int boot_sha256(const void *data, uint32_t len, uint8_t *hash)
+{
+    boot_sha256_context ctx;
+    int rc;
+
+    rc = boot_sha256_start(&ctx);
+
+    if (rc == 0)
+    {
+        rc = boot_sha256_update(&ctx, data, len);
+    }
+
+    if (rc == 0)
+    {
+        rc = boot_sha256_finish(&ctx, hash);
+    }
+
+    boot_sha256_free(&ctx);
+
+    return rc;
+}
+
+/******************************************************************************
+ * Function Name: boot_hmac_sha256
+ ******************************************************************************
+ * Summary:
+ *  Computes the HMAC-SHA256 of a buffer.
+ *
+ * Parameters:
+ *  key     - MAC key.
+ *  key_len - Size of the key.
+ *  data    - Data to authenticate.
+ *  len     - Size of the data.
+ *  mac     - Set to the 32-byte MAC.
+ *
+ ******************************************************************************/
+int boot_hmac_sha256(const uint8_t *key, uint32_t key_len, const void *data, uint32_t len,
+                     uint8_t *mac)
+{
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    struct tc_hmac_state_struct hmac;
+    int rc = -1;
+
+    if ((tc_hmac_set_key(&hmac, key, key_len) == TC_CRYPTO_SUCCESS) &&
+        (tc_hmac_init(&hmac) == TC_CRYPTO_SUCCESS) &&
+        (tc_hmac_update(&hmac, data, len) == TC_CRYPTO_SUCCESS) &&
+        (tc_hmac_final(mac, TC_SHA256_DIGEST_SIZE, &hmac) == TC_CRYPTO_SUCCESS))
+    {
+        rc = 0;
+    }
+
+    memset(&hmac, 0, sizeof(hmac));
+
+    return rc;
+#else
+    return mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+            key, key_len, (const unsigned char *)data, len, mac);
+#endif
+}
+
+#ifdef CY_BOOT_ENC_IMAGES
+/******************************************************************************
+ * Function Name: boot_aes_ctr_set_key
+ ******************************************************************************
+ * Summary:
+ *  Sets the AES-128 key of a CTR mode context.
+ *
+ ******************************************************************************/
+int boot_aes_ctr_set_key(boot_aes_context *ctx, const uint8_t *key)
+{
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    return (tc_aes128_set_encrypt_key(ctx, key) == TC_CRYPTO_SUCCESS) ? 0 : -1;
+#else
+    mbedtls_aes_init(ctx);
+    return mbedtls_aes_setkey_enc(ctx, key, BOOT_AES_KEY_SIZE * 8U);
+#endif
+}
+
+/******************************************************************************
+ * Function Name: boot_aes_ctr_counter
+ ******************************************************************************
+ * Summary:
+ *  Sets the counter block of the AES block holding byte "off", as done by
+ *  MCUboot for encrypted images: zero nonce, 32-bit big-endian block number
+ *  in the last 4 bytes.
+ *
+ ******************************************************************************/
+static void boot_aes_ctr_counter(uint8_t *counter, uint32_t off)
+{
+    uint32_t block = off / BOOT_AES_BLOCK_SIZE;
+
+    memset(counter, 0, BOOT_AES_BLOCK_SIZE);
+    counter[12] = (uint8_t)(block >> 24);
+    counter[13] = (uint8_t)(block >> 16);
+    counter[14] = (uint8_t)(block >> 8);
+    counter[15] = (uint8_t)block;
+}
+
+/******************************************************************************
+ * Function Name: boot_aes_ctr_crypt
+ ******************************************************************************
+ * Summary:
+ *  Encrypts or decrypts "len" bytes of a stream in AES-128-CTR mode, in a
+ *  single call to the backend for whole blocks.
+ *
+ * Parameters:
+ *  ctx - Context holding the key.
+ *  off - Offset of the first byte in the stream. Need not be block aligned.
+ *  in  - Input data.
+ *  out - Output data, can be the same as "in".
+ *  len - Number of bytes.
+ *
+ ******************************************************************************/
+int boot_aes_ctr_crypt(boot_aes_context *ctx, uint32_t off, const uint8_t *in, uint8_t *out,
+                       uint32_t len)
+{
+    uint8_t counter[BOOT_AES_BLOCK_SIZE];
+    uint8_t stream[BOOT_AES_BLOCK_SIZE];
+    uint32_t blk_off = off % BOOT_AES_BLOCK_SIZE;
+    int rc = 0;
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    uint32_t i = 0;
+
+    boot_aes_ctr_counter(counter, off);
+
+    /* tc_ctr_mode() starts at a block boundary. */
+    if (blk_off != 0U)
+    {
+        rc = (tc_aes_encrypt(stream, counter, ctx) == TC_CRYPTO_SUCCESS) ? 0 : -1;
+
+        for (i = 0; (rc == 0) && (i < len) && ((blk_off + i) < BOOT_AES_BLOCK_SIZE); i++)
+        {
+            out[i] = in[i] ^ stream[blk_off + i];
+        }
+
+        boot_aes_ctr_counter(counter, off + i);
+    }
+
+    if ((rc == 0) && (i < len))
+    {
+        rc = (tc_ctr_mode(&out[i], len - i, &in[i], len - i, counter, ctx) ==
+              TC_CRYPTO_SUCCESS) ? 0 : -1;
+    }
+#else
+    size_t nc_off = 0;
+
+    boot_aes_ctr_counter(counter, off);
+
+    /* mbedTLS continues a block from the key stream left in "stream". */
+    if (blk_off != 0U)
+    {
+        rc = mbedtls_aes_crypt_ecb(ctx, MBEDTLS_AES_ENCRYPT, counter, stream);
+        boot_aes_ctr_counter(counter, off + BOOT_AES_BLOCK_SIZE);
+        nc_off = blk_off;
+    }
+
+    if (rc == 0)
+    {
+        rc = mbedtls_aes_crypt_ctr(ctx, len, &nc_off, counter, stream, in, out);
+    }
+#endif
+
+    memset(stream, 0, sizeof(stream));
+
+    return rc;
+}
+
+/******************************************************************************
+ * Function Name: boot_aes_free
+ ******************************************************************************
+ * Summary:
+ *  Clears the key of an AES context.
+ *
+ ******************************************************************************/
+void boot_aes_free(boot_aes_context *ctx)
+{
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    memset(ctx, 0, sizeof(*ctx));
+#else
+    mbedtls_aes_free(ctx);
+#endif
+}
+
+/******************************************************************************
+ * Function Name: boot_ecdh_p256
+ ******************************************************************************
+ * Summary:
+ *  Computes the ECDH shared secret of a P-256 private key and public key.
+ *
+ * Parameters:
+ *  priv   - Private key (32-byte big-endian scalar).
+ *  pub    - Uncompressed public key (0x04, X, Y).
+ *  secret - Set to the 32-byte X coordinate of the shared point.
+ *
+ ******************************************************************************/
+int boot_ecdh_p256(const uint8_t *priv, const uint8_t *pub, uint8_t *secret)
+{
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    int rc = -1;
+
+    if ((pub[0] == 0x04U) && (uECC_valid_public_key(&pub[1], uECC_secp256r1()) == 0) &&
+        (uECC_shared_secret(&pub[1], priv, secret, uECC_secp256r1()) == TC_CRYPTO_SUCCESS))
+    {
+        rc = 0;
+    }
+
+    return rc;
+#else
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point q;
+    mbedtls_ecp_point r;
+    mbedtls_mpi d;
+    int rc;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&q);
+    mbedtls_ecp_point_init(&r);
+    mbedtls_mpi_init(&d);
+
+    rc = mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1);
+
+    if (rc == 0)
+    {
+        rc = mbedtls_ecp_point_read_binary(&grp, &q, pub, BOOT_EC_P256_PUB_SIZE);
+    }
+
+    if (rc == 0)
+    {
+        rc = mbedtls_ecp_check_pubkey(&grp, &q);
+    }
+
+    if (rc == 0)
+    {
+        rc = mbedtls_mpi_read_binary(&d, priv, BOOT_EC_P256_SIZE);
+    }
+
+    if (rc == 0)
+    {
+        rc = mbedtls_ecp_mul(&grp, &r, &d, &q, NULL, NULL);
+    }
+
+    if (rc == 0)
+    {
+        rc = mbedtls_mpi_write_binary(&r.X, secret, BOOT_EC_P256_SIZE);
+    }
+
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_point_free(&r);
+    mbedtls_ecp_point_free(&q);
+    mbedtls_ecp_group_free(&grp);
+
+    return rc;
+#endif
+}
+#endif /* CY_BOOT_ENC_IMAGES */
+
+/* [] END OF FILE */
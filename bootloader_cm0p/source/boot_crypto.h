@@ -0,0 +1,90 @@
+/******************************************************************************
+ * File Name: boot_crypto.h
+ *
+ * Description: This file contains the declarations of the hash primitives used
+ * by the bootloader modules, on top of the crypto backend selected with
+ * CRYPTO_BACKEND (mbedTLS or tinycrypt).
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_BOOT_CRYPTO_H_
+#define SOURCE_BOOT_CRYPTO_H_
+
+#include <stdint.h>
+#include "mcuboot_config/mcuboot_config.h"
+
+#if defined(MCUBOOT_USE_TINYCRYPT)
+#include "tinycrypt/sha256.h"
+#include "tinycrypt/aes.h"
+
+typedef struct tc_sha256_state_struct boot_sha256_context;
+typedef struct tc_aes_key_sched_struct boot_aes_context;
+
+#define BOOT_CRYPTO_IMPL    "tinycrypt"
+#else
+#include "mbedtls/sha256.h"
+#include "mbedtls/aes.h"
+
+typedef mbedtls_sha256_context boot_sha256_context;
+typedef mbedtls_aes_context boot_aes_context;
+
+#ifdef CY_BOOT_USE_CRYPTO_HW
+#define BOOT_CRYPTO_IMPL    "mbedTLS, Crypto block (ALT)"
+#else
+#define BOOT_CRYPTO_IMPL    "mbedTLS, software"
+#endif
+#endif /* MCUBOOT_USE_TINYCRYPT */
+
+/* AES-128 key and block sizes. */
+#define BOOT_AES_KEY_SIZE       (16U)
+#define BOOT_AES_BLOCK_SIZE     (16U)
+
+/* Size of a P-256 scalar or coordinate. */
+#define BOOT_EC_P256_SIZE       (32U)
+
+/* All functions return 0 on success. */
+int boot_sha256_start(boot_sha256_context *ctx);
+int boot_sha256_update(boot_sha256_context *ctx, const void *data, uint32_t len);
+int boot_sha256_finish(boot_sha256_context *ctx, uint8_t *hash);
+void boot_sha256_free(boot_sha256_context *ctx);
+int boot_sha256(const void *data, uint32_t len, uint8_t *hash);
+int boot_hmac_sha256(const uint8_t *key, uint32_t key_len, const void *data, uint32_t len,
+                     uint8_t *mac);
+#ifdef CY_BOOT_ENC_IMAGES
+int boot_aes_ctr_set_key(boot_aes_context *ctx, const uint8_t *key);
+int boot_aes_ctr_crypt(boot_aes_context *ctx, uint32_t off, const uint8_t *in, uint8_t *out,
+                       uint32_t len);
+void boot_aes_free(boot_aes_context *ctx);
+int boot_ecdh_p256(const uint8_t *priv, const uint8_t *pub, uint8_t *secret);
+#endif
+
+#endif /* SOURCE_BOOT_CRYPTO_H_ */
@@ -0,0 +1,117 @@
+/******************************************************************************
+ * File Name: boot_store.c
+ *
+ * Description: This file implements the bootloader persistent store. The rows
+ * are part of the bootloader image: programming the bootloader clears them,
+ * which invalidates all cached records.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "bootutil/bootutil_log.h"
+
+/* Local headers. */
+#include "boot_store.h"
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Store rows, placed in the Emulated EEPROM flash region (not used by the
+ * CM4 apps of this example).
+ */
+CY_SECTION(".cy_em_eeprom") CY_ALIGN(CY_FLASH_SIZEOF_ROW)
+static const uint8_t boot_store_rows[BOOT_STORE_NUM_ROWS][BOOT_STORE_ROW_SIZE] = {{0U}};
+
+/* Row buffer, word-aligned as required by the flash driver. */
+static uint32_t boot_store_buf[BOOT_STORE_ROW_SIZE / sizeof(uint32_t)];
+
+/******************************************************************************
+ * Function Name: boot_store_get
+ ******************************************************************************
+ * Summary:
+ *  Returns the address of a store row. The content must be validated by the
+ *  caller: a row is all zeros after the bootloader is programmed.
+ *
+ * Parameters:
+ *  row - Row index (BOOT_STORE_ROW_xxx).
+ *
+ * Return:
+ *  Address of the row in the internal flash.
+ *
+ ******************************************************************************/
+const void *boot_store_get(uint32_t row)
+{
+    CY_ASSERT(row < BOOT_STORE_NUM_ROWS);
+
+    return boot_store_rows[row];
+}
+
+/******************************************************************************
+ * Function Name: boot_store_write
+ ******************************************************************************
+ * Summary:
+ *  Replaces the content of a store row. The rest of the row is zero-filled.
+ *
+ * Parameters:
+ *  row  - Row index (BOOT_STORE_ROW_xxx).
+ *  data - Record to be written.
+ *  len  - Size of the record, at most BOOT_STORE_ROW_SIZE.
+ *
+ * Return:
+ *  Status of the flash operation.
+ *
+ ******************************************************************************/
+cy_rslt_t boot_store_write(uint32_t row, const void *data, uint32_t len)
+{
+    cy_en_flashdrv_status_t status;
+
+    CY_ASSERT(row < BOOT_STORE_NUM_ROWS);
+    CY_ASSERT(len <= BOOT_STORE_ROW_SIZE);
+
+    memset(boot_store_buf, 0, sizeof(boot_store_buf));
+    memcpy(boot_store_buf, data, len);
+
+    status = Cy_Flash_WriteRow((uint32_t)boot_store_rows[row], boot_store_buf);
+
+    if (status != CY_FLASH_DRV_SUCCESS)
+    {
+        BOOT_LOG_ERR("Failed to write boot store row %u", (unsigned int)row);
+    }
+
+    return (status == CY_FLASH_DRV_SUCCESS) ? CY_RSLT_SUCCESS : (cy_rslt_t) status;
+}
+
+/* [] END OF FILE */
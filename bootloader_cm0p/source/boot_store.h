@@ -0,0 +1,58 @@
+/******************************************************************************
+ * File Name: boot_store.h
+ *
+ * Description: This file contains declaration of the bootloader persistent
+ * store: a few internal flash rows reserved in the Emulated EEPROM flash
+ * region, used for caching data across resets.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_BOOT_STORE_H_
+#define SOURCE_BOOT_STORE_H_
+
+#include <stdint.h>
+#include "cy_pdl.h"
+#include "cy_result.h"
+
+/* Rows of the store. */
+#define BOOT_STORE_ROW_SFDP_CACHE   (0UL)
+#define BOOT_STORE_ROW_RESERVED     (1UL)   /* Unused. */
+#define BOOT_STORE_ROW_TRIAL        (2UL)
+#define BOOT_STORE_NUM_ROWS         (3UL)
+
+/* Size of a record stored in a row. */
+#define BOOT_STORE_ROW_SIZE         (CY_FLASH_SIZEOF_ROW)
+
+const void *boot_store_get(uint32_t row);
+cy_rslt_t boot_store_write(uint32_t row, const void *data, uint32_t len);
+
+#endif /* SOURCE_BOOT_STORE_H_ */
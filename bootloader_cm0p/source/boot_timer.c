@@ -0,0 +1,209 @@
+/******************************************************************************
+ * File Name: boot_timer.c
+ *
+ * Description: This file implements the boot timer. SysTick is clocked from
+ * the CM0+ core clock and its 24-bit counter is extended to 64 bits by
+ * counting the reload events in the SysTick interrupt.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* Local headers. */
+#include "boot_timer.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* SysTick reload value: full 24-bit range to keep the interrupt rate low. */
+#define BOOT_TIMER_RELOAD           (0xFFFFFFUL)
+
+/* Number of cycles counted between two SysTick interrupts. */
+#define BOOT_TIMER_PERIOD_CYCLES    (BOOT_TIMER_RELOAD + 1UL)
+
+/* SysTick callback slot used by the boot timer. */
+#define BOOT_TIMER_CALLBACK_SLOT    (0UL)
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+static volatile uint32_t boot_timer_overflows = 0;
+
+/* CPU clock frequency the counter runs at. */
+static uint32_t boot_timer_hz = 0;
+
+/* Time elapsed before the last (re)start of the counter. */
+static uint32_t boot_timer_base_us = 0;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void boot_timer_callback(void);
+
+/******************************************************************************
+ * Function Name: boot_timer_callback
+ ******************************************************************************
+ * Summary:
+ *  SysTick callback. Extends the 24-bit SysTick counter.
+ *
+ ******************************************************************************/
+static void boot_timer_callback(void)
+{
+    boot_timer_overflows++;
+}
+
+/******************************************************************************
+ * Function Name: boot_timer_init
+ ******************************************************************************
+ * Summary:
+ *  Starts the SysTick counter on the CPU clock. Can be called right after
+ *  reset, before the clocks are configured: see boot_timer_rebase(). While
+ *  interrupts are disabled, a single counter wrap is accounted for.
+ *
+ ******************************************************************************/
+void boot_timer_init(void)
+{
+    boot_timer_overflows = 0;
+    boot_timer_base_us = 0;
+    boot_timer_hz = SystemCoreClock;
+
+    Cy_SysTick_Init(CY_SYSTICK_CLOCK_SOURCE_CLK_CPU, BOOT_TIMER_RELOAD);
+    (void) Cy_SysTick_SetCallback(BOOT_TIMER_CALLBACK_SLOT, boot_timer_callback);
+}
+
+/******************************************************************************
+ * Function Name: boot_timer_rebase
+ ******************************************************************************
+ * Summary:
+ *  Restarts the counter after a change of the CPU clock frequency. The time
+ *  elapsed so far is converted at the old frequency and carried over.
+ *
+ ******************************************************************************/
+void boot_timer_rebase(void)
+{
+    uint32_t elapsed_us = boot_timer_get_us();
+
+    boot_timer_overflows = 0;
+    boot_timer_hz = SystemCoreClock;
+    Cy_SysTick_Init(CY_SYSTICK_CLOCK_SOURCE_CLK_CPU, BOOT_TIMER_RELOAD);
+    (void) Cy_SysTick_SetCallback(BOOT_TIMER_CALLBACK_SLOT, boot_timer_callback);
+    boot_timer_base_us = elapsed_us;
+}
+
+/******************************************************************************
+ * Function Name: boot_timer_deinit
+ ******************************************************************************
+ * Summary:
+ *  Stops the SysTick counter so that it does not wake up CM0+ after CM4 has
+ *  been started.
+ *
+ ******************************************************************************/
+void boot_timer_deinit(void)
+{
+    Cy_SysTick_DisableInterrupt();
+    Cy_SysTick_Disable();
+}
+
+/******************************************************************************
+ * Function Name: boot_timer_get_cycles
+ ******************************************************************************
+ * Summary:
+ *  Returns the number of CPU cycles elapsed since the counter was last
+ *  (re)started.
+ *
+ * Return:
+ *  Elapsed cycles.
+ *
+ ******************************************************************************/
+uint64_t boot_timer_get_cycles(void)
+{
+    uint32_t overflows;
+    uint32_t value;
+    uint32_t pending;
+
+    /* Re-read if the counter wrapped while it was being sampled. A wrap
+     * that is not yet serviced (e.g. interrupts disabled) is pending.
+     */
+    do
+    {
+        overflows = boot_timer_overflows;
+        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+        value = Cy_SysTick_GetValue();
+    } while ((overflows != boot_timer_overflows) ||
+             (pending != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)));
+
+    if (pending != 0UL)
+    {
+        overflows++;
+    }
+
+    return ((uint64_t)overflows * BOOT_TIMER_PERIOD_CYCLES) +
+            (BOOT_TIMER_RELOAD - value);
+}
+
+/******************************************************************************
+ * Function Name: boot_timer_cycles_to_us
+ ******************************************************************************
+ * Summary:
+ *  Converts a number of CPU cycles to microseconds.
+ *
+ * Parameters:
+ *  cycles - Number of CPU cycles.
+ *
+ * Return:
+ *  Duration in microseconds.
+ *
+ ******************************************************************************/
+uint32_t boot_timer_cycles_to_us(uint64_t cycles)
+{
+    return (uint32_t)((cycles * 1000000ULL) / boot_timer_hz);
+}
+
+/******************************************************************************
+ * Function Name: boot_timer_get_us
+ ******************************************************************************
+ * Summary:
+ *  Returns the number of microseconds elapsed since boot_timer_init(),
+ *  across clock changes handled by boot_timer_rebase().
+ *
+ * Return:
+ *  Elapsed time in microseconds.
+ *
+ ******************************************************************************/
+uint32_t boot_timer_get_us(void)
+{
+    return boot_timer_base_us + boot_timer_cycles_to_us(boot_timer_get_cycles());
+}
+
+/* [] END OF FILE */
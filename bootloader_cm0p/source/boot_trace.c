@@ -0,0 +1,160 @@
+/******************************************************************************
+ * File Name: boot_trace.c
+ *
+ * Description: This file implements the boot-stage timing instrumentation of
+ * the bootloader, based on the boot timer.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "bootutil/bootutil_log.h"
+
+/* Local headers. */
+#include "boot_trace.h"
+#include "boot_timer.h"
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Boot record read by the CM4 apps, at BOOT_RECORD_ADDR. */
+CY_SECTION(".cy_boot_shared") CY_ALIGN(4)
+static boot_record_t boot_record;
+
+/* Timings collected during the boot, copied to the boot record at the end. */
+static boot_record_t boot_trace;
+static uint32_t boot_trace_start_us[BOOT_STAGE_COUNT];
+
+/******************************************************************************
+ * Function Name: boot_trace_start
+ ******************************************************************************
+ * Summary:
+ *  Marks the start of a boot stage.
+ *
+ * Parameters:
+ *  stage - Boot stage.
+ *
+ ******************************************************************************/
+void boot_trace_start(boot_stage_t stage)
+{
+    boot_trace_start_us[stage] = boot_timer_get_us();
+}
+
+/******************************************************************************
+ * Function Name: boot_trace_end
+ ******************************************************************************
+ * Summary:
+ *  Marks the end of a boot stage. Stages run more than once accumulate.
+ *
+ * Parameters:
+ *  stage - Boot stage.
+ *
+ ******************************************************************************/
+void boot_trace_end(boot_stage_t stage)
+{
+    boot_trace.stage_us[stage] += boot_timer_get_us() - boot_trace_start_us[stage];
+}
+
+/******************************************************************************
+ * Function Name: boot_trace_set_flags
+ ******************************************************************************
+ * Summary:
+ *  Sets boot flags (BOOT_RECORD_FLAG_xxx) in the boot record.
+ *
+ * Parameters:
+ *  flags - Flags to be set.
+ *
+ ******************************************************************************/
+void boot_trace_set_flags(uint32_t flags)
+{
+    boot_trace.flags |= flags;
+}
+
+/******************************************************************************
+ * Function Name: boot_trace_add_rows
+ ******************************************************************************
+ * Summary:
+ *  Adds the row counts of a copy to the primary slot to the boot record.
+ *  The counts of the images restored by a rollback accumulate.
+ *
+ * Parameters:
+ *  programmed - Number of rows programmed.
+ *  blank      - Number of rows left erased, as they are blank in the image.
+ *  unchanged  - Number of rows that already held the image.
+ *
+ ******************************************************************************/
+void boot_trace_add_rows(uint32_t programmed, uint32_t blank, uint32_t unchanged)
+{
+    boot_trace.rows_programmed += programmed;
+    boot_trace.rows_blank += blank;
+    boot_trace.rows_unchanged += unchanged;
+}
+
+/******************************************************************************
+ * Function Name: boot_trace_print
+ ******************************************************************************
+ * Summary:
+ *  Prints the timings of the stages completed so far.
+ *
+ ******************************************************************************/
+void boot_trace_print(void)
+{
+    BOOT_LOG_INF("Boot timing (us): cycfg %u, retarget %u, qspi %u, boot_go %u, transfer %u",
+            (unsigned int)boot_trace.stage_us[BOOT_STAGE_INIT_CYCFG],
+            (unsigned int)boot_trace.stage_us[BOOT_STAGE_RETARGET_IO],
+            (unsigned int)boot_trace.stage_us[BOOT_STAGE_QSPI_INIT],
+            (unsigned int)boot_trace.stage_us[BOOT_STAGE_BOOT_GO],
+            (unsigned int)boot_trace.stage_us[BOOT_STAGE_TRANSFER]);
+}
+
+/******************************************************************************
+ * Function Name: boot_trace_publish
+ ******************************************************************************
+ * Summary:
+ *  Writes the boot record for the CM4 apps. Called right before CM4 is
+ *  started.
+ *
+ ******************************************************************************/
+void boot_trace_publish(void)
+{
+    boot_trace.magic = BOOT_RECORD_MAGIC;
+    boot_trace.version = BOOT_RECORD_VERSION;
+    boot_trace.size = (uint16_t)sizeof(boot_record_t);
+    boot_trace.total_us = boot_timer_get_us();
+
+    boot_record = boot_trace;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,52 @@
+/******************************************************************************
+ * File Name: boot_trace.h
+ *
+ * Description: This file contains declaration of the boot-stage timing
+ * instrumentation of the bootloader. The results are published in the boot
+ * record shared with the CM4 apps (see common/include/boot_record.h).
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_BOOT_TRACE_H_
+#define SOURCE_BOOT_TRACE_H_
+
+#include <stdint.h>
+#include "boot_record.h"
+
+void boot_trace_start(boot_stage_t stage);
+void boot_trace_end(boot_stage_t stage);
+void boot_trace_set_flags(uint32_t flags);
+void boot_trace_add_rows(uint32_t programmed, uint32_t blank, uint32_t unchanged);
+void boot_trace_print(void);
+void boot_trace_publish(void);
+
+#endif /* SOURCE_BOOT_TRACE_H_ */
@@ -0,0 +1,155 @@
+/******************************************************************************
+ * File Name: crc32.c
+ *
+ * Description: This file implements a table-driven CRC-32 (IEEE 802.3). The
+ * lookup table is built in RAM on first use.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Driver header files. */
+#include "cy_pdl.h"
+#ifdef CY_BOOT_USE_CRYPTO_HW
+#include "cy_crypto_core.h"
+#endif
+
+/* Local headers. */
+#include "crc32.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Reflected CRC-32 (IEEE 802.3) polynomial. */
+#define CRC32_POLY                  (0xEDB88320UL)
+
+/* Same polynomial in normal form, and the seed / final XOR value, as
+ * expected by the Crypto block.
+ */
+#define CRC32_POLY_NORMAL           (0x04C11DB7UL)
+#define CRC32_XOR                   (0xFFFFFFFFUL)
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+static uint32_t crc32_table[256];
+
+/******************************************************************************
+ * Function Name: crc32_update
+ ******************************************************************************
+ * Summary:
+ *  Updates a running CRC-32 with "len" bytes of "data". Start with 0.
+ *
+ * Parameters:
+ *  crc  - CRC of the data processed so far.
+ *  data - Data to be processed.
+ *  len  - Number of bytes.
+ *
+ * Return:
+ *  Updated CRC.
+ *
+ ******************************************************************************/
+uint32_t crc32_update(uint32_t crc, const void *data, uint32_t len)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t i, j, val;
+
+    if (crc32_table[1] == 0)
+    {
+        for (i = 0; i < 256UL; i++)
+        {
+            val = i;
+
+            for (j = 0; j < 8UL; j++)
+            {
+                val = (val & 1UL) ? ((val >> 1U) ^ CRC32_POLY) : (val >> 1U);
+            }
+
+            crc32_table[i] = val;
+        }
+    }
+
+    crc = ~crc;
+
+    while (len-- > 0)
+    {
+        crc = crc32_table[(crc ^ *bytes++) & 0xFFU] ^ (crc >> 8U);
+    }
+
+    return ~crc;
+}
+
+/******************************************************************************
+ * Function Name: crc32_calc
+ ******************************************************************************
+ * Summary:
+ *  Computes the CRC-32 of a memory-mapped block, using the CRC unit of the
+ *  Crypto block when the crypto hardware is enabled for the bootloader
+ *  (USE_CRYPTO_HW=1). Gives the same result as crc32_update(0, data, len).
+ *
+ * Parameters:
+ *  data - Data to be processed.
+ *  len  - Number of bytes.
+ *
+ * Return:
+ *  CRC of the data.
+ *
+ ******************************************************************************/
+uint32_t crc32_calc(const void *data, uint32_t len)
+{
+#ifdef CY_BOOT_USE_CRYPTO_HW
+    uint32_t crc = 0;
+    bool enabled = Cy_Crypto_Core_IsEnabled(CRYPTO);
+
+    if (!enabled)
+    {
+        (void)Cy_Crypto_Core_Enable(CRYPTO);
+    }
+
+    if ((Cy_Crypto_Core_Crc_Init(CRYPTO, CRC32_POLY_NORMAL, 1U, 0U, 1U, CRC32_XOR) != CY_CRYPTO_SUCCESS) ||
+        (Cy_Crypto_Core_Crc(CRYPTO, &crc, data, len, CRC32_XOR) != CY_CRYPTO_SUCCESS))
+    {
+        crc = crc32_update(0, data, len);
+    }
+
+    /* Leave the block as it was found: mbedTLS manages it on its own. */
+    if (!enabled)
+    {
+        (void)Cy_Crypto_Core_Disable(CRYPTO);
+    }
+
+    return crc;
+#else
+    return crc32_update(0, data, len);
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,555 @@
+/******************************************************************************
+ * File Name: crypto_bench.c
+ *
+ * Description: This file implements the crypto self-test of the bootloader. It
+ * measures the SHA-256 throughput for several sizes of the chunks handed to
+ * the hash engine, and the latency of an ECDSA P-256 signature verification,
+ * and the time of a full verification of the image in the primary slot, with
+ * the crypto backend the bootloader is built with (mbedTLS software, mbedTLS
+ * with the Crypto block, or tinycrypt). With mbedTLS in software, the ECDSA
+ * verification is measured with and without the precomputed comb table of the
+ * base point.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <string.h>
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/bootutil_log.h"
+
+/* Crypto backend header files. */
+#if defined(MCUBOOT_USE_TINYCRYPT)
+#include "tinycrypt/ecc_dsa.h"
+#else
+#include "mbedtls/ecdsa.h"
+#endif
+
+/*  Flash access headers. */
+#include "flash_map_backend/flash_map_backend.h"
+#include "sysflash.h"
+
+/* Local headers. */
+#include "crypto_bench.h"
+#include "boot_crypto.h"
+#include "boot_timer.h"
+#include "image_info.h"
+#if !defined(MCUBOOT_USE_TINYCRYPT)
+#include "ec_precomp.h"
+#endif
+#ifdef CY_BOOT_ENC_IMAGES
+#include "enc_image.h"
+#endif
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Data hashed for each chunk size: the start of the internal flash, which is
+ * read the same way as the primary slot during the image validation.
+ */
+#define CRYPTO_BENCH_HASH_ADDR      (CY_FLASH_BASE)
+
+/* Number of signature verifications averaged. */
+#define CRYPTO_BENCH_ECDSA_RUNS     (4UL)
+
+/* Size of an ECDSA P-256 scalar, and of an uncompressed public key. */
+#define CRYPTO_BENCH_EC_SIZE        (32U)
+#define CRYPTO_BENCH_EC_KEY_SIZE    (1U + (2U * CRYPTO_BENCH_EC_SIZE))
+
+/* Error returned when the test signature is rejected. */
+#define CRYPTO_BENCH_RSLT_ERR_ECDSA (1UL)
+
+/* Error returned when the primary slot can't be verified. */
+#define CRYPTO_BENCH_RSLT_ERR_IMAGE (2UL)
+
+/* Largest chunk decrypted by the AES-CTR test. */
+#define CRYPTO_BENCH_AES_CHUNK_MAX  (4096UL)
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Chunk sizes handed to boot_sha256_update(). */
+static const uint32_t crypto_bench_chunks[] =
+{
+    64UL, 128UL, 256UL, 512UL, 1024UL, 2048UL, 4096UL, 8192UL, 16384UL
+};
+
+/* Test vector: SHA-256 of "mcuboot crypto bench", signed with a throw-away
+ * P-256 key.
+ */
+static const uint8_t crypto_bench_hash[CRYPTO_BENCH_EC_SIZE] =
+{
+    0x9a, 0x82, 0xe8, 0xb2, 0xf7, 0x09, 0x94, 0xfa, 0xfc, 0xca, 0x50, 0xbf,
+    0x72, 0xb4, 0x87, 0xe2, 0x2f, 0xc2, 0xaa, 0x3f, 0xb0, 0x90, 0xd4, 0x78,
+    0xd1, 0x78, 0x83, 0xbc, 0x36, 0xb9, 0xb1, 0xfb
+};
+
+static const uint8_t crypto_bench_key[CRYPTO_BENCH_EC_KEY_SIZE] =
+{
+    0x04, 0xa4, 0xb3, 0x8c, 0x63, 0xb9, 0xb7, 0x73, 0xb1, 0xb2, 0xb4, 0x4e,
+    0xc6, 0xd8, 0xd6, 0x23, 0x77, 0x94, 0xd3, 0x70, 0x12, 0x76, 0x9f, 0x06,
+    0x5a, 0xf4, 0x07, 0x05, 0x2e, 0x55, 0x92, 0xfd, 0x46, 0x89, 0x5d, 0x52,
+    0xbe, 0x26, 0x52, 0x07, 0x97, 0x7d, 0x45, 0x57, 0x69, 0xa0, 0xf9, 0xf2,
+    0x9b, 0x04, 0x91, 0x75, 0x27, 0xa5, 0x6e, 0xd4, 0x94, 0x1c, 0x72, 0x46,
+    0x6a, 0xb7, 0x14, 0xbf, 0x45
+};
+
+static const uint8_t crypto_bench_sig_r[CRYPTO_BENCH_EC_SIZE] =
+{
+    0xb8, 0xeb, 0x9d, 0xd2, 0x95, 0x3e, 0x35, 0xe4, 0xa5, 0x78, 0xda, 0xb1,
+    0x68, 0x76, 0x28, 0x5a, 0x7d, 0x9d, 0xd8, 0xb2, 0x88, 0x4e, 0x6f, 0x12,
+    0xd3, 0x08, 0x4c, 0x93, 0x82, 0x23, 0x26, 0xea
+};
+
+static const uint8_t crypto_bench_sig_s[CRYPTO_BENCH_EC_SIZE] =
+{
+    0x33, 0xf4, 0x0e, 0x32, 0x34, 0xd5, 0xc8, 0xa1, 0x9b, 0x9d, 0xb5, 0x15,
+    0x65, 0x67, 0x25, 0x79, 0x9a, 0xcd, 0x80, 0x38, 0x32, 0xf3, 0x99, 0x9a,
+    0xb5, 0x67, 0x08, 0xbd, 0xf5, 0xba, 0xc3, 0xaf
+};
+
+static boot_sha256_context bench_sha;
+static image_verify_t bench_verify;
+
+#ifdef CY_BOOT_ENC_IMAGES
+/* Chunk sizes handed to boot_aes_ctr_crypt(): one row, as in the copy loop
+ * of the rollback, and a larger chunk for comparison.
+ */
+static const uint32_t crypto_bench_aes_chunks[] =
+{
+    CY_FLASH_SIZEOF_ROW, CRYPTO_BENCH_AES_CHUNK_MAX
+};
+
+static boot_aes_context bench_aes;
+static uint8_t bench_aes_buf[CRYPTO_BENCH_AES_CHUNK_MAX];
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static uint32_t crypto_bench_sha256(uint32_t chunk);
+static cy_rslt_t crypto_bench_ecdsa(bool use_comb, uint32_t *verify_us);
+static cy_rslt_t crypto_bench_image(uint32_t *length, uint32_t *verify_us);
+#ifdef CY_BOOT_ENC_IMAGES
+static uint32_t crypto_bench_aes_ctr(uint32_t chunk);
+static void crypto_bench_enc(void);
+#endif
+
+/******************************************************************************
+ * Function Name: crypto_bench_sha256
+ ******************************************************************************
+ * Summary:
+ *  Hashes CRYPTO_BENCH_HASH_SIZE bytes in chunks of "chunk" bytes.
+ *
+ * Return:
+ *  Time taken, in microseconds.
+ *
+ ******************************************************************************/
+static uint32_t crypto_bench_sha256(uint32_t chunk)
+{
+    uint8_t hash[CRYPTO_BENCH_EC_SIZE];
+    uint32_t start_us = boot_timer_get_us();
+    uint32_t off;
+
+    (void)boot_sha256_start(&bench_sha);
+
+    for (off = 0; off < CRYPTO_BENCH_HASH_SIZE; off += chunk)
+    {
+        (void)boot_sha256_update(&bench_sha,
+                (const uint8_t *)(CRYPTO_BENCH_HASH_ADDR + off), chunk);
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    (void)boot_sha256_finish(&bench_sha, hash);
+    boot_sha256_free(&bench_sha);
+
+    return boot_timer_get_us() - start_us;
+}
+
+/******************************************************************************
+ * Function Name: crypto_bench_ecdsa
+ ******************************************************************************
+ * Summary:
+ *  Verifies the test signature CRYPTO_BENCH_ECDSA_RUNS times. The group is
+ *  loaded for each verification, as MCUboot does for each image, so that the
+ *  comb table of the base point is not reused from the previous run.
+ *
+ * Parameters:
+ *  use_comb  - Use the precomputed comb table (ec_p256_comb.c). mbedTLS only.
+ *  verify_us - Set to the average time of a verification, in microseconds.
+ *
+ * Return:
+ *  Status of the verifications.
+ *
+ ******************************************************************************/
+#if defined(MCUBOOT_USE_TINYCRYPT)
+static cy_rslt_t crypto_bench_ecdsa(bool use_comb, uint32_t *verify_us)
+{
+    uint8_t sig[2U * CRYPTO_BENCH_EC_SIZE];
+    uint32_t start_us;
+    uint32_t run;
+    int valid = 1;
+
+    (void)use_comb;
+
+    /* tinycrypt takes the raw coordinates and the raw (r, s) pair. */
+    memcpy(sig, crypto_bench_sig_r, CRYPTO_BENCH_EC_SIZE);
+    memcpy(&sig[CRYPTO_BENCH_EC_SIZE], crypto_bench_sig_s, CRYPTO_BENCH_EC_SIZE);
+
+    start_us = boot_timer_get_us();
+
+    for (run = 0; (valid == 1) && (run < CRYPTO_BENCH_ECDSA_RUNS); run++)
+    {
+        valid = uECC_verify(&crypto_bench_key[1], crypto_bench_hash, sizeof(crypto_bench_hash),
+                            sig, uECC_secp256r1());
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    *verify_us = (boot_timer_get_us() - start_us) / CRYPTO_BENCH_ECDSA_RUNS;
+
+    return (valid == 1) ? CY_RSLT_SUCCESS : CRYPTO_BENCH_RSLT_ERR_ECDSA;
+}
+#else
+static cy_rslt_t crypto_bench_ecdsa(bool use_comb, uint32_t *verify_us)
+{
+    mbedtls_ecp_group key_grp;
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point key;
+    mbedtls_mpi r, s;
+    uint32_t start_us;
+    uint32_t run;
+    int rc;
+
+    mbedtls_ecp_group_init(&key_grp);
+    mbedtls_ecp_point_init(&key);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    rc = mbedtls_ecp_group_load(&key_grp, MBEDTLS_ECP_DP_SECP256R1);
+
+    if (rc == 0)
+    {
+        rc = mbedtls_ecp_point_read_binary(&key_grp, &key, crypto_bench_key, sizeof(crypto_bench_key));
+    }
+
+    if (rc == 0)
+    {
+        rc = mbedtls_mpi_read_binary(&r, crypto_bench_sig_r, sizeof(crypto_bench_sig_r));
+    }
+
+    if (rc == 0)
+    {
+        rc = mbedtls_mpi_read_binary(&s, crypto_bench_sig_s, sizeof(crypto_bench_sig_s));
+    }
+
+    start_us = boot_timer_get_us();
+
+    for (run = 0; (rc == 0) && (run < CRYPTO_BENCH_ECDSA_RUNS); run++)
+    {
+        mbedtls_ecp_group_init(&grp);
+        rc = mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1);
+
+        if (rc == 0)
+        {
+            if (use_comb)
+            {
+                ec_precomp_attach(&grp);
+            }
+
+            rc = mbedtls_ecdsa_verify(&grp, crypto_bench_hash, sizeof(crypto_bench_hash), &key, &r, &s);
+            ec_precomp_detach(&grp);
+        }
+
+        mbedtls_ecp_group_free(&grp);
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    *verify_us = (boot_timer_get_us() - start_us) / CRYPTO_BENCH_ECDSA_RUNS;
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_point_free(&key);
+    mbedtls_ecp_group_free(&key_grp);
+
+    return (rc == 0) ? CY_RSLT_SUCCESS : CRYPTO_BENCH_RSLT_ERR_ECDSA;
+}
+#endif /* MCUBOOT_USE_TINYCRYPT */
+
+/******************************************************************************
+ * Function Name: crypto_bench_image
+ ******************************************************************************
+ * Summary:
+ *  Times the verification of the image in the primary slot, read through the
+ *  memory map: hash of the header, image and protected TLVs, and the
+ *  signature when image signing is enabled. Building each crypto backend
+ *  with the same signed image gives comparable results.
+ *
+ * Parameters:
+ *  length    - Set to the number of bytes verified.
+ *  verify_us - Set to the time of the verification, in microseconds.
+ *
+ * Return:
+ *  Status of the verification.
+ *
+ ******************************************************************************/
+static cy_rslt_t crypto_bench_image(uint32_t *length, uint32_t *verify_us)
+{
+    const struct flash_area *fap = NULL;
+    struct image_header hdr;
+    uint32_t start_us;
+    cy_rslt_t result;
+
+    *length = 0;
+    *verify_us = 0;
+
+    result = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fap);
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = image_info_read(fap, &hdr, length);
+    }
+
+    if ((result == CY_RSLT_SUCCESS) && (*length <= fap->fa_size))
+    {
+        start_us = boot_timer_get_us();
+        result = image_verify_mapped(&bench_verify, fap, *length);
+        *verify_us = boot_timer_get_us() - start_us;
+    }
+    else
+    {
+        result = CRYPTO_BENCH_RSLT_ERR_IMAGE;
+    }
+
+    if (fap != NULL)
+    {
+        flash_area_close(fap);
+    }
+
+    return result;
+}
+
+#ifdef CY_BOOT_ENC_IMAGES
+/******************************************************************************
+ * Function Name: crypto_bench_aes_ctr
+ ******************************************************************************
+ * Summary:
+ *  Decrypts CRYPTO_BENCH_HASH_SIZE bytes of the internal flash in chunks of
+ *  "chunk" bytes with AES-128-CTR, as done for an encrypted image.
+ *
+ * Return:
+ *  Time taken, in microseconds.
+ *
+ ******************************************************************************/
+static uint32_t crypto_bench_aes_ctr(uint32_t chunk)
+{
+    uint32_t start_us = boot_timer_get_us();
+    uint32_t off;
+
+    (void)boot_aes_ctr_set_key(&bench_aes, crypto_bench_hash);
+
+    for (off = 0; off < CRYPTO_BENCH_HASH_SIZE; off += chunk)
+    {
+        (void)boot_aes_ctr_crypt(&bench_aes, off,
+                (const uint8_t *)(CRYPTO_BENCH_HASH_ADDR + off), bench_aes_buf, chunk);
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    boot_aes_free(&bench_aes);
+
+    return boot_timer_get_us() - start_us;
+}
+
+/******************************************************************************
+ * Function Name: crypto_bench_enc
+ ******************************************************************************
+ * Summary:
+ *  Prints the AES-128-CTR throughput for each chunk size, the time taken to
+ *  decrypt a full slot at the row size, and the time of the ECDH computation
+ *  of the key unwrap.
+ *
+ ******************************************************************************/
+static void crypto_bench_enc(void)
+{
+    uint8_t secret[BOOT_EC_P256_SIZE];
+    uint32_t elapsed_us;
+    uint32_t rate;
+    uint32_t row_rate = 0;
+    uint32_t i;
+    int rc;
+
+    for (i = 0; i < (sizeof(crypto_bench_aes_chunks) / sizeof(crypto_bench_aes_chunks[0])); i++)
+    {
+        elapsed_us = crypto_bench_aes_ctr(crypto_bench_aes_chunks[i]);
+        rate = (elapsed_us != 0) ?
+               (uint32_t)(((uint64_t)CRYPTO_BENCH_HASH_SIZE * 1000000ULL) / elapsed_us) : 0;
+
+        BOOT_LOG_INF("AES-128-CTR, %5u-byte chunks: %u bytes in %u us (%u bytes/s)",
+                (unsigned int)crypto_bench_aes_chunks[i], (unsigned int)CRYPTO_BENCH_HASH_SIZE,
+                (unsigned int)elapsed_us, (unsigned int)rate);
+
+        if (i == 0U)
+        {
+            row_rate = rate;
+        }
+    }
+
+    if (row_rate != 0UL)
+    {
+        BOOT_LOG_INF("AES-128-CTR, primary slot of %u bytes: %u ms",
+                (unsigned int)CY_BOOT_PRIMARY_1_SIZE,
+                (unsigned int)(((uint64_t)CY_BOOT_PRIMARY_1_SIZE * 1000ULL) / row_rate));
+    }
+
+    /* The public key of the signature test vector stands for the ephemeral
+     * key of an image.
+     */
+    elapsed_us = boot_timer_get_us();
+    rc = boot_ecdh_p256(enc_image_priv_key, crypto_bench_key, secret);
+    elapsed_us = boot_timer_get_us() - elapsed_us;
+    memset(secret, 0, sizeof(secret));
+
+    if (rc == 0)
+    {
+        BOOT_LOG_INF("ECDH P-256 (key unwrap): %u us", (unsigned int)elapsed_us);
+    }
+    else
+    {
+        BOOT_LOG_ERR("ECDH P-256 failed !");
+    }
+}
+#endif /* CY_BOOT_ENC_IMAGES */
+
+/******************************************************************************
+ * Function Name: crypto_bench_run
+ ******************************************************************************
+ * Summary:
+ *  Runs the crypto self-test and prints the results: the SHA-256 throughput
+ *  for each chunk size, the chunk size that performed best (to be used for
+ *  HASH_CHUNK_SIZE), the ECDSA P-256 verification time (without and with
+ *  the precomputed comb table of the base point, with mbedTLS), the AES-CTR
+ *  throughput with EN_ENC_IMAGES=1, and the time of a full verification of
+ *  the primary slot. Build the bootloader with
+ *  each CRYPTO_BACKEND to compare the backends.
+ *
+ * Return:
+ *  Status of the signature verification.
+ *
+ ******************************************************************************/
+cy_rslt_t crypto_bench_run(void)
+{
+    cy_rslt_t result;
+    uint32_t elapsed_us;
+#if !defined(MCUBOOT_USE_TINYCRYPT)
+    uint32_t comb_us = 0;
+#endif
+    uint32_t image_us;
+    uint32_t length;
+    uint32_t rate;
+    uint32_t best_rate = 0;
+    uint32_t best_chunk = 0;
+    uint32_t i;
+
+    BOOT_LOG_INF("Crypto self-test: %s, CPU %u kHz", BOOT_CRYPTO_IMPL,
+            (unsigned int)(SystemCoreClock / 1000UL));
+
+    for (i = 0; i < (sizeof(crypto_bench_chunks) / sizeof(crypto_bench_chunks[0])); i++)
+    {
+        elapsed_us = crypto_bench_sha256(crypto_bench_chunks[i]);
+        rate = (elapsed_us != 0) ?
+               (uint32_t)(((uint64_t)CRYPTO_BENCH_HASH_SIZE * 1000000ULL) / elapsed_us) : 0;
+
+        BOOT_LOG_INF("SHA-256, %5u-byte chunks: %u bytes in %u us (%u bytes/s)",
+                (unsigned int)crypto_bench_chunks[i], (unsigned int)CRYPTO_BENCH_HASH_SIZE,
+                (unsigned int)elapsed_us, (unsigned int)rate);
+
+        if (rate > best_rate)
+        {
+            best_rate = rate;
+            best_chunk = crypto_bench_chunks[i];
+        }
+    }
+
+    BOOT_LOG_INF("SHA-256 best chunk size: %u bytes (HASH_CHUNK_SIZE is %u)",
+            (unsigned int)best_chunk, (unsigned int)CY_BOOT_HASH_CHUNK_SIZE);
+
+    result = crypto_bench_ecdsa(false, &elapsed_us);
+
+#if defined(MCUBOOT_USE_TINYCRYPT)
+    if (result == CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_INF("ECDSA P-256 verify: %u us", (unsigned int)elapsed_us);
+    }
+#else
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = crypto_bench_ecdsa(true, &comb_us);
+    }
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_INF("ECDSA P-256 verify: %u us, %u us with the comb table",
+                (unsigned int)elapsed_us, (unsigned int)comb_us);
+    }
+#endif
+    else
+    {
+        BOOT_LOG_ERR("ECDSA P-256 test signature rejected !");
+    }
+
+#ifdef CY_BOOT_ENC_IMAGES
+    crypto_bench_enc();
+#endif
+
+    if (crypto_bench_image(&length, &image_us) == CY_RSLT_SUCCESS)
+    {
+#ifdef MCUBOOT_SIGN_EC256
+        BOOT_LOG_INF("Primary slot verify (hash + signature): %u bytes in %u us",
+                (unsigned int)length, (unsigned int)image_us);
+#else
+        BOOT_LOG_INF("Primary slot verify (hash): %u bytes in %u us",
+                (unsigned int)length, (unsigned int)image_us);
+#endif
+    }
+    else
+    {
+        BOOT_LOG_WRN("Primary slot verify: no valid image");
+    }
+
+    return result;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,557 @@
+/******************************************************************************
+ * File Name: delta_patch.c
+ *
+ * Description: This file contains the expansion of delta images: a patch
+ * against the image in primary slot, stored in secondary slot in place of a
+ * new image. See common/script/delta_patch.py for the format.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/* Standard headers. */
+#include <stddef.h>
+#include <string.h>
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/bootutil.h"
+#include "bootutil/bootutil_log.h"
+
+/*  Flash access headers. */
+#include "flash_map_backend/flash_map_backend.h"
+#include "sysflash.h"
+
+/* Local headers. */
+#include "delta_patch.h"
+#include "boot_crypto.h"
+#include "boot_timer.h"
+#include "crc32.h"
+#include "image_verify.h"
+#include "lz_stream.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Error returned on a malformed delta image. */
+#define DELTA_PATCH_RSLT_ERR_FORMAT     (1UL)
+
+/* Error returned when primary slot doesn't hold the base image of the delta. */
+#define DELTA_PATCH_RSLT_ERR_BASE       (2UL)
+
+/* Size of the buffers used for copying and expanding the delta image. */
+#define DELTA_PATCH_BUF_SIZE            (512UL)
+
+/* Round a size up to a multiple of the external memory erase size. */
+#define ERASE_ALIGN_UP(x)               (((x) + CY_EXT_FLASH_ERASE_SIZE - 1UL) & \
+                                         ~(CY_EXT_FLASH_ERASE_SIZE - 1UL))
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+/* Patch record, see common/script/delta_patch.py. */
+typedef struct
+{
+    uint32_t add_len;           /* Bytes added to the base image. */
+    uint32_t extra_len;         /* Bytes inserted as is. */
+    int32_t seek;               /* Move of the base image position. */
+} delta_patch_rec_t;
+
+/* Compile-time check: the staging area must be made of whole erase sectors. */
+typedef char delta_patch_staging_check[((CY_BOOT_DELTA_STAGING_SIZE % CY_EXT_FLASH_ERASE_SIZE) == 0) ? 1 : -1];
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+static lz_stream_t delta_lz_stream;
+static boot_sha256_context delta_sha;
+static uint8_t delta_out_buf[DELTA_PATCH_BUF_SIZE];
+static uint8_t delta_old_buf[DELTA_PATCH_BUF_SIZE];
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t delta_patch_check(const struct flash_area *fap, uint32_t off,
+                                   uint32_t max_new_size, delta_patch_hdr_t *hdr);
+static cy_rslt_t delta_patch_stage(const struct flash_area *fap, uint32_t staging_off);
+static cy_rslt_t delta_patch_check_base(const struct flash_area *fap_primary,
+                                        const delta_patch_hdr_t *hdr);
+static cy_rslt_t delta_patch_flush(const struct flash_area *fap, uint32_t *out_off,
+                                   uint32_t *out_len);
+static cy_rslt_t delta_patch_expand(const struct flash_area *fap_primary,
+                                    const struct flash_area *fap_secondary,
+                                    uint32_t staging_off, const delta_patch_hdr_t *hdr);
+
+/******************************************************************************
+ * Function Name: delta_patch_check
+ ******************************************************************************
+ * Summary:
+ *  Reads the header of a delta image, checks the sizes it announces and the
+ *  CRC of the header and of the patch.
+ *
+ * Parameters:
+ *  fap          - Flash area holding the delta image.
+ *  off          - Offset of the delta image in the flash area.
+ *  max_new_size - Largest expanded image that fits the flash area.
+ *  hdr          - Filled with the header.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t delta_patch_check(const struct flash_area *fap, uint32_t off,
+                                   uint32_t max_new_size, delta_patch_hdr_t *hdr)
+{
+    cy_rslt_t result;
+    uint32_t crc;
+    uint32_t pos;
+    uint32_t len;
+
+    result = flash_area_read(fap, off, hdr, sizeof(*hdr));
+
+    if ((result == CY_RSLT_SUCCESS) &&
+        ((hdr->magic != DELTA_PATCH_MAGIC) ||
+         (hdr->patch_size > (CY_BOOT_DELTA_STAGING_SIZE - sizeof(*hdr))) ||
+         (hdr->new_size > max_new_size) || (hdr->new_size == 0)))
+    {
+        result = DELTA_PATCH_RSLT_ERR_FORMAT;
+    }
+
+    crc = crc32_update(0, hdr, offsetof(delta_patch_hdr_t, crc));
+    off += sizeof(*hdr);
+
+    for (pos = 0; (result == CY_RSLT_SUCCESS) && (pos < hdr->patch_size); pos += len)
+    {
+        len = ((hdr->patch_size - pos) > DELTA_PATCH_BUF_SIZE) ?
+                DELTA_PATCH_BUF_SIZE : (hdr->patch_size - pos);
+        result = flash_area_read(fap, off + pos, delta_out_buf, len);
+        crc = crc32_update(crc, delta_out_buf, len);
+    }
+
+    if ((result == CY_RSLT_SUCCESS) && (crc != hdr->crc))
+    {
+        BOOT_LOG_ERR("Delta image CRC doesn't match !");
+        result = DELTA_PATCH_RSLT_ERR_FORMAT;
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: delta_patch_stage
+ ******************************************************************************
+ * Summary:
+ *  Copies the delta image from offset 0 of secondary slot to the staging
+ *  area, so that the beginning of the slot can be overwritten with the
+ *  expanded image. The copy is checked by the caller.
+ *
+ * Parameters:
+ *  fap         - Secondary slot.
+ *  staging_off - Offset of the staging area in secondary slot.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t delta_patch_stage(const struct flash_area *fap, uint32_t staging_off)
+{
+    cy_rslt_t result;
+    delta_patch_hdr_t hdr;
+    uint32_t total;
+    uint32_t pos;
+    uint32_t len;
+
+    result = flash_area_read(fap, 0, &hdr, sizeof(hdr));
+    total = sizeof(hdr) + hdr.patch_size;
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = flash_area_erase(fap, staging_off, CY_BOOT_DELTA_STAGING_SIZE);
+    }
+
+    for (pos = 0; (result == CY_RSLT_SUCCESS) && (pos < total); pos += len)
+    {
+        len = ((total - pos) > DELTA_PATCH_BUF_SIZE) ? DELTA_PATCH_BUF_SIZE : (total - pos);
+        result = flash_area_read(fap, pos, delta_out_buf, len);
+
+        if (result == CY_RSLT_SUCCESS)
+        {
+            result = flash_area_write(fap, staging_off + pos, delta_out_buf, len);
+        }
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: delta_patch_check_base
+ ******************************************************************************
+ * Summary:
+ *  Checks that primary slot holds the image the delta was generated against.
+ *  Primary slot is hashed through the memory map.
+ *
+ * Parameters:
+ *  fap_primary - Primary slot.
+ *  hdr         - Header of the delta image.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t delta_patch_check_base(const struct flash_area *fap_primary,
+                                        const delta_patch_hdr_t *hdr)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint8_t hash[DELTA_PATCH_HASH_SIZE];
+    uint32_t off;
+    uint32_t len;
+
+    if ((hdr->old_size > fap_primary->fa_size) || (boot_sha256_start(&delta_sha) != 0))
+    {
+        result = DELTA_PATCH_RSLT_ERR_BASE;
+    }
+
+    for (off = 0; (result == CY_RSLT_SUCCESS) && (off < hdr->old_size); off += len)
+    {
+        len = ((hdr->old_size - off) > CY_BOOT_HASH_CHUNK_SIZE) ?
+                CY_BOOT_HASH_CHUNK_SIZE : (hdr->old_size - off);
+        (void)boot_sha256_update(&delta_sha, (const void *)(fap_primary->fa_off + off), len);
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    if ((result == CY_RSLT_SUCCESS) &&
+        ((boot_sha256_finish(&delta_sha, hash) != 0) ||
+         (memcmp(hash, hdr->old_hash, sizeof(hash)) != 0)))
+    {
+        result = DELTA_PATCH_RSLT_ERR_BASE;
+    }
+
+    boot_sha256_free(&delta_sha);
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: delta_patch_flush
+ ******************************************************************************
+ * Summary:
+ *  Writes the expanded bytes buffered in delta_out_buf to secondary slot and
+ *  adds them to the hash of the expanded image.
+ *
+ * Parameters:
+ *  fap     - Secondary slot.
+ *  out_off - Offset of the buffer in the expanded image, advanced.
+ *  out_len - Number of bytes buffered, cleared.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t delta_patch_flush(const struct flash_area *fap, uint32_t *out_off,
+                                   uint32_t *out_len)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (*out_len > 0)
+    {
+        result = flash_area_write(fap, *out_off, delta_out_buf, *out_len);
+        (void)boot_sha256_update(&delta_sha, delta_out_buf, *out_len);
+
+        *out_off += *out_len;
+        *out_len = 0;
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: delta_patch_expand
+ ******************************************************************************
+ * Summary:
+ *  Expands the staged delta image into the new image at offset 0 of
+ *  secondary slot. The patch is decompressed and applied on the fly, the
+ *  base image is read from primary slot, and the output is hashed while it
+ *  is written. Every record is bounds-checked against the header sizes.
+ *
+ * Parameters:
+ *  fap_primary   - Primary slot, holding the base image.
+ *  fap_secondary - Secondary slot.
+ *  staging_off   - Offset of the staged delta image in secondary slot.
+ *  hdr           - Header of the staged delta image.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t delta_patch_expand(const struct flash_area *fap_primary,
+                                    const struct flash_area *fap_secondary,
+                                    uint32_t staging_off, const delta_patch_hdr_t *hdr)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    struct flash_area fap_patch;
+    lz_stream_hdr_t lz_hdr;
+    delta_patch_rec_t rec;
+    uint8_t hash[DELTA_PATCH_HASH_SIZE];
+    uint32_t patch_pos = 0, old_pos = 0, out_off = 0, out_len = 0;
+    uint32_t left, len, i;
+    int64_t seek_pos;
+
+    /* Dummy flash area on the lz_stream container of the staged delta. */
+    fap_patch = *fap_secondary;
+    fap_patch.fa_off += staging_off + sizeof(*hdr);
+    fap_patch.fa_size = hdr->patch_size;
+
+    if (!lz_stream_probe(&fap_patch, &lz_hdr))
+    {
+        BOOT_LOG_ERR("Invalid patch in delta image");
+        result = DELTA_PATCH_RSLT_ERR_FORMAT;
+    }
+    else
+    {
+        result = lz_stream_init(&delta_lz_stream, &fap_patch, &lz_hdr);
+    }
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = flash_area_erase(fap_secondary, 0, ERASE_ALIGN_UP(hdr->new_size));
+    }
+
+    if ((result == CY_RSLT_SUCCESS) && (boot_sha256_start(&delta_sha) != 0))
+    {
+        result = DELTA_PATCH_RSLT_ERR_FORMAT;
+    }
+
+    while ((result == CY_RSLT_SUCCESS) && ((out_off + out_len) < hdr->new_size))
+    {
+        result = lz_stream_read(&delta_lz_stream, patch_pos, &rec, sizeof(rec));
+        patch_pos += sizeof(rec);
+        left = hdr->new_size - (out_off + out_len);
+
+        if ((result == CY_RSLT_SUCCESS) &&
+            (((rec.add_len == 0) && (rec.extra_len == 0)) ||
+             (rec.add_len > left) || (rec.extra_len > (left - rec.add_len)) ||
+             (rec.add_len > (hdr->old_size - old_pos))))
+        {
+            BOOT_LOG_ERR("Invalid record in delta image @ 0x%x", (unsigned int)patch_pos);
+            result = DELTA_PATCH_RSLT_ERR_FORMAT;
+        }
+
+        /* Bytes of the base image plus a difference. */
+        for (left = rec.add_len; (result == CY_RSLT_SUCCESS) && (left > 0); left -= len)
+        {
+            len = DELTA_PATCH_BUF_SIZE - out_len;
+            len = (left > len) ? len : left;
+            result = lz_stream_read(&delta_lz_stream, patch_pos, &delta_out_buf[out_len], len);
+
+            if (result == CY_RSLT_SUCCESS)
+            {
+                result = flash_area_read(fap_primary, old_pos, delta_old_buf, len);
+            }
+
+            for (i = 0; i < len; i++)
+            {
+                delta_out_buf[out_len + i] += delta_old_buf[i];
+            }
+
+            patch_pos += len;
+            old_pos += len;
+            out_len += len;
+
+            if ((result == CY_RSLT_SUCCESS) && (out_len == DELTA_PATCH_BUF_SIZE))
+            {
+                result = delta_patch_flush(fap_secondary, &out_off, &out_len);
+            }
+        }
+
+        /* Inserted bytes. */
+        for (left = rec.extra_len; (result == CY_RSLT_SUCCESS) && (left > 0); left -= len)
+        {
+            len = DELTA_PATCH_BUF_SIZE - out_len;
+            len = (left > len) ? len : left;
+            result = lz_stream_read(&delta_lz_stream, patch_pos, &delta_out_buf[out_len], len);
+
+            patch_pos += len;
+            out_len += len;
+
+            if ((result == CY_RSLT_SUCCESS) && (out_len == DELTA_PATCH_BUF_SIZE))
+            {
+                result = delta_patch_flush(fap_secondary, &out_off, &out_len);
+            }
+        }
+
+        seek_pos = (int64_t)old_pos + rec.seek;
+
+        if ((result == CY_RSLT_SUCCESS) && ((seek_pos < 0) || (seek_pos > hdr->old_size)))
+        {
+            BOOT_LOG_ERR("Invalid seek in delta image @ 0x%x", (unsigned int)patch_pos);
+            result = DELTA_PATCH_RSLT_ERR_FORMAT;
+        }
+
+        old_pos = (uint32_t)seek_pos;
+    }
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = delta_patch_flush(fap_secondary, &out_off, &out_len);
+    }
+
+    if ((result == CY_RSLT_SUCCESS) &&
+        ((boot_sha256_finish(&delta_sha, hash) != 0) ||
+         (memcmp(hash, hdr->new_hash, sizeof(hash)) != 0)))
+    {
+        BOOT_LOG_ERR("Expanded image hash doesn't match !");
+        result = DELTA_PATCH_RSLT_ERR_FORMAT;
+    }
+
+    boot_sha256_free(&delta_sha);
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: delta_patch_apply
+ ******************************************************************************
+ * Summary:
+ *  Expands a delta image pending in secondary slot into the new image, before
+ *  boot_go() validates and installs it. The delta image is first copied to a
+ *  staging area at the end of secondary slot; an expansion interrupted by a
+ *  reset or a power failure is restarted from the staged copy, as primary
+ *  slot still holds the base image. On success and on unrecoverable errors
+ *  the staging area is erased. A secondary slot left without a valid image
+ *  is then discarded by boot_go().
+ *
+ * Return:
+ *  Status of the operation. CY_RSLT_SUCCESS when no delta image is pending.
+ *
+ ******************************************************************************/
+cy_rslt_t delta_patch_apply(void)
+{
+    cy_rslt_t result;
+    const struct flash_area *fap_primary = NULL;
+    const struct flash_area *fap_secondary = NULL;
+    delta_patch_hdr_t hdr;
+    uint32_t staging_off = 0;
+    uint32_t start_us;
+    bool staged = false;
+
+    result = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fap_primary);
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = flash_area_open(FLASH_AREA_IMAGE_SECONDARY(0), &fap_secondary);
+    }
+
+    if (result != CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_ERR("Failed to open image slots !");
+    }
+    else if (boot_swap_type() != BOOT_SWAP_TYPE_NONE)
+    {
+        /* The last erase sector holds the image trailer. */
+        staging_off = fap_secondary->fa_size - CY_EXT_FLASH_ERASE_SIZE -
+                CY_BOOT_DELTA_STAGING_SIZE;
+
+        if ((flash_area_read(fap_secondary, 0, &hdr.magic, sizeof(hdr.magic)) == CY_RSLT_SUCCESS) &&
+            (hdr.magic == DELTA_PATCH_MAGIC))
+        {
+            result = delta_patch_check(fap_secondary, 0, staging_off, &hdr);
+
+            if (result == CY_RSLT_SUCCESS)
+            {
+                BOOT_LOG_INF("Delta image found (%u -> %u bytes)",
+                        (unsigned int)(sizeof(hdr) + hdr.patch_size), (unsigned int)hdr.new_size);
+
+                result = delta_patch_stage(fap_secondary, staging_off);
+            }
+
+            if (result == CY_RSLT_SUCCESS)
+            {
+                result = delta_patch_check(fap_secondary, staging_off, staging_off, &hdr);
+            }
+
+            staged = true;
+        }
+        else if (delta_patch_check(fap_secondary, staging_off, staging_off, &hdr) ==
+                 CY_RSLT_SUCCESS)
+        {
+            BOOT_LOG_INF("Detected interrupted expansion of delta image, restarting it");
+            staged = true;
+        }
+        else
+        {
+            /* Full image: left to boot_go(). */
+        }
+    }
+    else
+    {
+        /* No update pending. */
+    }
+
+    if (staged && (result == CY_RSLT_SUCCESS))
+    {
+        start_us = boot_timer_get_us();
+        result = delta_patch_check_base(fap_primary, &hdr);
+
+        if (result != CY_RSLT_SUCCESS)
+        {
+            BOOT_LOG_ERR("Primary slot doesn't hold the base image of the delta !");
+        }
+        else
+        {
+            result = delta_patch_expand(fap_primary, fap_secondary, staging_off, &hdr);
+        }
+
+        if (result == CY_RSLT_SUCCESS)
+        {
+            BOOT_LOG_INF("Delta image expanded (%u bytes) in %u ms",
+                    (unsigned int)hdr.new_size,
+                    (unsigned int)((boot_timer_get_us() - start_us) / 1000UL));
+        }
+    }
+
+    if (staged && (fap_secondary != NULL) &&
+        ((result == CY_RSLT_SUCCESS) || (result == DELTA_PATCH_RSLT_ERR_FORMAT) ||
+         (result == DELTA_PATCH_RSLT_ERR_BASE)))
+    {
+        /* Done, or the delta image can't be applied: don't restart it. */
+        (void)flash_area_erase(fap_secondary, staging_off, CY_BOOT_DELTA_STAGING_SIZE);
+    }
+
+    flash_area_close(fap_secondary);
+    flash_area_close(fap_primary);
+
+    return result;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * File Name: delta_patch.h
+ *
+ * Description: This file contains declaration of the delta image support. A
+ * delta image in secondary slot holds the difference between the image in
+ * primary slot and a new image (see common/script/delta_patch.py). The
+ * bootloader expands it into the new image in secondary slot, which MCUboot
+ * then validates and installs as any other update.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_DELTA_PATCH_H_
+#define SOURCE_DELTA_PATCH_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+#include "ext_flash_map.h"
+
+/* Delta image magic: "DLT1". */
+#define DELTA_PATCH_MAGIC               (0x31544C44UL)
+
+/* Size of the SHA-256 hashes of the header. */
+#define DELTA_PATCH_HASH_SIZE           (32UL)
+
+/* Size of the secondary slot area holding a copy of the delta image while
+ * it is expanded. Placed just below the last erase sector of the slot (image
+ * trailer). Must be a multiple of the erase size of the external memory.
+ */
+#ifndef CY_BOOT_DELTA_STAGING_SIZE
+#define CY_BOOT_DELTA_STAGING_SIZE      (CY_EXT_FLASH_ERASE_SIZE)
+#endif
+
+/* Header of a delta image, followed by the patch in an lz_stream container. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t patch_size;        /* Size of the lz_stream container. */
+    uint32_t old_size;          /* Size of the base image in primary slot. */
+    uint32_t new_size;          /* Size of the expanded image. */
+    uint8_t old_hash[DELTA_PATCH_HASH_SIZE];
+    uint8_t new_hash[DELTA_PATCH_HASH_SIZE];
+    uint32_t crc;               /* CRC-32 of the fields above and of the patch. */
+} delta_patch_hdr_t;
+
+cy_rslt_t delta_patch_apply(void);
+
+#endif /* SOURCE_DELTA_PATCH_H_ */
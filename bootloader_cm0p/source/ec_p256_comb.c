@@ -0,0 +1,102 @@
+/******************************************************************************
+ * File Name: ec_p256_comb.c
+ *
+ * Description: Comb table of the NIST P-256 base point (w = 5), in the point representation of mbedTLS.
+ *
+ * Generated by common/script/ec_precomp.py. Do not edit.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************/
+
+#include "ec_precomp.h"
+
+#if !defined(MBEDTLS_ECP_ALT)
+
+static const mbedtls_mpi_uint ec_p256_comb_one[1] = { 1U };
+
+static const mbedtls_mpi_uint ec_p256_comb_xy[EC_P256_COMB_SIZE][2][EC_PRECOMP_LIMBS] =
+{
+    {
+        { 0xd898c296U, 0xf4a13945U, 0x2deb33a0U, 0x77037d81U, 0x63a440f2U, 0xf8bce6e5U, 0xe12c4247U, 0x6b17d1f2U },
+        { 0x37bf51f5U, 0xcbb64068U, 0x6b315eceU, 0x2bce3357U, 0x7c0f9e16U, 0x8ee7eb4aU, 0xfe1a7f9bU, 0x4fe342e2U },
+    },
+    {
+        { 0x04bac870U, 0xf7d24bb7U, 0x3a23c6abU, 0x593a09a0U, 0xf94c9d1dU, 0xdfcc2358U, 0x297bed02U, 0x3cfa0f87U },
+        { 0x40f26940U, 0xce98a30bU, 0x0248a8afU, 0x62121c0dU, 0x8309af9bU, 0xa758aa80U, 0x70be12c6U, 0xe4e37694U },
+    },
+    {
+        { 0x86ef7d7dU, 0xdd37e3ffU, 0x088b86dbU, 0xf6d77c27U, 0x254c5491U, 0x28fe9a4fU, 0x6df0fd5eU, 0xd6690337U },
+        { 0xaddad596U, 0x9ff04992U, 0x9e4373f9U, 0xf3d1a7afU, 0xdf074167U, 0xa13e9578U, 0xe6d13d22U, 0x20e2a53cU },
+    },
+    {
+        { 0x525d6abfU, 0xaebfd735U, 0x96bea25aU, 0xc302f8f4U, 0x544920a4U, 0xdb82b3eaU, 0x02eadb2eU, 0x621c75d1U },
+        { 0x9ef485f0U, 0x8939dc4cU, 0x57c46d63U, 0x225d03d8U, 0x522d7f70U, 0x4fdac96fU, 0xb4fa649dU, 0xd7c4a4feU },
+    },
+    {
+        { 0xc0b9372aU, 0x8bc659aaU, 0xedd9583fU, 0xf7659958U, 0x8c267d88U, 0x9f05f94aU, 0xc99a739dU, 0x00dc46e7U },
+        { 0xdf55d0f2U, 0x4af50a00U, 0x8156bf6aU, 0xb5eb202dU, 0x5228c111U, 0x40d1e3abU, 0x45793424U, 0x0312a557U },
+    },
+    {
+        { 0x7eb8cfeeU, 0x8d9692f7U, 0x0d8c013dU, 0x05e3f223U, 0x84e32e59U, 0x76347a52U, 0x15b0a1e5U, 0x3c53e290U },
+        { 0xfae798d4U, 0x538b7da5U, 0x00d23591U, 0x1b9f1bd1U, 0x9a08693fU, 0x11a9f072U, 0x140efeb3U, 0xd30e7cdaU },
+    },
+    {
+        { 0xf8e8f683U, 0x6dfcf787U, 0x3f7fbe90U, 0x13d72b7aU, 0x2df232cfU, 0xfd426d94U, 0x5fe39aadU, 0xed84bb42U },
+        { 0x732995fcU, 0x023e67a1U, 0x355430e3U, 0x67dd0a8eU, 0x97a1d703U, 0x0cf83b61U, 0x583c33f2U, 0xa3233455U },
+    },
+    {
+        { 0x5f165d99U, 0xcebbbc7bU, 0x8a4eee61U, 0x50cc51c1U, 0x1b4d0d1fU, 0xb31d2353U, 0x66382adaU, 0x95e18452U },
+        { 0x0a839b5bU, 0xacad4f81U, 0x4142ff0fU, 0xa0a2a96eU, 0x1f4fa12fU, 0x3eaa8289U, 0x6b0fb8f3U, 0x68d68c8fU },
+    },
+    {
+        { 0x51bbb3f1U, 0x9311a269U, 0x8d0f4f65U, 0xe80f26bdU, 0x6beccbb9U, 0x9d3dc334U, 0x101e5de4U, 0x54e244d5U },
+        { 0xf1b19e28U, 0xb3ad4c6eU, 0x58c2e3b7U, 0x4334fbc0U, 0x35df9c25U, 0x19bd4107U, 0xec106eb6U, 0xd6bbec0eU },
+    },
+    {
+        { 0x3fefcfc8U, 0xe8881a83U, 0xb9b5290bU, 0xaea3c9e0U, 0x771e4688U, 0x10b37ecdU, 0xd4d021b6U, 0xee0816a3U },
+        { 0xb3a8caa1U, 0x8e9929bfU, 0xc105f2d1U, 0x48915dcfU, 0xdb49019fU, 0x3a5fdf82U, 0xad9006e1U, 0xc4a438e3U },
+    },
+    {
+        { 0xe83ad2c9U, 0x5d6dc503U, 0xaed035beU, 0xca9f7a1dU, 0xcbd21e33U, 0x552788acU, 0xe09cb9f0U, 0x8699dd31U },
+        { 0x329bf961U, 0x38584196U, 0xb82a5af9U, 0x4cb20e96U, 0xc72c78c1U, 0x24199908U, 0xe92859b7U, 0x16e65484U },
+    },
+    {
+        { 0xdb3038ddU, 0xa20a2c70U, 0xe99d5c7cU, 0x5f0b46d5U, 0x4b600b83U, 0xc9b97d37U, 0x3df3245eU, 0x186c7f79U },
+        { 0x4f1ce57fU, 0x2af72460U, 0x91e2d8edU, 0x9249897fU, 0x8d2ea797U, 0x8139b36aU, 0x9ab58913U, 0x9c428db8U },
+    },
+    {
+        { 0x4be6458dU, 0x1f1e4f3fU, 0x595e6547U, 0x5f72cc22U, 0x271a93f1U, 0x5bc5341eU, 0x58a5f263U, 0xc62e155cU },
+        { 0x58ba7ff4U, 0x5f6f845aU, 0x7e36a6adU, 0x67e1f7dcU, 0xeeaa4d04U, 0xd33a7657U, 0x18267e4eU, 0xff9f2322U },
+    },
+    {
+        { 0xc7644c1dU, 0xe33f0255U, 0xbb9002d8U, 0x4030ecc3U, 0xf4646f9fU, 0xa4486916U, 0x959c44faU, 0x5e677d0cU },
+        { 0xd88b9144U, 0xe2e7d7d0U, 0x6248f91fU, 0x5d93a86fU, 0x02993aeaU, 0xe33d0bd5U, 0x3100d31eU, 0x449f0ce6U },
+    },
+    {
+        { 0xfdaab256U, 0x52df1588U, 0x3127354cU, 0x68c0cd44U, 0xa591f853U, 0x2a849471U, 0x93d0cb92U, 0xe4da88e9U },
+        { 0x1639c624U, 0x6d1ea35dU, 0x263707baU, 0x60fe2a36U, 0xd0f3bc51U, 0x97fc50deU, 0x10062e80U, 0xf7fa4d15U },
+    },
+    {
+        { 0x5b696527U, 0x2e75a266U, 0x5a00169cU, 0x1a2530b0U, 0x4286fb42U, 0x76c4c180U, 0x8e831d5bU, 0x825f0194U },
+        { 0xef703739U, 0xdbf0a11fU, 0xce5b106aU, 0x106f9bc4U, 0x24111150U, 0x61794c4fU, 0xbc723a17U, 0x435872feU },
+    },
+};
+
+#define EC_P256_COMB_MPI(v)     { .s = 1, .n = EC_PRECOMP_LIMBS, .p = (mbedtls_mpi_uint *)(v) }
+#define EC_P256_COMB_ONE        { .s = 1, .n = 1U, .p = (mbedtls_mpi_uint *)ec_p256_comb_one }
+#define EC_P256_COMB_POINT(i)   { .X = EC_P256_COMB_MPI(ec_p256_comb_xy[i][0]), \
+                                  .Y = EC_P256_COMB_MPI(ec_p256_comb_xy[i][1]), \
+                                  .Z = EC_P256_COMB_ONE }
+
+const mbedtls_ecp_point ec_p256_comb[EC_P256_COMB_SIZE] =
+{
+    EC_P256_COMB_POINT(0), EC_P256_COMB_POINT(1), EC_P256_COMB_POINT(2), EC_P256_COMB_POINT(3),
+    EC_P256_COMB_POINT(4), EC_P256_COMB_POINT(5), EC_P256_COMB_POINT(6), EC_P256_COMB_POINT(7),
+    EC_P256_COMB_POINT(8), EC_P256_COMB_POINT(9), EC_P256_COMB_POINT(10), EC_P256_COMB_POINT(11),
+    EC_P256_COMB_POINT(12), EC_P256_COMB_POINT(13), EC_P256_COMB_POINT(14), EC_P256_COMB_POINT(15),
+};
+
+#endif /* !MBEDTLS_ECP_ALT */
+
+/* [] END OF FILE */
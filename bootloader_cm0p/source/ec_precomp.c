@@ -0,0 +1,267 @@
+/******************************************************************************
+ * File Name: ec_precomp.c
+ *
+ * Description: This file implements the ECDSA P-256 signature verification of
+ * the bootloader using precomputed data: the image signing keys decoded at
+ * build time, so that they are not parsed on every boot, and a constant comb
+ * table of the base point in flash, which mbedTLS otherwise computes in RAM
+ * for every verification.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <string.h>
+
+/* mbedTLS header files. */
+#include "mbedtls/asn1.h"
+#include "mbedtls/ecdsa.h"
+
+/* MCUboot header files. */
+#include "bootutil/sign_key.h"
+#include "bootutil_priv.h"
+
+/* Local headers. */
+#include "ec_precomp.h"
+#include "boot_crypto.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Error returned when the signature can't be verified. */
+#define EC_PRECOMP_RSLT_ERR_INVALID (1UL)
+
+/* The comb table is used by mbedTLS only if it picks the same window for the
+ * base point (see ecp_pick_window() in ecp.c).
+ */
+#if !defined(MBEDTLS_ECP_ALT) && \
+    ((MBEDTLS_ECP_FIXED_POINT_OPTIM != 1) || (MBEDTLS_ECP_WINDOW_SIZE < 5))
+#error "The P-256 comb table requires MBEDTLS_ECP_FIXED_POINT_OPTIM=1 and MBEDTLS_ECP_WINDOW_SIZE >= 5"
+#endif
+
+/* Compile-time check: the generated data uses 32-bit limbs. */
+typedef char ec_precomp_limb_size_check[(sizeof(mbedtls_mpi_uint) == sizeof(uint32_t)) ? 1 : -1];
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+static const mbedtls_mpi_uint ec_precomp_one[1] = { 1U };
+
+/******************************************************************************
+ * Function Name: ec_precomp_attach
+ ******************************************************************************
+ * Summary:
+ *  Hands the constant comb table of the base point over to a P-256 group, so
+ *  that mbedTLS does not compute it. Call ec_precomp_detach() before freeing
+ *  the group. No-op with the hardware-accelerated ECP implementation.
+ *
+ * Parameters:
+ *  grp - Group loaded with MBEDTLS_ECP_DP_SECP256R1.
+ *
+ ******************************************************************************/
+void ec_precomp_attach(mbedtls_ecp_group *grp)
+{
+#if !defined(MBEDTLS_ECP_ALT)
+    if ((grp->id == MBEDTLS_ECP_DP_SECP256R1) && (grp->T == NULL))
+    {
+        grp->T = (mbedtls_ecp_point *)ec_p256_comb;
+        grp->T_size = EC_P256_COMB_SIZE;
+    }
+#else
+    (void)grp;
+#endif
+}
+
+/******************************************************************************
+ * Function Name: ec_precomp_detach
+ ******************************************************************************
+ * Summary:
+ *  Removes the constant comb table from a group, as mbedTLS frees the table
+ *  of a group in mbedtls_ecp_group_free().
+ *
+ * Parameters:
+ *  grp - Group passed to ec_precomp_attach().
+ *
+ ******************************************************************************/
+void ec_precomp_detach(mbedtls_ecp_group *grp)
+{
+#if !defined(MBEDTLS_ECP_ALT)
+    if (grp->T == (mbedtls_ecp_point *)ec_p256_comb)
+    {
+        grp->T = NULL;
+        grp->T_size = 0;
+    }
+#else
+    (void)grp;
+#endif
+}
+
+#ifdef CY_BOOT_EC_PRECOMP
+/******************************************************************************
+ * Function Name: ec_precomp_find_key
+ ******************************************************************************
+ * Summary:
+ *  Looks up the signing key of an image by its hash.
+ *
+ * Parameters:
+ *  key_hash - Content of the IMAGE_TLV_KEYHASH TLV of the image.
+ *  len      - Size of the TLV.
+ *
+ * Return:
+ *  Index of the key, or -1 if the key is unknown.
+ *
+ ******************************************************************************/
+int ec_precomp_find_key(const uint8_t *key_hash, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; (len == EC_PRECOMP_KEY_HASH_LEN) && (i < ec_precomp_key_count); i++)
+    {
+        if (memcmp(key_hash, ec_precomp_keys[i].key_hash, EC_PRECOMP_KEY_HASH_LEN) == 0)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+/******************************************************************************
+ * Function Name: ec_precomp_verify
+ ******************************************************************************
+ * Summary:
+ *  Verifies an ECDSA P-256 signature (DER-encoded, as in the
+ *  IMAGE_TLV_ECDSA256 TLV) of an image hash with a precomputed key.
+ *
+ * Parameters:
+ *  key_id   - Index of the key, from ec_precomp_find_key().
+ *  hash     - Image hash.
+ *  hash_len - Size of the hash.
+ *  sig      - Signature.
+ *  sig_len  - Size of the signature.
+ *
+ * Return:
+ *  Status of the verification.
+ *
+ ******************************************************************************/
+cy_rslt_t ec_precomp_verify(uint32_t key_id, const uint8_t *hash, uint32_t hash_len,
+                            const uint8_t *sig, uint32_t sig_len)
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point key;
+    mbedtls_mpi r, s;
+    unsigned char *p = (unsigned char *)sig;
+    const unsigned char *end = sig + sig_len;
+    size_t len;
+    int rc = -1;
+
+    if (key_id >= ec_precomp_key_count)
+    {
+        return EC_PRECOMP_RSLT_ERR_INVALID;
+    }
+
+    /* The key points to the decoded coordinates in flash: never freed. */
+    key.X.s = 1;
+    key.X.n = EC_PRECOMP_LIMBS;
+    key.X.p = (mbedtls_mpi_uint *)ec_precomp_keys[key_id].x;
+    key.Y.s = 1;
+    key.Y.n = EC_PRECOMP_LIMBS;
+    key.Y.p = (mbedtls_mpi_uint *)ec_precomp_keys[key_id].y;
+    key.Z.s = 1;
+    key.Z.n = 1U;
+    key.Z.p = (mbedtls_mpi_uint *)ec_precomp_one;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    /* Signature: SEQUENCE { INTEGER r, INTEGER s }. */
+    if ((mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE) == 0) &&
+        ((p + len) == end) &&
+        (mbedtls_asn1_get_mpi(&p, end, &r) == 0) &&
+        (mbedtls_asn1_get_mpi(&p, end, &s) == 0) &&
+        (mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1) == 0))
+    {
+        ec_precomp_attach(&grp);
+        rc = mbedtls_ecdsa_verify(&grp, hash, hash_len, &key, &r, &s);
+        ec_precomp_detach(&grp);
+    }
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_group_free(&grp);
+
+    return (rc == 0) ? CY_RSLT_SUCCESS : EC_PRECOMP_RSLT_ERR_INVALID;
+}
+
+/******************************************************************************
+ * Function Name: bootutil_verify_sig
+ ******************************************************************************
+ * Summary:
+ *  Signature check of MCUboot, used by boot_go() in place of the one of
+ *  MCUBootApp/image_ec256_mbedtls.c (see app.mk). "key_id" indexes the keys
+ *  of keys.c; the key with the same hash is taken from the precomputed keys,
+ *  so that the DER key is hashed but not parsed.
+ *
+ * Parameters:
+ *  hash    - Image hash.
+ *  hlen    - Size of the hash.
+ *  sig     - DER-encoded signature.
+ *  slen    - Size of the signature.
+ *  key_id  - Index of the key in bootutil_keys[].
+ *
+ * Return:
+ *  0 if the signature is valid.
+ *
+ ******************************************************************************/
+int bootutil_verify_sig(uint8_t *hash, uint32_t hlen, uint8_t *sig, size_t slen, uint8_t key_id)
+{
+    uint8_t key_hash[EC_PRECOMP_KEY_HASH_LEN];
+    int precomp_id = -1;
+
+    if (((int)key_id < bootutil_key_cnt) &&
+        (boot_sha256(bootutil_keys[key_id].key, *bootutil_keys[key_id].len, key_hash) == 0))
+    {
+        precomp_id = ec_precomp_find_key(key_hash, sizeof(key_hash));
+    }
+
+    if ((precomp_id < 0) ||
+        (ec_precomp_verify((uint32_t)precomp_id, hash, hlen, sig, (uint32_t)slen) != CY_RSLT_SUCCESS))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+#endif /* CY_BOOT_EC_PRECOMP */
+
+/* [] END OF FILE */
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * File Name: ec_precomp.h
+ *
+ * Description: This file contains the declarations of the precomputed ECDSA
+ * P-256 data of the bootloader: the decoded image signing keys and the comb
+ * table of the base point.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_EC_PRECOMP_H_
+#define SOURCE_EC_PRECOMP_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+#include "mbedtls/ecp.h"
+
+/* Number of 32-bit limbs of a P-256 coordinate. */
+#define EC_PRECOMP_LIMBS            (8U)
+
+/* Size of the SHA-256 hash of a key (IMAGE_TLV_KEYHASH). */
+#define EC_PRECOMP_KEY_HASH_LEN     (32U)
+
+/* Number of points of the base point comb table (window of 5 bits). */
+#define EC_P256_COMB_SIZE           (16U)
+
+/* Image signing public key, decoded from its DER encoding at build time. */
+typedef struct
+{
+    uint8_t key_hash[EC_PRECOMP_KEY_HASH_LEN];  /* SHA-256 of the DER key. */
+    mbedtls_mpi_uint x[EC_PRECOMP_LIMBS];
+    mbedtls_mpi_uint y[EC_PRECOMP_LIMBS];
+} ec_precomp_key_t;
+
+/* Generated by common/script/ec_precomp.py. */
+extern const ec_precomp_key_t ec_precomp_keys[];
+extern const uint32_t ec_precomp_key_count;
+#if !defined(MBEDTLS_ECP_ALT)
+extern const mbedtls_ecp_point ec_p256_comb[EC_P256_COMB_SIZE];
+#endif
+
+void ec_precomp_attach(mbedtls_ecp_group *grp);
+void ec_precomp_detach(mbedtls_ecp_group *grp);
+int ec_precomp_find_key(const uint8_t *key_hash, uint32_t len);
+cy_rslt_t ec_precomp_verify(uint32_t key_id, const uint8_t *hash, uint32_t hash_len,
+                            const uint8_t *sig, uint32_t sig_len);
+
+#endif /* SOURCE_EC_PRECOMP_H_ */
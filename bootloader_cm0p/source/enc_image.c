@@ -0,0 +1,327 @@
+/******************************************************************************
+ * File Name: enc_image.c
+ *
+ * Description: This file contains the decryption of encrypted images read from
+ * external memory. The AES key of an image is wrapped with ECIES-P256 (ECDH
+ * with the private key of the bootloader, HKDF-SHA256, HMAC-SHA256 tag,
+ * AES-128-CTR), as done by imgtool --encrypt and MCUboot. The payload is
+ * decrypted with AES-128-CTR, in the Crypto block when mbedTLS is built with
+ * MBEDTLS_AES_ALT.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <string.h>
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/image.h"
+#include "bootutil/bootutil_log.h"
+
+/* Local headers. */
+#include "enc_image.h"
+#include "boot_timer.h"
+
+#ifdef CY_BOOT_ENC_IMAGES
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Layout of the IMAGE_TLV_ENC_EC256 TLV: ephemeral public key (uncompressed),
+ * HMAC-SHA256 tag of the wrapped key, wrapped key.
+ */
+#define ENC_IMAGE_PUBK_INDEX        (0U)
+#define ENC_IMAGE_TAG_INDEX         (ENC_IMAGE_PUBK_INDEX + 1U + (2U * BOOT_EC_P256_SIZE))
+#define ENC_IMAGE_CIPHERKEY_INDEX   (ENC_IMAGE_TAG_INDEX + ENC_IMAGE_HMAC_SIZE)
+#define ENC_IMAGE_TLV_SIZE          (ENC_IMAGE_CIPHERKEY_INDEX + BOOT_AES_KEY_SIZE)
+
+#define ENC_IMAGE_HMAC_SIZE         (32U)
+
+/* HKDF output: AES key of the wrapped key, then HMAC key. */
+#define ENC_IMAGE_DERIVED_SIZE      (BOOT_AES_KEY_SIZE + ENC_IMAGE_HMAC_SIZE)
+
+/* HKDF info string of MCUboot. */
+#define ENC_IMAGE_HKDF_INFO         "MCUBoot_ECIES_v1"
+#define ENC_IMAGE_HKDF_INFO_LEN     (sizeof(ENC_IMAGE_HKDF_INFO) - 1U)
+
+/* Error returned when the image has no usable key TLV. */
+#define ENC_IMAGE_RSLT_ERR_TLV      (1UL)
+
+/* Error returned when the key can't be unwrapped. */
+#define ENC_IMAGE_RSLT_ERR_KEY      (2UL)
+
+/* Error returned when the payload can't be decrypted. */
+#define ENC_IMAGE_RSLT_ERR_DECRYPT  (3UL)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static int enc_image_hkdf(const uint8_t *ikm, uint32_t ikm_len, uint8_t *okm);
+static cy_rslt_t enc_image_unwrap(const uint8_t *tlv, uint8_t *key);
+
+/******************************************************************************
+ * Function Name: enc_image_hkdf
+ ******************************************************************************
+ * Summary:
+ *  Derives ENC_IMAGE_DERIVED_SIZE bytes from the ECDH shared secret with
+ *  HKDF-SHA256 (RFC 5869), without salt and with the info string of MCUboot.
+ *
+ ******************************************************************************/
+static int enc_image_hkdf(const uint8_t *ikm, uint32_t ikm_len, uint8_t *okm)
+{
+    uint8_t prk[ENC_IMAGE_HMAC_SIZE];
+    uint8_t msg[ENC_IMAGE_HMAC_SIZE + ENC_IMAGE_HKDF_INFO_LEN + 1U];
+    uint8_t t[ENC_IMAGE_HMAC_SIZE];
+    uint32_t msg_len = 0;
+    uint32_t done = 0;
+    uint32_t n;
+    uint8_t counter = 1U;
+    int rc;
+
+    /* Extract: the missing salt is a block of zeros. */
+    memset(t, 0, sizeof(t));
+    rc = boot_hmac_sha256(t, sizeof(t), ikm, ikm_len, prk);
+
+    /* Expand: T(i) = HMAC(PRK, T(i-1) | info | i). */
+    while ((rc == 0) && (done < ENC_IMAGE_DERIVED_SIZE))
+    {
+        memcpy(&msg[msg_len], ENC_IMAGE_HKDF_INFO, ENC_IMAGE_HKDF_INFO_LEN);
+        msg[msg_len + ENC_IMAGE_HKDF_INFO_LEN] = counter;
+
+        rc = boot_hmac_sha256(prk, sizeof(prk), msg, msg_len + ENC_IMAGE_HKDF_INFO_LEN + 1U, t);
+
+        n = ENC_IMAGE_DERIVED_SIZE - done;
+        n = (n < sizeof(t)) ? n : sizeof(t);
+        memcpy(&okm[done], t, n);
+        done += n;
+
+        memcpy(msg, t, sizeof(t));
+        msg_len = sizeof(t);
+        counter++;
+    }
+
+    memset(prk, 0, sizeof(prk));
+    memset(msg, 0, sizeof(msg));
+    memset(t, 0, sizeof(t));
+
+    return rc;
+}
+
+/******************************************************************************
+ * Function Name: enc_image_unwrap
+ ******************************************************************************
+ * Summary:
+ *  Unwraps the AES key of an image from its IMAGE_TLV_ENC_EC256 TLV and
+ *  checks its tag.
+ *
+ * Parameters:
+ *  tlv - Content of the TLV (ENC_IMAGE_TLV_SIZE bytes).
+ *  key - Set to the AES key of the image.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t enc_image_unwrap(const uint8_t *tlv, uint8_t *key)
+{
+    boot_aes_context aes;
+    uint8_t shared[BOOT_EC_P256_SIZE];
+    uint8_t derived[ENC_IMAGE_DERIVED_SIZE];
+    uint8_t tag[ENC_IMAGE_HMAC_SIZE];
+    uint8_t diff = 0;
+    uint32_t i;
+    int rc;
+
+    rc = boot_ecdh_p256(enc_image_priv_key, &tlv[ENC_IMAGE_PUBK_INDEX], shared);
+
+    if (rc == 0)
+    {
+        rc = enc_image_hkdf(shared, sizeof(shared), derived);
+    }
+
+    if (rc == 0)
+    {
+        rc = boot_hmac_sha256(&derived[BOOT_AES_KEY_SIZE], ENC_IMAGE_HMAC_SIZE,
+                &tlv[ENC_IMAGE_CIPHERKEY_INDEX], BOOT_AES_KEY_SIZE, tag);
+    }
+
+    /* Compare the whole tag, whatever the first mismatch. */
+    for (i = 0; i < ENC_IMAGE_HMAC_SIZE; i++)
+    {
+        diff |= tag[i] ^ tlv[ENC_IMAGE_TAG_INDEX + i];
+    }
+
+    if ((rc == 0) && (diff == 0U))
+    {
+        rc = boot_aes_ctr_set_key(&aes, derived);
+
+        if (rc == 0)
+        {
+            rc = boot_aes_ctr_crypt(&aes, 0, &tlv[ENC_IMAGE_CIPHERKEY_INDEX], key,
+                    BOOT_AES_KEY_SIZE);
+        }
+
+        boot_aes_free(&aes);
+    }
+    else
+    {
+        rc = -1;
+    }
+
+    memset(shared, 0, sizeof(shared));
+    memset(derived, 0, sizeof(derived));
+
+    return (rc == 0) ? CY_RSLT_SUCCESS : ENC_IMAGE_RSLT_ERR_KEY;
+}
+
+/******************************************************************************
+ * Function Name: enc_image_is_encrypted
+ ******************************************************************************
+ * Summary:
+ *  Checks the encrypted flag of an image header.
+ *
+ ******************************************************************************/
+bool enc_image_is_encrypted(const struct image_header *hdr)
+{
+    return (hdr->ih_flags & IMAGE_F_ENCRYPTED) != 0UL;
+}
+
+/******************************************************************************
+ * Function Name: enc_image_init
+ ******************************************************************************
+ * Summary:
+ *  Unwraps the AES key of an encrypted image and prepares its decryption.
+ *
+ * Parameters:
+ *  enc - State of the decryption.
+ *  fap - Flash area holding the image, to read the TLVs from.
+ *  hdr - Header of the image.
+ *  src - Source the encrypted image is copied from.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+cy_rslt_t enc_image_init(enc_image_t *enc, const struct flash_area *fap,
+                         const struct image_header *hdr, const flash_copy_src_t *src)
+{
+    struct image_tlv_iter it;
+    uint8_t tlv[ENC_IMAGE_TLV_SIZE];
+    uint8_t key[BOOT_AES_KEY_SIZE];
+    uint32_t start_us = boot_timer_get_us();
+    uint32_t off;
+    uint16_t len = 0;
+    cy_rslt_t result = ENC_IMAGE_RSLT_ERR_TLV;
+
+    memset(enc, 0, sizeof(*enc));
+    enc->src = *src;
+    enc->payload_off = hdr->ih_hdr_size;
+    enc->payload_end = (uint32_t)hdr->ih_hdr_size + hdr->ih_img_size;
+
+    if ((bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_ENC_EC256, false) == 0) &&
+        (bootutil_tlv_iter_next(&it, &off, &len, NULL) == 0) &&
+        (len == ENC_IMAGE_TLV_SIZE) &&
+        (flash_area_read(fap, off, tlv, len) == 0))
+    {
+        result = enc_image_unwrap(tlv, key);
+    }
+
+    if ((result == CY_RSLT_SUCCESS) && (boot_aes_ctr_set_key(&enc->aes, key) != 0))
+    {
+        result = ENC_IMAGE_RSLT_ERR_KEY;
+    }
+
+    memset(key, 0, sizeof(key));
+
+    if (result != CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_ERR("Failed to unwrap the image encryption key !");
+    }
+
+    enc->unwrap_us = boot_timer_get_us() - start_us;
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: enc_image_read
+ ******************************************************************************
+ * Summary:
+ *  Source read callback of a copy (flash_copy_read_cb_t): reads the image
+ *  from the underlying source and decrypts the bytes of the payload in place,
+ *  with a single AES-CTR operation per call.
+ *
+ ******************************************************************************/
+cy_rslt_t enc_image_read(void *ctx, uint32_t off, void *buf, uint32_t len)
+{
+    enc_image_t *enc = (enc_image_t *)ctx;
+    uint32_t start = (off > enc->payload_off) ? off : enc->payload_off;
+    uint32_t end = ((off + len) < enc->payload_end) ? (off + len) : enc->payload_end;
+    uint32_t start_us;
+    cy_rslt_t result;
+
+    result = enc->src.read(enc->src.ctx, off, buf, len);
+
+    if ((result == CY_RSLT_SUCCESS) && (start < end))
+    {
+        start_us = boot_timer_get_us();
+
+        if (boot_aes_ctr_crypt(&enc->aes, start - enc->payload_off,
+                &((uint8_t *)buf)[start - off], &((uint8_t *)buf)[start - off],
+                end - start) != 0)
+        {
+            result = ENC_IMAGE_RSLT_ERR_DECRYPT;
+        }
+
+        enc->decrypt_us += boot_timer_get_us() - start_us;
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: enc_image_free
+ ******************************************************************************
+ * Summary:
+ *  Clears the key of the image.
+ *
+ ******************************************************************************/
+void enc_image_free(enc_image_t *enc)
+{
+    boot_aes_free(&enc->aes);
+}
+#endif /* CY_BOOT_ENC_IMAGES */
+
+/* [] END OF FILE */
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File Name: enc_image.h
+ *
+ * Description: This file contains declaration of the decryption of encrypted
+ * images (imgtool --encrypt) read from external memory: the key is unwrapped
+ * from the ECIES-P256 TLV of the image, and the payload is decrypted with
+ * AES-128-CTR as it is copied.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_ENC_IMAGE_H_
+#define SOURCE_ENC_IMAGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "bootutil/image.h"
+#include "flash_map_backend/flash_map_backend.h"
+#include "boot_crypto.h"
+#include "flash_copy.h"
+
+/* State of the decryption of an image. Used as the source of a copy
+ * (enc_image_read()): the bytes of the encrypted payload are decrypted as
+ * they are read from "src". The header and the TLVs are not encrypted.
+ */
+typedef struct
+{
+    flash_copy_src_t src;       /* Source of the encrypted image. */
+    boot_aes_context aes;
+    uint32_t payload_off;       /* Offset of the payload (header size). */
+    uint32_t payload_end;       /* End of the payload. */
+    uint32_t unwrap_us;         /* Time taken to unwrap the key. */
+    uint32_t decrypt_us;        /* Time spent decrypting. */
+} enc_image_t;
+
+/* Generated by common/script/enc_key.py. */
+extern const uint8_t enc_image_priv_key[BOOT_EC_P256_SIZE];
+
+bool enc_image_is_encrypted(const struct image_header *hdr);
+cy_rslt_t enc_image_init(enc_image_t *enc, const struct flash_area *fap,
+                         const struct image_header *hdr, const flash_copy_src_t *src);
+cy_rslt_t enc_image_read(void *ctx, uint32_t off, void *buf, uint32_t len);
+void enc_image_free(enc_image_t *enc);
+
+#endif /* SOURCE_ENC_IMAGE_H_ */
@@ -0,0 +1,442 @@
+/******************************************************************************
+ * File Name: flash_copy.c
+ *
+ * Description: This file implements the copy engine used for transferring an
+ * image from the external memory to the internal flash. The destination is
+ * erased one subsector at a time just before it is written, and the image is
+ * read from the external memory and programmed one row at a time.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+#include <stdbool.h>
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/bootutil_log.h"
+
+/* Local headers. */
+#include "flash_copy.h"
+#include "boot_timer.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of 32-bit words in a row. */
+#define FLASH_COPY_ROW_WORDS        (CY_FLASH_SIZEOF_ROW / sizeof(uint32_t))
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Row buffer. Word-aligned as required by the flash driver. */
+static uint32_t copy_buf[FLASH_COPY_ROW_WORDS];
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t flash_copy_wait(void);
+static cy_rslt_t flash_copy_erase(uint32_t addr, uint32_t size);
+static cy_rslt_t flash_copy_program(uint32_t addr, const uint32_t *row);
+#ifdef CY_BOOT_SKIP_UNCHANGED
+static bool flash_copy_row_equal(uint32_t addr, const uint32_t *row);
+#endif
+static bool flash_copy_row_blank(const uint32_t *row, uint32_t erased_word);
+
+/******************************************************************************
+ * Function Name: flash_copy_wait
+ ******************************************************************************
+ * Summary:
+ *  Waits for the ongoing non-blocking flash operation to complete and feeds
+ *  the watchdog. Each flash operation issued by the copy engine is bounded
+ *  to one row program or one subsector erase.
+ *
+ * Return:
+ *  Status of the flash operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t flash_copy_wait(void)
+{
+    cy_en_flashdrv_status_t status;
+
+    do
+    {
+        status = Cy_Flash_IsOperationComplete();
+    } while (status == CY_FLASH_DRV_OPCODE_BUSY);
+
+    MCUBOOT_WATCHDOG_FEED();
+
+    return (status == CY_FLASH_DRV_SUCCESS) ? CY_RSLT_SUCCESS : (cy_rslt_t) status;
+}
+
+/******************************************************************************
+ * Function Name: flash_copy_erase
+ ******************************************************************************
+ * Summary:
+ *  Erases one subsector, or one row, starting at "addr".
+ *
+ * Parameters:
+ *  addr - Address of the first row to be erased. Subsector-aligned when
+ *         "size" is FLASH_COPY_ERASE_SIZE.
+ *  size - FLASH_COPY_ERASE_SIZE or CY_FLASH_SIZEOF_ROW.
+ *
+ * Return:
+ *  Status of the erase operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t flash_copy_erase(uint32_t addr, uint32_t size)
+{
+    cy_en_flashdrv_status_t status;
+
+    if (size == FLASH_COPY_ERASE_SIZE)
+    {
+        status = Cy_Flash_StartEraseSubsector(addr);
+    }
+    else
+    {
+        status = Cy_Flash_StartEraseRow(addr);
+    }
+
+    /* The non-blocking erase returns CY_FLASH_DRV_OPERATION_STARTED once the
+     * operation is accepted; the result is known only when it completes.
+     */
+    return (status == CY_FLASH_DRV_OPERATION_STARTED) ? flash_copy_wait() : (cy_rslt_t) status;
+}
+
+/******************************************************************************
+ * Function Name: flash_copy_program
+ ******************************************************************************
+ * Summary:
+ *  Programs one row of the internal flash, which must be erased.
+ *
+ * Parameters:
+ *  addr - Row-aligned address of the row.
+ *  row  - Word-aligned row buffer.
+ *
+ * Return:
+ *  Status of the program operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t flash_copy_program(uint32_t addr, const uint32_t *row)
+{
+    cy_en_flashdrv_status_t status = Cy_Flash_StartProgram(addr, row);
+
+    return (status == CY_FLASH_DRV_OPERATION_STARTED) ? flash_copy_wait() : (cy_rslt_t) status;
+}
+
+#ifdef CY_BOOT_SKIP_UNCHANGED
+/******************************************************************************
+ * Function Name: flash_copy_row_equal
+ ******************************************************************************
+ * Summary:
+ *  Compares a row of the memory-mapped internal flash with a row buffer, one
+ *  word at a time. Stops at the first difference.
+ *
+ * Parameters:
+ *  addr - Row-aligned address of the row in the internal flash.
+ *  row  - Word-aligned row buffer.
+ *
+ * Return:
+ *  true if the row already holds the content of the buffer.
+ *
+ ******************************************************************************/
+static bool flash_copy_row_equal(uint32_t addr, const uint32_t *row)
+{
+    const volatile uint32_t *flash = (const volatile uint32_t *)addr;
+    uint32_t i;
+
+    for (i = 0; i < FLASH_COPY_ROW_WORDS; i++)
+    {
+        if (flash[i] != row[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
+/******************************************************************************
+ * Function Name: flash_copy_row_blank
+ ******************************************************************************
+ * Summary:
+ *  Blank check of a row buffer: returns whether every word of the row equals
+ *  the erased state of the destination. The row is scanned four words per
+ *  step, with the differences OR-ed together so that there is a single
+ *  branch per 16 bytes; a row holding data usually fails on the first step.
+ *
+ * Parameters:
+ *  row         - Word-aligned row buffer of CY_FLASH_SIZEOF_ROW bytes.
+ *  erased_word - Erased value of the destination, replicated in each byte.
+ *
+ * Return:
+ *  true if the row doesn't need to be programmed after an erase.
+ *
+ ******************************************************************************/
+static bool flash_copy_row_blank(const uint32_t *row, uint32_t erased_word)
+{
+    uint32_t i;
+
+    for (i = 0; i < FLASH_COPY_ROW_WORDS; i += 4UL)
+    {
+        if (((row[i] ^ erased_word) | (row[i + 1UL] ^ erased_word) |
+             (row[i + 2UL] ^ erased_word) | (row[i + 3UL] ^ erased_word)) != 0UL)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/******************************************************************************
+ * Function Name: flash_copy_read_area
+ ******************************************************************************
+ * Summary:
+ *  Source read callback for a plain (uncompressed) image stored in a flash
+ *  area.
+ *
+ * Parameters:
+ *  ctx - Source flash area (const struct flash_area).
+ *  off - Offset within the flash area.
+ *  buf - Output buffer.
+ *  len - Number of bytes to read.
+ *
+ * Return:
+ *  Status of the read operation.
+ *
+ ******************************************************************************/
+cy_rslt_t flash_copy_read_area(void *ctx, uint32_t off, void *buf, uint32_t len)
+{
+    return (cy_rslt_t) flash_area_read((const struct flash_area *)ctx, off, buf, len);
+}
+
+/******************************************************************************
+ * Function Name: flash_copy_to_int
+ ******************************************************************************
+ * Summary:
+ *  Copies "length" bytes produced by "src" to an internal flash area.
+ *  The destination is erased as the copy goes, one subsector just before it
+ *  is written, so that no single blocking step is longer than a subsector
+ *  erase and the watchdog can be fed in between.
+ *
+ *  With CY_BOOT_SKIP_UNCHANGED, each row is first compared with the
+ *  destination, which is memory-mapped. Rows that already hold the source
+ *  data are neither erased nor programmed: a subsector is erased as a whole
+ *  only if its first row differs, and single rows are erased otherwise. The
+ *  row callback still sees every row, so that a fused verification covers
+ *  the whole image.
+ *
+ *  Rows of the image that equal the erased state of the destination (e.g.
+ *  padding) are not programmed once their erase unit has been erased.
+ *
+ *  Each row is read from the source, then programmed. The read is not
+ *  overlapped with the programming of the previous row: the internal flash
+ *  has no read-while-write, and the bootloader runs from the flash macro
+ *  that holds the primary slot, so the CPU stalls until each operation
+ *  completes.
+ *
+ * Parameters:
+ *  src         - Source of the data.
+ *  src_off     - Offset of the first byte to copy within the source.
+ *  fap_dst     - Destination flash area in the internal flash.
+ *  dst_off     - Offset within the destination flash area. Must be row-aligned.
+ *  length      - Number of bytes to copy. Must be a multiple of the row size.
+ *  hooks       - Progress and row callbacks. Can be NULL.
+ *  stats       - Filled with the copy statistics. Can be NULL.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+cy_rslt_t flash_copy_to_int(const flash_copy_src_t *src, uint32_t src_off,
+                            const struct flash_area *fap_dst, uint32_t dst_off,
+                            uint32_t length, const flash_copy_hooks_t *hooks,
+                            flash_copy_stats_t *stats)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t row_addr = fap_dst->fa_off + dst_off;
+    uint32_t end_addr = row_addr + length;
+    uint32_t erased_addr = row_addr;
+    uint32_t unit_end = row_addr;
+    uint32_t unit_size = 0;
+    uint32_t erase_size = 0;
+    uint32_t unchanged = 0;
+    uint32_t blank = 0;
+    uint32_t erased_word = 0x01010101UL * (uint32_t)flash_area_erased_val(fap_dst);
+    uint32_t index = 0;
+    bool skip = false;
+    uint32_t start_us = boot_timer_get_us();
+    flash_copy_progress_cb_t progress_cb = (hooks != NULL) ? hooks->progress_cb : NULL;
+    flash_copy_row_cb_t row_cb = (hooks != NULL) ? hooks->row_cb : NULL;
+
+    CY_ASSERT((length % CY_FLASH_SIZEOF_ROW) == 0);
+    CY_ASSERT((dst_off % CY_FLASH_SIZEOF_ROW) == 0);
+    CY_ASSERT((dst_off + length) <= fap_dst->fa_size);
+
+    while ((result == CY_RSLT_SUCCESS) && (index < length))
+    {
+        /* Start of the next erase unit: a whole subsector if it is aligned
+         * and lies entirely within the destination range, a single row
+         * otherwise.
+         */
+        if (row_addr == unit_end)
+        {
+            if (progress_cb != NULL)
+            {
+                progress_cb(index, length);
+            }
+
+            unit_size = (((row_addr % FLASH_COPY_ERASE_SIZE) == 0) &&
+                         ((end_addr - row_addr) >= FLASH_COPY_ERASE_SIZE)) ?
+                         FLASH_COPY_ERASE_SIZE : CY_FLASH_SIZEOF_ROW;
+            unit_end = row_addr + unit_size;
+        }
+
+        result = src->read(src->ctx, src_off, copy_buf, CY_FLASH_SIZEOF_ROW);
+        if (result != CY_RSLT_SUCCESS)
+        {
+            BOOT_LOG_ERR("failed to read '%s' @ offset 0x%8x", src->name, (int)src_off);
+            break;
+        }
+
+        /* Erase the row, or the whole unit at its first row, just before it
+         * is written.
+         */
+        skip = false;
+
+        if (row_addr >= erased_addr)
+        {
+#ifdef CY_BOOT_SKIP_UNCHANGED
+            skip = flash_copy_row_equal(row_addr, copy_buf);
+#endif
+            if (!skip)
+            {
+                erase_size = ((row_addr + unit_size) == unit_end) ? unit_size : CY_FLASH_SIZEOF_ROW;
+
+                result = flash_copy_erase(row_addr, erase_size);
+                if (result != CY_RSLT_SUCCESS)
+                {
+                    BOOT_LOG_ERR("failed to erase flash area %d @ offset 0x%8x",
+                            (int)fap_dst->fa_id, (int)(row_addr - fap_dst->fa_off));
+                    break;
+                }
+
+                erased_addr = row_addr + erase_size;
+            }
+        }
+
+        if (skip)
+        {
+            unchanged += CY_FLASH_SIZEOF_ROW;
+        }
+        else if (flash_copy_row_blank(copy_buf, erased_word))
+        {
+            /* The row is erased at this point: a blank row is left as is. */
+            blank += CY_FLASH_SIZEOF_ROW;
+        }
+        else
+        {
+            result = flash_copy_program(row_addr, copy_buf);
+            if (result != CY_RSLT_SUCCESS)
+            {
+                BOOT_LOG_ERR("failed to write flash area %d @ offset 0x%8x",
+                        (int)fap_dst->fa_id, (int)(row_addr - fap_dst->fa_off));
+                break;
+            }
+        }
+
+        /* Unchanged and blank rows don't go through flash_copy_wait(). */
+        MCUBOOT_WATCHDOG_FEED();
+
+        if (row_cb != NULL)
+        {
+            row_cb(hooks->row_ctx, src_off, (const uint8_t *)copy_buf, CY_FLASH_SIZEOF_ROW);
+        }
+
+        src_off += CY_FLASH_SIZEOF_ROW;
+        row_addr += CY_FLASH_SIZEOF_ROW;
+        index += CY_FLASH_SIZEOF_ROW;
+    }
+
+    if ((result == CY_RSLT_SUCCESS) && (progress_cb != NULL))
+    {
+        progress_cb(index, length);
+    }
+
+    if (stats != NULL)
+    {
+        stats->bytes_copied = index;
+        stats->bytes_unchanged = unchanged;
+        stats->bytes_blank = blank;
+        stats->elapsed_us = boot_timer_get_us() - start_us;
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: flash_copy_print_stats
+ ******************************************************************************
+ * Summary:
+ *  Prints the size, duration and the throughput of a copy operation.
+ *
+ * Parameters:
+ *  stats - Statistics returned by the copy engine.
+ *
+ ******************************************************************************/
+void flash_copy_print_stats(const flash_copy_stats_t *stats)
+{
+    /* Throughput in units of 0.001 MB/s (1 MB = 10^6 bytes). */
+    uint32_t kbps = 0;
+
+    if (stats->elapsed_us != 0)
+    {
+        kbps = (uint32_t)(((uint64_t)stats->bytes_copied * 1000ULL) / stats->elapsed_us);
+    }
+
+    BOOT_LOG_INF("Copied %u bytes in %u ms (%u.%03u MB/s)",
+            (unsigned int)stats->bytes_copied,
+            (unsigned int)(stats->elapsed_us / 1000UL),
+            (unsigned int)(kbps / 1000UL), (unsigned int)(kbps % 1000UL));
+
+    BOOT_LOG_INF("Rows programmed %u, blank %u, unchanged %u",
+            (unsigned int)((stats->bytes_copied - stats->bytes_blank - stats->bytes_unchanged) /
+                           CY_FLASH_SIZEOF_ROW),
+            (unsigned int)(stats->bytes_blank / CY_FLASH_SIZEOF_ROW),
+            (unsigned int)(stats->bytes_unchanged / CY_FLASH_SIZEOF_ROW));
+}
+
+/* [] END OF FILE */
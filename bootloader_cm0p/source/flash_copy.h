@@ -0,0 +1,99 @@
+/******************************************************************************
+ * File Name: flash_copy.h
+ *
+ * Description: This file contains declaration of the copy engine used for
+ * transferring an image from the external memory to the internal flash.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_FLASH_COPY_H_
+#define SOURCE_FLASH_COPY_H_
+
+#include <stdint.h>
+#include "cy_pdl.h"
+#include "cy_result.h"
+#include "flash_map_backend/flash_map_backend.h"
+
+/* Granularity of the erase operations performed by the copy engine: one
+ * subsector (8 rows) of the internal flash.
+ */
+#define FLASH_COPY_ERASE_SIZE       (8UL * CY_FLASH_SIZEOF_ROW)
+
+/* Progress callback. Invoked before each erase unit of the destination is
+ * erased, i.e. all bytes below "bytes_done" have been programmed.
+ */
+typedef void (*flash_copy_progress_cb_t)(uint32_t bytes_done, uint32_t bytes_total);
+
+/* Row callback. Invoked with the content of each row while it is being
+ * programmed, e.g. to hash the data as it streams through. "off" is the
+ * offset of the row within the source.
+ */
+typedef void (*flash_copy_row_cb_t)(void *ctx, uint32_t off, const uint8_t *row, uint32_t len);
+
+/* Optional hooks of a copy operation. Unused hooks are set to NULL. */
+typedef struct
+{
+    flash_copy_progress_cb_t progress_cb;
+    flash_copy_row_cb_t row_cb;
+    void *row_ctx;
+} flash_copy_hooks_t;
+
+/* Source read callback: reads "len" bytes at offset "off" of the source
+ * image into "buf". Offsets are requested in increasing order.
+ */
+typedef cy_rslt_t (*flash_copy_read_cb_t)(void *ctx, uint32_t off, void *buf, uint32_t len);
+
+/* Source of a copy operation. "name" is used in the log messages. */
+typedef struct
+{
+    flash_copy_read_cb_t read;
+    void *ctx;
+    const char *name;
+} flash_copy_src_t;
+
+/* Statistics collected during a copy operation. */
+typedef struct
+{
+    uint32_t bytes_copied;      /* Number of bytes transferred. */
+    uint32_t bytes_unchanged;   /* Rows already present in the destination. */
+    uint32_t bytes_blank;       /* Rows equal to the erased state, not programmed. */
+    uint32_t elapsed_us;        /* Wall-clock duration of the copy. */
+} flash_copy_stats_t;
+
+cy_rslt_t flash_copy_read_area(void *ctx, uint32_t off, void *buf, uint32_t len);
+cy_rslt_t flash_copy_to_int(const flash_copy_src_t *src, uint32_t src_off,
+                            const struct flash_area *fap_dst, uint32_t dst_off,
+                            uint32_t length, const flash_copy_hooks_t *hooks,
+                            flash_copy_stats_t *stats);
+void flash_copy_print_stats(const flash_copy_stats_t *stats);
+
+#endif /* SOURCE_FLASH_COPY_H_ */
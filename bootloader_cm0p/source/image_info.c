@@ -0,0 +1,159 @@
+/******************************************************************************
+ * File Name: image_info.c
+ *
+ * Description: This file implements the helper functions used for parsing the
+ * MCUboot image header and TLV area of an image stored in a flash area.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+#include <stdbool.h>
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "bootutil/bootutil_log.h"
+
+/* Local headers. */
+#include "image_info.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Generic error returned when the image is not a valid MCUboot image. */
+#define IMAGE_INFO_RSLT_ERR_INVALID     (1UL)
+
+/******************************************************************************
+ * Function Name: image_info_add
+ ******************************************************************************
+ * Summary:
+ *  Adds "b" to "*a", as boot_u32_safe_add() of MCUboot does.
+ *
+ * Parameters:
+ *  a - Accumulated offset, updated with the sum.
+ *  b - Value to add.
+ *
+ * Return:
+ *  false if the sum overflows a uint32_t; "*a" is left untouched then.
+ *
+ ******************************************************************************/
+static bool image_info_add(uint32_t *a, uint32_t b)
+{
+    if (b > (UINT32_MAX - *a))
+    {
+        return false;
+    }
+
+    *a += b;
+    return true;
+}
+
+/******************************************************************************
+ * Function Name: image_info_read
+ ******************************************************************************
+ * Summary:
+ *  Reads the MCUboot image header at the beginning of a flash area and walks
+ *  the (protected and unprotected) TLV areas to compute the true extent of
+ *  the image: header + payload + TLVs.
+ *
+ * Parameters:
+ *  fap    - Flash area holding the image.
+ *  hdr    - Filled with the image header.
+ *  extent - Filled with the number of bytes occupied by the image.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+cy_rslt_t image_info_read(const struct flash_area *fap, struct image_header *hdr,
+                          uint32_t *extent)
+{
+    cy_rslt_t result;
+    struct image_tlv_info info;
+    uint32_t off = 0;
+
+    result = flash_area_read(fap, 0, hdr, sizeof(*hdr));
+
+    if (result != CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_ERR("Failed to read image header");
+    }
+    else if (hdr->ih_magic != IMAGE_MAGIC)
+    {
+        BOOT_LOG_ERR("Invalid image magic 0x%08x !", (int)hdr->ih_magic);
+        result = IMAGE_INFO_RSLT_ERR_INVALID;
+    }
+    /* The protected TLV area, if any, immediately follows the payload. The
+     * sizes come from the unverified header: reject a sum that wraps around.
+     */
+    else if (!image_info_add(&off, hdr->ih_hdr_size) ||
+             !image_info_add(&off, hdr->ih_img_size) ||
+             !image_info_add(&off, hdr->ih_protect_tlv_size) ||
+             (off > (fap->fa_size - sizeof(info))))
+    {
+        BOOT_LOG_ERR("Invalid image size in header !");
+        result = IMAGE_INFO_RSLT_ERR_INVALID;
+    }
+    else
+    {
+        /* The unprotected TLV area follows the protected one. */
+        result = flash_area_read(fap, off, &info, sizeof(info));
+
+        if (result != CY_RSLT_SUCCESS)
+        {
+            BOOT_LOG_ERR("Failed to read image TLV info");
+        }
+        else if (info.it_magic != IMAGE_TLV_INFO_MAGIC)
+        {
+            BOOT_LOG_ERR("Invalid TLV info magic 0x%04x !", (int)info.it_magic);
+            result = IMAGE_INFO_RSLT_ERR_INVALID;
+        }
+        else
+        {
+            /* "it_tlv_tot" includes the size of the TLV info header. */
+            if (!image_info_add(&off, info.it_tlv_tot) || (off > fap->fa_size))
+            {
+                BOOT_LOG_ERR("Image size 0x%08x exceeds the area !", (int)off);
+                result = IMAGE_INFO_RSLT_ERR_INVALID;
+            }
+            else
+            {
+                *extent = off;
+            }
+        }
+    }
+
+    return result;
+}
+
+/* [] END OF FILE */
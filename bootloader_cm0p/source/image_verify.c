@@ -0,0 +1,342 @@
+/******************************************************************************
+ * File Name: image_verify.c
+ *
+ * Description: This file implements a fused verification of the factory app.
+ * The image is hashed as it streams through the copy engine, the digest is
+ * checked against the TLVs of the copied image, and the primary slot is read
+ * back with a CRC only, so that MCUboot doesn't have to hash the whole slot
+ * again.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/bootutil_log.h"
+#include "bootutil/sign_key.h"
+#include "bootutil_priv.h"
+
+/* Local headers. */
+#include "image_verify.h"
+#include "crc32.h"
+#ifdef CY_BOOT_EC_PRECOMP
+#include "ec_precomp.h"
+#endif
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Error returned when the copied image fails verification. */
+#define IMAGE_VERIFY_RSLT_ERR_INVALID   (1UL)
+
+/* Size of the buffer used for reading signature TLVs. */
+#define IMAGE_VERIFY_SIG_BUF_SIZE       (128U)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t image_verify_tlvs(image_verify_t *ctx, const struct flash_area *fap,
+                                   const uint8_t *hash);
+
+/******************************************************************************
+ * Function Name: image_verify_tlvs
+ ******************************************************************************
+ * Summary:
+ *  Checks the computed digest against the SHA256 TLV of the image and, when
+ *  image signing is enabled, the signature against the bootloader keys.
+ *
+ ******************************************************************************/
+static cy_rslt_t image_verify_tlvs(image_verify_t *ctx, const struct flash_area *fap,
+                                   const uint8_t *hash)
+{
+    struct image_tlv_iter it;
+    uint8_t buf[IMAGE_VERIFY_SIG_BUF_SIZE];
+    uint32_t off;
+    uint16_t len;
+    uint16_t type;
+    bool hash_ok = false;
+    int rc;
+#ifdef MCUBOOT_SIGN_EC256
+#ifndef CY_BOOT_EC_PRECOMP
+    uint8_t key_hash[IMAGE_HASH_LEN];
+    int i;
+#endif
+    int key_id = -1;
+    bool sig_ok = false;
+#endif
+
+    rc = bootutil_tlv_iter_begin(&it, &ctx->hdr, fap, IMAGE_TLV_ANY, false);
+
+    while (rc == 0)
+    {
+        rc = bootutil_tlv_iter_next(&it, &off, &len, &type);
+
+        if ((rc != 0) || (len > sizeof(buf)))
+        {
+            continue;
+        }
+
+        if (type == IMAGE_TLV_SHA256)
+        {
+            rc = flash_area_read(fap, off, buf, len);
+            hash_ok = (rc == 0) && (len == IMAGE_HASH_LEN) &&
+                      (memcmp(buf, hash, IMAGE_HASH_LEN) == 0);
+        }
+#ifdef MCUBOOT_SIGN_EC256
+        else if (type == IMAGE_TLV_KEYHASH)
+        {
+            /* Find the bootloader key the image was signed with. */
+            rc = flash_area_read(fap, off, buf, len);
+
+#ifdef CY_BOOT_EC_PRECOMP
+            /* The key hashes are computed at build time. */
+            key_id = (rc == 0) ? ec_precomp_find_key(buf, len) : -1;
+#else
+            for (i = 0; (rc == 0) && (len == IMAGE_HASH_LEN) && (i < bootutil_key_cnt); i++)
+            {
+                (void)boot_sha256(bootutil_keys[i].key, *bootutil_keys[i].len, key_hash);
+
+                if (memcmp(buf, key_hash, IMAGE_HASH_LEN) == 0)
+                {
+                    key_id = i;
+                    break;
+                }
+            }
+#endif
+        }
+        else if ((type == IMAGE_TLV_ECDSA256) && hash_ok && (key_id >= 0))
+        {
+            rc = flash_area_read(fap, off, buf, len);
+#ifdef CY_BOOT_EC_PRECOMP
+            sig_ok = (rc == 0) &&
+                     (ec_precomp_verify((uint32_t)key_id, hash, IMAGE_HASH_LEN, buf, len) ==
+                      CY_RSLT_SUCCESS);
+#else
+            sig_ok = (rc == 0) &&
+                     (bootutil_verify_sig((uint8_t *)hash, IMAGE_HASH_LEN, buf, len,
+                                          (uint8_t)key_id) == 0);
+#endif
+        }
+#endif
+        else
+        {
+            /* Other TLVs are not needed. */
+        }
+    }
+
+    if (!hash_ok)
+    {
+        BOOT_LOG_ERR("Image hash doesn't match !");
+        return IMAGE_VERIFY_RSLT_ERR_INVALID;
+    }
+
+#ifdef MCUBOOT_SIGN_EC256
+    if (!sig_ok)
+    {
+        BOOT_LOG_ERR("Image signature is invalid !");
+        return IMAGE_VERIFY_RSLT_ERR_INVALID;
+    }
+#endif
+
+    return CY_RSLT_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: image_verify_start
+ ******************************************************************************
+ * Summary:
+ *  Prepares a streamed verification. The rows must then be passed to
+ *  image_verify_row() in order, starting at offset 0.
+ *
+ * Parameters:
+ *  ctx - Verification state.
+ *
+ ******************************************************************************/
+void image_verify_start(image_verify_t *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->valid = (boot_sha256_start(&ctx->sha) == 0);
+}
+
+/******************************************************************************
+ * Function Name: image_verify_row
+ ******************************************************************************
+ * Summary:
+ *  Row callback of the copy engine. Hashes the part of the row covered by
+ *  the image hash and updates the CRC of the data written.
+ *
+ * Parameters:
+ *  ctx - Verification state (image_verify_t).
+ *  off - Offset of the row within the image.
+ *  row - Row content.
+ *  len - Row size.
+ *
+ ******************************************************************************/
+void image_verify_row(void *ctx, uint32_t off, const uint8_t *row, uint32_t len)
+{
+    image_verify_t *verify = (image_verify_t *)ctx;
+    uint32_t hash_len;
+
+    if (!verify->valid || (off != verify->next_off))
+    {
+        verify->valid = false;
+        return;
+    }
+
+    /* The image header is at the start of the first row. */
+    if (off == 0)
+    {
+        memcpy(&verify->hdr, row, sizeof(verify->hdr));
+        verify->hash_len = (uint32_t)verify->hdr.ih_hdr_size + verify->hdr.ih_img_size +
+                           verify->hdr.ih_protect_tlv_size;
+        verify->valid = (verify->hdr.ih_magic == IMAGE_MAGIC);
+    }
+
+    if (verify->valid && (off < verify->hash_len))
+    {
+        hash_len = verify->hash_len - off;
+        hash_len = (hash_len > len) ? len : hash_len;
+        verify->valid = (boot_sha256_update(&verify->sha, row, hash_len) == 0);
+    }
+
+    verify->crc = crc32_update(verify->crc, row, len);
+    verify->next_off = off + len;
+}
+
+/******************************************************************************
+ * Function Name: image_verify_check
+ ******************************************************************************
+ * Summary:
+ *  Completes the hash of a streamed verification and checks the digest and
+ *  the signature against the TLVs of the image.
+ *
+ * Parameters:
+ *  ctx    - Verification state.
+ *  fap    - Flash area holding the image, used for reading the TLVs.
+ *  length - Number of bytes streamed, starting at offset 0 of "fap".
+ *
+ * Return:
+ *  Status of the verification.
+ *
+ ******************************************************************************/
+cy_rslt_t image_verify_check(image_verify_t *ctx, const struct flash_area *fap,
+                             uint32_t length)
+{
+    cy_rslt_t result = IMAGE_VERIFY_RSLT_ERR_INVALID;
+    uint8_t hash[IMAGE_HASH_LEN];
+
+    if (!ctx->valid || (ctx->next_off != length) || (ctx->hash_len > length))
+    {
+        BOOT_LOG_ERR("Image was not streamed completely !");
+    }
+    else if (boot_sha256_finish(&ctx->sha, hash) == 0)
+    {
+        result = image_verify_tlvs(ctx, fap, hash);
+    }
+    else
+    {
+        /* Nothing else to verify. */
+    }
+
+    boot_sha256_free(&ctx->sha);
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: image_verify_mapped
+ ******************************************************************************
+ * Summary:
+ *  Verifies the hash and the signature of an image in internal flash,
+ *  reading it through the memory map in chunks of CY_BOOT_HASH_CHUNK_SIZE.
+ *  The CRC of the image is computed in the same pass.
+ *
+ * Parameters:
+ *  ctx    - Verification state.
+ *  fap    - Flash area holding the image.
+ *  length - Header + image + TLVs.
+ *
+ * Return:
+ *  Status of the verification.
+ *
+ ******************************************************************************/
+cy_rslt_t image_verify_mapped(image_verify_t *ctx, const struct flash_area *fap,
+                              uint32_t length)
+{
+    uint32_t off;
+    uint32_t len;
+
+    image_verify_start(ctx);
+
+    for (off = 0; off < length; off += len)
+    {
+        len = ((length - off) > CY_BOOT_HASH_CHUNK_SIZE) ? CY_BOOT_HASH_CHUNK_SIZE : (length - off);
+        image_verify_row(ctx, off, (const uint8_t *)(fap->fa_off + off), len);
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    return image_verify_check(ctx, fap, length);
+}
+
+/******************************************************************************
+ * Function Name: image_verify_readback
+ ******************************************************************************
+ * Summary:
+ *  Reads back the streamed rows through the memory map and compares their
+ *  CRC with the CRC of the data streamed.
+ *
+ * Parameters:
+ *  ctx    - Verification state.
+ *  addr   - Memory-mapped address of offset 0 of the image.
+ *  length - Number of bytes streamed.
+ *
+ * Return:
+ *  Status of the verification.
+ *
+ ******************************************************************************/
+cy_rslt_t image_verify_readback(const image_verify_t *ctx, uint32_t addr, uint32_t length)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (crc32_update(0, (const void *)(uintptr_t)addr, length) != ctx->crc)
+    {
+        BOOT_LOG_ERR("Read-back CRC @ 0x%08x doesn't match !", (int)addr);
+        result = IMAGE_VERIFY_RSLT_ERR_INVALID;
+    }
+
+    return result;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File Name: image_verify.h
+ *
+ * Description: This file contains declaration of the functions used for
+ * verifying the factory app while it is copied to the primary slot.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_IMAGE_VERIFY_H_
+#define SOURCE_IMAGE_VERIFY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "bootutil/image.h"
+#include "flash_map_backend/flash_map_backend.h"
+#include "boot_crypto.h"
+
+/* Size of the chunks handed to the hash engine when an image is read through
+ * the memory map. Tune it with the crypto self-test (EN_CRYPTO_BENCH=1).
+ */
+#ifndef CY_BOOT_HASH_CHUNK_SIZE
+#define CY_BOOT_HASH_CHUNK_SIZE     (4096UL)
+#endif
+
+/* State of a streamed verification. */
+typedef struct
+{
+    boot_sha256_context sha;
+    struct image_header hdr;    /* Taken from the first row. */
+    uint32_t hash_len;          /* Header + payload + protected TLVs. */
+    uint32_t next_off;          /* Offset of the next expected row. */
+    uint32_t crc;               /* CRC-32 of the rows handed to the engine. */
+    bool valid;
+} image_verify_t;
+
+void image_verify_start(image_verify_t *ctx);
+void image_verify_row(void *ctx, uint32_t off, const uint8_t *row, uint32_t len);
+cy_rslt_t image_verify_check(image_verify_t *ctx, const struct flash_area *fap,
+                             uint32_t length);
+cy_rslt_t image_verify_mapped(image_verify_t *ctx, const struct flash_area *fap,
+                              uint32_t length);
+cy_rslt_t image_verify_readback(const image_verify_t *ctx, uint32_t addr, uint32_t length);
+
+#endif /* SOURCE_IMAGE_VERIFY_H_ */
@@ -0,0 +1,481 @@
+/******************************************************************************
+ * File Name: lkg_slot.c
+ *
+ * Description: This file contains the last-known-good slot. Before an
+ * upgrade replaces the image in primary slot, the image is verified and
+ * copied to an area of the external memory. A rollback restores it before
+ * falling back to the factory app.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/* Standard headers. */
+#include <string.h>
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/image.h"
+#include "bootutil/bootutil.h"
+#include "bootutil/bootutil_log.h"
+#include "bootutil_priv.h"
+
+/*  Flash access headers. */
+#include "flash_map_backend/flash_map_backend.h"
+#include "sysflash.h"
+#include "ext_flash_map.h"
+
+/* Local headers. */
+#include "lkg_slot.h"
+#include "boot_timer.h"
+#include "image_info.h"
+#include "image_verify.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Error returned when primary slot or the copy doesn't hold a valid image. */
+#define LKG_SLOT_RSLT_ERR_INVALID       (1UL)
+
+/* Error returned when the image in primary slot is not confirmed. */
+#define LKG_SLOT_RSLT_ERR_UNCONFIRMED   (2UL)
+
+/* Round a size up to a multiple of the external memory erase size. */
+#define ERASE_ALIGN_UP(x)               (((x) + CY_EXT_FLASH_ERASE_SIZE - 1UL) & \
+                                         ~(CY_EXT_FLASH_ERASE_SIZE - 1UL))
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+static image_verify_t lkg_verify;
+static uint8_t lkg_buf[CY_FLASH_SIZEOF_ROW];
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t lkg_slot_open(const struct flash_area **fap_primary,
+                               const struct flash_area **fap_lkg);
+static void lkg_slot_close(const struct flash_area *fap_primary,
+                           const struct flash_area *fap_lkg);
+static bool lkg_slot_get_length(const struct flash_area *fap, uint32_t max_length,
+                                uint32_t *length);
+static bool lkg_slot_compare(const struct flash_area *fap_primary,
+                             const struct flash_area *fap_lkg, uint32_t length);
+static bool lkg_slot_is_confirmed(void);
+static cy_rslt_t lkg_slot_erase(const struct flash_area *fap_lkg, uint32_t length);
+
+/******************************************************************************
+ * Function Name: lkg_slot_open
+ ******************************************************************************
+ * Summary:
+ *  Opens primary slot of image 0 and the last-known-good slot.
+ *
+ * Parameters:
+ *  fap_primary - Filled with primary slot.
+ *  fap_lkg     - Filled with the last-known-good slot.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t lkg_slot_open(const struct flash_area **fap_primary,
+                               const struct flash_area **fap_lkg)
+{
+    cy_rslt_t result;
+
+    *fap_primary = NULL;
+    *fap_lkg = NULL;
+
+    result = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), fap_primary);
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = flash_area_open(FLASH_AREA_LKG_SLOT, fap_lkg);
+    }
+
+    if (result != CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_ERR("Failed to open last-known-good slot !");
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_close
+ ******************************************************************************
+ * Summary:
+ *  Closes the flash areas opened by lkg_slot_open().
+ *
+ * Parameters:
+ *  fap_primary - Primary slot, or NULL.
+ *  fap_lkg     - Last-known-good slot, or NULL.
+ *
+ ******************************************************************************/
+static void lkg_slot_close(const struct flash_area *fap_primary,
+                           const struct flash_area *fap_lkg)
+{
+    if (fap_lkg != NULL)
+    {
+        flash_area_close(fap_lkg);
+    }
+
+    if (fap_primary != NULL)
+    {
+        flash_area_close(fap_primary);
+    }
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_get_length
+ ******************************************************************************
+ * Summary:
+ *  Parses the header and the TLV area of the image held by a flash area.
+ *
+ * Parameters:
+ *  fap        - Flash area holding the image.
+ *  max_length - Largest image accepted.
+ *  length     - Filled with the size of the image (header + payload + TLVs).
+ *
+ * Return:
+ *  true if an image of at most "max_length" bytes was found.
+ *
+ ******************************************************************************/
+static bool lkg_slot_get_length(const struct flash_area *fap, uint32_t max_length,
+                                uint32_t *length)
+{
+    struct image_header hdr;
+
+    *length = 0;
+
+    return (image_info_read(fap, &hdr, length) == CY_RSLT_SUCCESS) &&
+           (*length <= max_length) && (*length <= fap->fa_size);
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_compare
+ ******************************************************************************
+ * Summary:
+ *  Compares the last-known-good slot with the image in primary slot, read
+ *  through the memory map.
+ *
+ * Parameters:
+ *  fap_primary - Primary slot.
+ *  fap_lkg     - Last-known-good slot.
+ *  length      - Number of bytes to be compared.
+ *
+ * Return:
+ *  true if both hold the same bytes.
+ *
+ ******************************************************************************/
+static bool lkg_slot_compare(const struct flash_area *fap_primary,
+                             const struct flash_area *fap_lkg, uint32_t length)
+{
+    bool same = true;
+    uint32_t off;
+    uint32_t len;
+
+    for (off = 0; same && (off < length); off += len)
+    {
+        len = ((length - off) > sizeof(lkg_buf)) ? sizeof(lkg_buf) : (length - off);
+
+        same = (flash_area_read(fap_lkg, off, lkg_buf, len) == CY_RSLT_SUCCESS) &&
+               (memcmp(lkg_buf, (const void *)(fap_primary->fa_off + off), len) == 0);
+    }
+
+    return same;
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_is_confirmed
+ ******************************************************************************
+ * Summary:
+ *  Checks that the image in primary slot was confirmed: the "image ok" flag
+ *  of its trailer is set by boot_set_confirmed() (the application confirmed
+ *  an image installed by a test upgrade, see trial_boot.c) or, with
+ *  swap-using-move, by MCUboot after a permanent upgrade. An image whose
+ *  trailer is erased, e.g. installed by an overwrite-only upgrade and never
+ *  put on trial, is not confirmed.
+ *
+ * Return:
+ *  true if the image in primary slot is confirmed.
+ *
+ ******************************************************************************/
+static bool lkg_slot_is_confirmed(void)
+{
+    struct boot_swap_state state;
+
+    return (boot_read_swap_state_by_id(FLASH_AREA_IMAGE_PRIMARY(0), &state) == 0) &&
+           (state.image_ok == BOOT_FLAG_SET);
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_erase
+ ******************************************************************************
+ * Summary:
+ *  Erases the start of the last-known-good slot one sector of the external
+ *  memory at a time, feeding the watchdog between sectors.
+ *
+ * Parameters:
+ *  fap_lkg - Last-known-good slot.
+ *  length  - Number of bytes to be erased, rounded up to the erase size.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t lkg_slot_erase(const struct flash_area *fap_lkg, uint32_t length)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t end = ERASE_ALIGN_UP(length);
+    uint32_t off;
+
+    for (off = 0; (result == CY_RSLT_SUCCESS) && (off < end); off += CY_EXT_FLASH_ERASE_SIZE)
+    {
+        result = flash_area_erase(fap_lkg, off, CY_EXT_FLASH_ERASE_SIZE);
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_save
+ ******************************************************************************
+ * Summary:
+ *  Copies the image in primary slot to the last-known-good slot, before an
+ *  upgrade replaces it. Only a confirmed image is kept, and it is verified
+ *  first, so that an image still on trial or not valid is never restored. The first chunk, holding the image header, is written last
+ *  and the copy is compared with primary slot: a copy interrupted by a reset
+ *  or a power failure has no valid header and is not used.
+ *
+ * Return:
+ *  Status of the operation. CY_RSLT_SUCCESS if the slot already holds the
+ *  image.
+ *
+ ******************************************************************************/
+cy_rslt_t lkg_slot_save(void)
+{
+    cy_rslt_t result;
+    const struct flash_area *fap_primary;
+    const struct flash_area *fap_lkg;
+    uint32_t start_us = boot_timer_get_us();
+    uint32_t length = 0;
+    uint32_t lkg_length = 0;
+    uint32_t off;
+    uint32_t len;
+    bool save = false;
+
+    result = lkg_slot_open(&fap_primary, &fap_lkg);
+
+    if ((result == CY_RSLT_SUCCESS) &&
+        !lkg_slot_get_length(fap_primary, fap_lkg->fa_size, &length))
+    {
+        BOOT_LOG_INF("No image to keep as last-known-good");
+        result = LKG_SLOT_RSLT_ERR_INVALID;
+    }
+    else if ((result == CY_RSLT_SUCCESS) && !lkg_slot_is_confirmed())
+    {
+        BOOT_LOG_INF("Image in primary slot is not confirmed, not kept as last-known-good");
+        result = LKG_SLOT_RSLT_ERR_UNCONFIRMED;
+    }
+    else if ((result == CY_RSLT_SUCCESS) &&
+             lkg_slot_get_length(fap_lkg, fap_lkg->fa_size, &lkg_length) &&
+             (lkg_length == length) && lkg_slot_compare(fap_primary, fap_lkg, length))
+    {
+        BOOT_LOG_INF("Last-known-good slot is up to date");
+    }
+    else if ((result == CY_RSLT_SUCCESS) &&
+             (image_verify_mapped(&lkg_verify, fap_primary, length) != CY_RSLT_SUCCESS))
+    {
+        BOOT_LOG_INF("Image in primary slot is not valid, not kept as last-known-good");
+        result = LKG_SLOT_RSLT_ERR_INVALID;
+    }
+    else if (result == CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_INF("Saving primary slot as last-known-good (%u bytes)",
+                (unsigned int)length);
+        result = lkg_slot_erase(fap_lkg, length);
+        save = true;
+    }
+    else
+    {
+        /* Failed to open the flash areas. */
+    }
+
+    /* Everything but the first chunk, then the first chunk. */
+    for (off = LKG_SLOT_WRITE_SIZE; save && (result == CY_RSLT_SUCCESS) && (off < length);
+         off += len)
+    {
+        len = ((length - off) > LKG_SLOT_WRITE_SIZE) ? LKG_SLOT_WRITE_SIZE : (length - off);
+        result = flash_area_write(fap_lkg, off, (const void *)(fap_primary->fa_off + off), len);
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    if (save && (result == CY_RSLT_SUCCESS))
+    {
+        len = (length > LKG_SLOT_WRITE_SIZE) ? LKG_SLOT_WRITE_SIZE : length;
+        result = flash_area_write(fap_lkg, 0, (const void *)fap_primary->fa_off, len);
+    }
+
+    if (save && (result == CY_RSLT_SUCCESS) && !lkg_slot_compare(fap_primary, fap_lkg, length))
+    {
+        BOOT_LOG_ERR("Last-known-good copy doesn't match primary slot !");
+        result = LKG_SLOT_RSLT_ERR_INVALID;
+        (void)flash_area_erase(fap_lkg, 0, CY_EXT_FLASH_ERASE_SIZE);
+    }
+
+    if (save && (result == CY_RSLT_SUCCESS))
+    {
+        BOOT_LOG_INF("Last-known-good slot saved in %u ms",
+                (unsigned int)((boot_timer_get_us() - start_us) / 1000UL));
+    }
+
+    lkg_slot_close(fap_primary, fap_lkg);
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_is_valid
+ ******************************************************************************
+ * Summary:
+ *  Checks whether the last-known-good slot holds an image that fits primary
+ *  slot. The image itself is validated by MCUboot once it is restored.
+ *
+ * Return:
+ *  true if the slot can be restored.
+ *
+ ******************************************************************************/
+bool lkg_slot_is_valid(void)
+{
+    const struct flash_area *fap_primary;
+    const struct flash_area *fap_lkg;
+    uint32_t length = 0;
+    bool valid = false;
+
+    if (lkg_slot_open(&fap_primary, &fap_lkg) == CY_RSLT_SUCCESS)
+    {
+        valid = lkg_slot_get_length(fap_lkg, fap_primary->fa_size, &length);
+    }
+
+    lkg_slot_close(fap_primary, fap_lkg);
+
+    return valid;
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_is_current
+ ******************************************************************************
+ * Summary:
+ *  Checks whether primary slot already holds the last-known-good image, in
+ *  which case restoring it doesn't change anything.
+ *
+ * Return:
+ *  true if primary slot holds the last-known-good image.
+ *
+ ******************************************************************************/
+bool lkg_slot_is_current(void)
+{
+    const struct flash_area *fap_primary;
+    const struct flash_area *fap_lkg;
+    uint32_t length = 0;
+    uint32_t lkg_length = 0;
+    bool current = false;
+
+    if (lkg_slot_open(&fap_primary, &fap_lkg) == CY_RSLT_SUCCESS)
+    {
+        current = lkg_slot_get_length(fap_primary, fap_lkg->fa_size, &length) &&
+                  lkg_slot_get_length(fap_lkg, fap_lkg->fa_size, &lkg_length) &&
+                  (lkg_length == length) && lkg_slot_compare(fap_primary, fap_lkg, length);
+    }
+
+    lkg_slot_close(fap_primary, fap_lkg);
+
+    return current;
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_invalidate
+ ******************************************************************************
+ * Summary:
+ *  Erases the header of the last-known-good image, e.g. after it failed
+ *  validation once restored, so that the next rollback uses the factory app.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+cy_rslt_t lkg_slot_invalidate(void)
+{
+    const struct flash_area *fap_primary;
+    const struct flash_area *fap_lkg;
+    cy_rslt_t result;
+
+    result = lkg_slot_open(&fap_primary, &fap_lkg);
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = flash_area_erase(fap_lkg, 0, CY_EXT_FLASH_ERASE_SIZE);
+    }
+
+    lkg_slot_close(fap_primary, fap_lkg);
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: lkg_slot_get_area
+ ******************************************************************************
+ * Summary:
+ *  Populates a flash_area structure with the last-known-good slot, to be
+ *  used as the source of a rollback.
+ *
+ * Parameters:
+ *  fap - Flash area structure to be populated.
+ *
+ ******************************************************************************/
+void lkg_slot_get_area(struct flash_area *fap)
+{
+    const struct flash_area *fap_lkg = NULL;
+
+    memset(fap, 0, sizeof(*fap));
+
+    if (flash_area_open(FLASH_AREA_LKG_SLOT, &fap_lkg) == CY_RSLT_SUCCESS)
+    {
+        *fap = *fap_lkg;
+        flash_area_close(fap_lkg);
+    }
+}
+
+/* [] END OF FILE */
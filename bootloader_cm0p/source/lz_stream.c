@@ -0,0 +1,378 @@
+/******************************************************************************
+ * File Name: lz_stream.c
+ *
+ * Description: This file implements the streaming decompressor used for
+ * compressed factory app images. Output is produced on demand, one copy buffer
+ * at a time, so the whole image never has to be held in RAM.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "bootutil/bootutil_log.h"
+
+/* Local headers. */
+#include "lz_stream.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Error returned on a malformed or truncated stream. */
+#define LZ_STREAM_RSLT_ERR_FORMAT   (1UL)
+
+/* Mask used for indexing the history window. */
+#define LZ_STREAM_WINDOW_MASK       (LZ_STREAM_WINDOW_SIZE - 1UL)
+
+/* Minimum match length of the LZ4 format. */
+#define LZ_STREAM_MIN_MATCH         (4UL)
+
+/* Length nibble value announcing extension bytes. */
+#define LZ_STREAM_LEN_EXT           (15UL)
+
+/* Value used for padding past the end of the image. */
+#define LZ_STREAM_PAD_VALUE         (0x00U)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static bool lz_stream_input_done(const lz_stream_t *stream);
+static cy_rslt_t lz_stream_fill(lz_stream_t *stream);
+static cy_rslt_t lz_stream_next_byte(lz_stream_t *stream, uint8_t *byte);
+static cy_rslt_t lz_stream_read_len(lz_stream_t *stream, uint32_t *len);
+static cy_rslt_t lz_stream_produce(lz_stream_t *stream, uint8_t *out, uint32_t len);
+
+/******************************************************************************
+ * Function Name: lz_stream_input_done
+ ******************************************************************************
+ * Summary:
+ *  Checks whether the whole compressed stream has been consumed.
+ *
+ ******************************************************************************/
+static bool lz_stream_input_done(const lz_stream_t *stream)
+{
+    return (stream->in_pos == stream->in_len) && (stream->in_off == stream->in_end);
+}
+
+/******************************************************************************
+ * Function Name: lz_stream_fill
+ ******************************************************************************
+ * Summary:
+ *  Refills the input buffer from the flash area, if it is empty.
+ *
+ ******************************************************************************/
+static cy_rslt_t lz_stream_fill(lz_stream_t *stream)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t len;
+
+    if (stream->in_pos == stream->in_len)
+    {
+        len = stream->in_end - stream->in_off;
+        len = (len > LZ_STREAM_IN_BUF_SIZE) ? LZ_STREAM_IN_BUF_SIZE : len;
+
+        if (len == 0)
+        {
+            BOOT_LOG_ERR("Compressed image is truncated");
+            result = LZ_STREAM_RSLT_ERR_FORMAT;
+        }
+        else
+        {
+            result = flash_area_read(stream->fap, stream->in_off, stream->in_buf, len);
+            stream->in_off += len;
+            stream->in_len = len;
+            stream->in_pos = 0;
+        }
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: lz_stream_next_byte
+ ******************************************************************************
+ * Summary:
+ *  Returns the next byte of the compressed stream.
+ *
+ ******************************************************************************/
+static cy_rslt_t lz_stream_next_byte(lz_stream_t *stream, uint8_t *byte)
+{
+    cy_rslt_t result = lz_stream_fill(stream);
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        *byte = stream->in_buf[stream->in_pos++];
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: lz_stream_read_len
+ ******************************************************************************
+ * Summary:
+ *  Adds the LZ4 length extension bytes (terminated by a byte != 255) to
+ *  "len".
+ *
+ ******************************************************************************/
+static cy_rslt_t lz_stream_read_len(lz_stream_t *stream, uint32_t *len)
+{
+    cy_rslt_t result;
+    uint8_t byte = 0;
+
+    do
+    {
+        result = lz_stream_next_byte(stream, &byte);
+        *len += byte;
+    } while ((result == CY_RSLT_SUCCESS) && (byte == 0xFFU));
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: lz_stream_produce
+ ******************************************************************************
+ * Summary:
+ *  Decompresses the next "len" bytes of the image into "out". Bytes past the
+ *  end of the image are filled with LZ_STREAM_PAD_VALUE.
+ *
+ ******************************************************************************/
+static cy_rslt_t lz_stream_produce(lz_stream_t *stream, uint8_t *out, uint32_t len)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t chunk;
+    uint8_t byte;
+    uint8_t off_lo = 0, off_hi = 0;
+
+    while ((result == CY_RSLT_SUCCESS) && (len > 0))
+    {
+        if (stream->lit_left != 0)
+        {
+            /* Copy a run of literals straight from the input buffer. */
+            result = lz_stream_fill(stream);
+
+            if (result == CY_RSLT_SUCCESS)
+            {
+                chunk = stream->in_len - stream->in_pos;
+                chunk = (chunk > stream->lit_left) ? stream->lit_left : chunk;
+                chunk = (chunk > len) ? len : chunk;
+
+                stream->lit_left -= chunk;
+                len -= chunk;
+
+                while (chunk-- > 0)
+                {
+                    byte = stream->in_buf[stream->in_pos++];
+                    stream->window[stream->out_pos++ & LZ_STREAM_WINDOW_MASK] = byte;
+                    *out++ = byte;
+                }
+            }
+        }
+        else if (stream->match_left != 0)
+        {
+            /* Matches may overlap the bytes they produce: copy bytewise. */
+            byte = stream->window[(stream->out_pos - stream->match_off) & LZ_STREAM_WINDOW_MASK];
+            stream->window[stream->out_pos++ & LZ_STREAM_WINDOW_MASK] = byte;
+            *out++ = byte;
+            stream->match_left--;
+            len--;
+        }
+        else if (stream->end)
+        {
+            memset(out, LZ_STREAM_PAD_VALUE, len);
+            stream->out_pos += len;
+            len = 0;
+        }
+        else if (lz_stream_input_done(stream))
+        {
+            /* The last sequence has no match part. */
+            stream->end = true;
+
+            if (stream->out_pos != stream->image_size)
+            {
+                BOOT_LOG_ERR("Decompressed size mismatch");
+                result = LZ_STREAM_RSLT_ERR_FORMAT;
+            }
+        }
+        else if (stream->need_match)
+        {
+            /* Match part of the sequence: 16-bit LE offset and length. */
+            result = lz_stream_next_byte(stream, &off_lo);
+
+            if (result == CY_RSLT_SUCCESS)
+            {
+                result = lz_stream_next_byte(stream, &off_hi);
+            }
+
+            stream->match_off = (uint32_t)off_lo | ((uint32_t)off_hi << 8U);
+            stream->match_left = (stream->token & 0x0FU) + LZ_STREAM_MIN_MATCH;
+
+            if ((result == CY_RSLT_SUCCESS) && ((stream->token & 0x0FU) == LZ_STREAM_LEN_EXT))
+            {
+                result = lz_stream_read_len(stream, &stream->match_left);
+            }
+
+            if ((result == CY_RSLT_SUCCESS) &&
+                ((stream->match_off == 0) || (stream->match_off > LZ_STREAM_WINDOW_SIZE) ||
+                 (stream->match_off > stream->out_pos) ||
+                 ((stream->out_pos + stream->match_left) > stream->image_size)))
+            {
+                BOOT_LOG_ERR("Invalid match in compressed image");
+                result = LZ_STREAM_RSLT_ERR_FORMAT;
+            }
+
+            stream->need_match = false;
+        }
+        else
+        {
+            /* New sequence: token and literal length. */
+            result = lz_stream_next_byte(stream, &stream->token);
+            stream->lit_left = stream->token >> 4U;
+
+            if ((result == CY_RSLT_SUCCESS) && (stream->lit_left == LZ_STREAM_LEN_EXT))
+            {
+                result = lz_stream_read_len(stream, &stream->lit_left);
+            }
+
+            if ((result == CY_RSLT_SUCCESS) &&
+                ((stream->out_pos + stream->lit_left) > stream->image_size))
+            {
+                BOOT_LOG_ERR("Invalid literal run in compressed image");
+                result = LZ_STREAM_RSLT_ERR_FORMAT;
+            }
+
+            stream->need_match = true;
+        }
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: lz_stream_probe
+ ******************************************************************************
+ * Summary:
+ *  Checks whether the flash area starts with a compressed image container.
+ *
+ * Parameters:
+ *  fap - Flash area holding the factory app.
+ *  hdr - Filled with the container header.
+ *
+ * Return:
+ *  true if a valid container header was found.
+ *
+ ******************************************************************************/
+bool lz_stream_probe(const struct flash_area *fap, lz_stream_hdr_t *hdr)
+{
+    return (flash_area_read(fap, 0, hdr, sizeof(*hdr)) == CY_RSLT_SUCCESS) &&
+           (hdr->magic == LZ_STREAM_MAGIC) &&
+           (hdr->window <= LZ_STREAM_WINDOW_SIZE) &&
+           (hdr->comp_size <= (fap->fa_size - sizeof(*hdr)));
+}
+
+/******************************************************************************
+ * Function Name: lz_stream_init
+ ******************************************************************************
+ * Summary:
+ *  Initializes the decompressor for the container found by lz_stream_probe().
+ *
+ * Parameters:
+ *  stream - Decompressor state.
+ *  fap    - Flash area holding the factory app.
+ *  hdr    - Container header.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+cy_rslt_t lz_stream_init(lz_stream_t *stream, const struct flash_area *fap,
+                         const lz_stream_hdr_t *hdr)
+{
+    memset(stream, 0, sizeof(*stream));
+
+    stream->fap = fap;
+    stream->in_off = sizeof(*hdr);
+    stream->in_end = sizeof(*hdr) + hdr->comp_size;
+    stream->image_size = hdr->image_size;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: lz_stream_read
+ ******************************************************************************
+ * Summary:
+ *  Read callback of the copy engine. Decompressed data is produced strictly
+ *  in order: reading ahead of the current position decompresses and drops
+ *  the skipped bytes (used when a transfer is resumed), reading behind it is
+ *  not supported.
+ *
+ * Parameters:
+ *  ctx - Decompressor state (lz_stream_t).
+ *  off - Offset in the decompressed image.
+ *  buf - Output buffer.
+ *  len - Number of bytes to produce.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+cy_rslt_t lz_stream_read(void *ctx, uint32_t off, void *buf, uint32_t len)
+{
+    lz_stream_t *stream = (lz_stream_t *)ctx;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t skip;
+
+    if (off < stream->out_pos)
+    {
+        result = LZ_STREAM_RSLT_ERR_FORMAT;
+    }
+
+    /* Skip ahead, using the output buffer as scratch. */
+    while ((result == CY_RSLT_SUCCESS) && (len > 0) && (off > stream->out_pos))
+    {
+        skip = off - stream->out_pos;
+        skip = (skip > len) ? len : skip;
+        result = lz_stream_produce(stream, (uint8_t *)buf, skip);
+    }
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = lz_stream_produce(stream, (uint8_t *)buf, len);
+    }
+
+    return result;
+}
+
+/* [] END OF FILE */
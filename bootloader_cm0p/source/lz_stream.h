@@ -0,0 +1,93 @@
+/******************************************************************************
+ * File Name: lz_stream.h
+ *
+ * Description: This file contains declaration of the streaming decompressor
+ * used for compressed factory app images. The compressed image is an LZ4 block
+ * stream whose match offsets are limited to LZ_STREAM_WINDOW_SIZE bytes, so
+ * that the history fits in a small RAM window.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_LZ_STREAM_H_
+#define SOURCE_LZ_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "flash_map_backend/flash_map_backend.h"
+
+/* Container magic: "FLZ4". */
+#define LZ_STREAM_MAGIC             (0x345A4C46UL)
+
+/* History window size. Must be a power of two and match the "--window"
+ * option of the compression tool (common/script/factory_compress.py).
+ */
+#define LZ_STREAM_WINDOW_SIZE       (4096UL)
+
+/* Size of the buffer used for reading the compressed stream. */
+#define LZ_STREAM_IN_BUF_SIZE       (512UL)
+
+/* Container header placed in front of the compressed stream. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t comp_size;         /* Size of the compressed stream. */
+    uint32_t image_size;        /* Size of the decompressed image. */
+    uint32_t window;            /* Largest match offset used. */
+} lz_stream_hdr_t;
+
+/* Decompressor state. */
+typedef struct
+{
+    const struct flash_area *fap;
+    uint32_t in_off;            /* Next offset to read from the flash area. */
+    uint32_t in_end;            /* End of the compressed stream. */
+    uint32_t in_pos;            /* Read position in in_buf. */
+    uint32_t in_len;            /* Valid bytes in in_buf. */
+    uint32_t image_size;
+    uint32_t out_pos;           /* Number of decompressed bytes produced. */
+    uint32_t lit_left;          /* Literals left in the current sequence. */
+    uint32_t match_left;        /* Match bytes left in the current sequence. */
+    uint32_t match_off;
+    uint8_t token;
+    bool need_match;
+    bool end;
+    uint8_t in_buf[LZ_STREAM_IN_BUF_SIZE];
+    uint8_t window[LZ_STREAM_WINDOW_SIZE];
+} lz_stream_t;
+
+bool lz_stream_probe(const struct flash_area *fap, lz_stream_hdr_t *hdr);
+cy_rslt_t lz_stream_init(lz_stream_t *stream, const struct flash_area *fap,
+                         const lz_stream_hdr_t *hdr);
+cy_rslt_t lz_stream_read(void *ctx, uint32_t off, void *buf, uint32_t len);
+
+#endif /* SOURCE_LZ_STREAM_H_ */
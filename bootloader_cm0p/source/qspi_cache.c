@@ -0,0 +1,320 @@
+/******************************************************************************
+ * File Name: qspi_cache.c
+ *
+ * Description: This file implements the external memory initialization using a
+ * cached SFDP discovery result. The memory configuration produced by the SFDP
+ * detection is saved in a boot store row, keyed by the JEDEC ID of the part,
+ * and reused on the next boots so that the SFDP tables are not parsed again.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <stddef.h>
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "bootutil/bootutil_log.h"
+
+/*  Flash access headers. */
+#include "cy_smif_psoc6.h"
+
+/* Local headers. */
+#include "qspi_cache.h"
+#include "boot_store.h"
+#include "crc32.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Cache record magic: "SFC1". */
+#define QSPI_CACHE_MAGIC            (0x31434653UL)
+
+/* Index of the SMIF memory configuration of the external memory. */
+#define QSPI_CACHE_MEM_CONFIG_INDEX (0U)
+
+/* Number of commands of a memory device configuration. */
+#define QSPI_CACHE_NUM_CMDS         (9UL)
+
+/* JEDEC "Read Identification" command and the number of ID bytes used. */
+#define QSPI_CACHE_CMD_READ_ID      (0x9FU)
+#define QSPI_CACHE_ID_SIZE          (3UL)
+
+/* Error returned when the cache can't be used. */
+#define QSPI_CACHE_RSLT_ERR_MISS    (1UL)
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+/* Cache record. The pointers of the configuration structures are only valid
+ * for the bootloader build that wrote the record; programming a new
+ * bootloader clears the boot store.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t size;              /* sizeof(qspi_cache_rec_t). */
+    uint32_t smif_id;
+    uint32_t jedec_id;
+    uint32_t cmd_mask;          /* Bit set for each non-NULL command. */
+    cy_stc_smif_mem_config_t mem_cfg;
+    cy_stc_smif_mem_device_cfg_t dev_cfg;
+    cy_stc_smif_mem_cmd_t cmds[QSPI_CACHE_NUM_CMDS];
+    uint32_t crc;               /* CRC-32 of the preceding fields. */
+} qspi_cache_rec_t;
+
+/* Compile-time check: the record must fit a boot store row. */
+typedef char qspi_cache_rec_size_check[(sizeof(qspi_cache_rec_t) <= BOOT_STORE_ROW_SIZE) ? 1 : -1];
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Configuration restored from the cache, handed over to the QSPI driver. */
+static qspi_cache_rec_t cache_rec;
+static cy_stc_smif_mem_config_t *cache_mem_configs[1] = { &cache_rec.mem_cfg };
+static cy_stc_smif_block_config_t cache_blk_cfg =
+{
+    .memCount = 1U,
+    .memConfig = cache_mem_configs,
+};
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_stc_smif_mem_cmd_t **qspi_cache_cmd(cy_stc_smif_mem_device_cfg_t *dev_cfg, uint32_t index);
+static cy_rslt_t qspi_cache_read_id(uint32_t *jedec_id);
+static cy_rslt_t qspi_cache_restore(uint32_t smif_id);
+static void qspi_cache_save(uint32_t smif_id);
+
+/******************************************************************************
+ * Function Name: qspi_cache_cmd
+ ******************************************************************************
+ * Summary:
+ *  Returns the address of the "index"-th command pointer of a memory device
+ *  configuration.
+ *
+ ******************************************************************************/
+static cy_stc_smif_mem_cmd_t **qspi_cache_cmd(cy_stc_smif_mem_device_cfg_t *dev_cfg, uint32_t index)
+{
+    cy_stc_smif_mem_cmd_t **cmd;
+
+    switch (index)
+    {
+        case 0:  cmd = &dev_cfg->readCmd;          break;
+        case 1:  cmd = &dev_cfg->writeEnCmd;       break;
+        case 2:  cmd = &dev_cfg->writeDisCmd;      break;
+        case 3:  cmd = &dev_cfg->eraseCmd;         break;
+        case 4:  cmd = &dev_cfg->chipEraseCmd;     break;
+        case 5:  cmd = &dev_cfg->programCmd;       break;
+        case 6:  cmd = &dev_cfg->readStsRegWipCmd; break;
+        case 7:  cmd = &dev_cfg->readStsRegQeCmd;  break;
+        default: cmd = &dev_cfg->writeStsRegQeCmd; break;
+    }
+
+    return cmd;
+}
+
+/******************************************************************************
+ * Function Name: qspi_cache_read_id
+ ******************************************************************************
+ * Summary:
+ *  Reads the JEDEC manufacturer and device ID of the external memory, in
+ *  single SPI mode.
+ *
+ ******************************************************************************/
+static cy_rslt_t qspi_cache_read_id(uint32_t *jedec_id)
+{
+    cy_stc_smif_mem_config_t *mem_cfg = qspi_get_memory_config(QSPI_CACHE_MEM_CONFIG_INDEX);
+    uint8_t id[QSPI_CACHE_ID_SIZE] = {0};
+    cy_en_smif_status_t status;
+
+    status = Cy_SMIF_TransmitCommand(qspi_get_device(), QSPI_CACHE_CMD_READ_ID,
+            CY_SMIF_WIDTH_SINGLE, NULL, 0, CY_SMIF_WIDTH_SINGLE,
+            mem_cfg->slaveSelect, CY_SMIF_TX_NOT_LAST_BYTE, qspi_get_context());
+
+    if (status == CY_SMIF_SUCCESS)
+    {
+        status = Cy_SMIF_ReceiveDataBlocking(qspi_get_device(), id, sizeof(id),
+                CY_SMIF_WIDTH_SINGLE, qspi_get_context());
+    }
+
+    *jedec_id = ((uint32_t)id[0] << 16U) | ((uint32_t)id[1] << 8U) | id[2];
+
+    /* A missing or unpowered part reads as all 0s or all 1s. */
+    return ((status == CY_SMIF_SUCCESS) && (*jedec_id != 0UL) && (*jedec_id != 0xFFFFFFUL)) ?
+           CY_RSLT_SUCCESS : QSPI_CACHE_RSLT_ERR_MISS;
+}
+
+/******************************************************************************
+ * Function Name: qspi_cache_restore
+ ******************************************************************************
+ * Summary:
+ *  Initializes the external memory with the cached configuration, if the
+ *  cache record is valid and the JEDEC ID of the part matches it.
+ *
+ ******************************************************************************/
+static cy_rslt_t qspi_cache_restore(uint32_t smif_id)
+{
+    cy_rslt_t result = QSPI_CACHE_RSLT_ERR_MISS;
+    uint32_t jedec_id = 0;
+    uint32_t i;
+
+    memcpy(&cache_rec, boot_store_get(BOOT_STORE_ROW_SFDP_CACHE), sizeof(cache_rec));
+
+    if ((cache_rec.magic == QSPI_CACHE_MAGIC) && (cache_rec.size == sizeof(cache_rec)) &&
+        (cache_rec.smif_id == smif_id) &&
+        (cache_rec.crc == crc32_update(0, &cache_rec, offsetof(qspi_cache_rec_t, crc))))
+    {
+        /* Relink the configuration structures to the restored copies. */
+        cache_rec.mem_cfg.deviceCfg = &cache_rec.dev_cfg;
+
+        for (i = 0; i < QSPI_CACHE_NUM_CMDS; i++)
+        {
+            *qspi_cache_cmd(&cache_rec.dev_cfg, i) =
+                    ((cache_rec.cmd_mask & (1UL << i)) != 0UL) ? &cache_rec.cmds[i] : NULL;
+        }
+
+        if ((qspi_init(&cache_blk_cfg) == CY_SMIF_SUCCESS) &&
+            (qspi_cache_read_id(&jedec_id) == CY_RSLT_SUCCESS))
+        {
+            if (jedec_id == cache_rec.jedec_id)
+            {
+                result = CY_RSLT_SUCCESS;
+            }
+            else
+            {
+                BOOT_LOG_INF("External memory changed (ID 0x%06x)", (int)jedec_id);
+            }
+        }
+
+        if (result != CY_RSLT_SUCCESS)
+        {
+            qspi_deinit(smif_id);
+        }
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: qspi_cache_save
+ ******************************************************************************
+ * Summary:
+ *  Saves the configuration produced by the SFDP detection to the cache.
+ *  Failures are not fatal: the SFDP detection simply runs again on the next
+ *  boot.
+ *
+ ******************************************************************************/
+static void qspi_cache_save(uint32_t smif_id)
+{
+    cy_stc_smif_mem_config_t *mem_cfg = qspi_get_memory_config(QSPI_CACHE_MEM_CONFIG_INDEX);
+    cy_stc_smif_mem_cmd_t *cmd;
+    uint32_t i;
+
+    memset(&cache_rec, 0, sizeof(cache_rec));
+
+    if (qspi_cache_read_id(&cache_rec.jedec_id) != CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_WRN("Failed to read external memory ID, SFDP result not cached");
+        return;
+    }
+
+    cache_rec.magic = QSPI_CACHE_MAGIC;
+    cache_rec.size = sizeof(cache_rec);
+    cache_rec.smif_id = smif_id;
+    cache_rec.mem_cfg = *mem_cfg;
+    cache_rec.dev_cfg = *mem_cfg->deviceCfg;
+
+    /* The cached configuration is used as is, without SFDP detection. */
+    cache_rec.mem_cfg.flags &= ~CY_SMIF_FLAG_DETECT_SFDP;
+
+    for (i = 0; i < QSPI_CACHE_NUM_CMDS; i++)
+    {
+        cmd = *qspi_cache_cmd(mem_cfg->deviceCfg, i);
+
+        if (cmd != NULL)
+        {
+            cache_rec.cmds[i] = *cmd;
+            cache_rec.cmd_mask |= (1UL << i);
+        }
+    }
+
+    cache_rec.crc = crc32_update(0, &cache_rec, offsetof(qspi_cache_rec_t, crc));
+
+    if (boot_store_write(BOOT_STORE_ROW_SFDP_CACHE, &cache_rec, sizeof(cache_rec)) == CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_INF("SFDP result cached (ID 0x%06x)", (int)cache_rec.jedec_id);
+    }
+}
+
+/******************************************************************************
+ * Function Name: qspi_cache_init
+ ******************************************************************************
+ * Summary:
+ *  Initializes the external memory. The cached SFDP discovery result is used
+ *  if it is valid and matches the JEDEC ID of the part. Otherwise, the full
+ *  SFDP detection runs and its result is cached for the next boots.
+ *
+ * Parameters:
+ *  smif_id   - Slave select line of the external memory (see qspi_init_sfdp()).
+ *  cache_hit - Set to true when the cached configuration was used.
+ *
+ * Return:
+ *  Status of the initialization.
+ *
+ ******************************************************************************/
+cy_rslt_t qspi_cache_init(uint32_t smif_id, bool *cache_hit)
+{
+    cy_rslt_t result;
+
+    *cache_hit = (qspi_cache_restore(smif_id) == CY_RSLT_SUCCESS);
+
+    if (*cache_hit)
+    {
+        result = CY_RSLT_SUCCESS;
+    }
+    else
+    {
+        result = (cy_rslt_t) qspi_init_sfdp(smif_id);
+
+        if (result == CY_RSLT_SUCCESS)
+        {
+            qspi_cache_save(smif_id);
+        }
+    }
+
+    return result;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,161 @@
+/******************************************************************************
+ * File Name: qspi_info.c
+ *
+ * Description: This file implements the report of the external memory read
+ * mode selected from SFDP and a read throughput self-test.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "bootutil/bootutil_log.h"
+
+/*  Flash access headers. */
+#include "cy_smif_psoc6.h"
+
+/* Local headers. */
+#include "qspi_info.h"
+#include "boot_timer.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Index of the SMIF memory configuration of the external memory. */
+#define QSPI_INFO_MEM_CONFIG_INDEX  (0U)
+
+/* High-frequency clock feeding the SMIF block. */
+#define QSPI_INFO_SMIF_CLK_HF       (2UL)
+
+/* Size of a single read of the throughput self-test. */
+#define QSPI_INFO_BENCH_CHUNK_SIZE  (4096UL)
+
+/* Number of data lines used by a transfer width. */
+#define QSPI_INFO_LINES(width)      (1UL << (uint32_t)(width))
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+static uint32_t bench_buf[QSPI_INFO_BENCH_CHUNK_SIZE / sizeof(uint32_t)];
+
+/******************************************************************************
+ * Function Name: qspi_info_print
+ ******************************************************************************
+ * Summary:
+ *  Prints the read command selected by the SFDP detection, in the usual
+ *  "command-address-data" lines notation (e.g. 1-4-4), and the SMIF clock.
+ *  The SFDP detection selects the widest read mode advertised by the part;
+ *  a warning is printed if it is not a quad mode.
+ *
+ ******************************************************************************/
+void qspi_info_print(void)
+{
+    const cy_stc_smif_mem_config_t *mem_cfg = qspi_get_memory_config(QSPI_INFO_MEM_CONFIG_INDEX);
+    const cy_stc_smif_mem_cmd_t *read_cmd;
+
+    if ((mem_cfg == NULL) || (mem_cfg->deviceCfg == NULL) ||
+        (mem_cfg->deviceCfg->readCmd == NULL))
+    {
+        BOOT_LOG_WRN("External memory configuration not available");
+        return;
+    }
+
+    read_cmd = mem_cfg->deviceCfg->readCmd;
+
+    BOOT_LOG_INF("External memory: %u KB, read cmd 0x%02x (%u-%u-%u), %u dummy cycles",
+            (unsigned int)(mem_cfg->deviceCfg->memSize / 1024UL),
+            (unsigned int)read_cmd->command,
+            (unsigned int)QSPI_INFO_LINES(read_cmd->cmdWidth),
+            (unsigned int)QSPI_INFO_LINES(read_cmd->addrWidth),
+            (unsigned int)QSPI_INFO_LINES(read_cmd->dataWidth),
+            (unsigned int)read_cmd->dummyCycles);
+    BOOT_LOG_INF("SMIF clock (CLK_HF%u): %u kHz", (unsigned int)QSPI_INFO_SMIF_CLK_HF,
+            (unsigned int)(Cy_SysClk_ClkHfGetFrequency(QSPI_INFO_SMIF_CLK_HF) / 1000UL));
+
+    if (read_cmd->dataWidth < CY_SMIF_WIDTH_QUAD)
+    {
+        BOOT_LOG_WRN("External memory is not read in quad mode !");
+    }
+}
+
+/******************************************************************************
+ * Function Name: qspi_info_benchmark
+ ******************************************************************************
+ * Summary:
+ *  Read throughput self-test: reads "length" bytes from the start of a flash
+ *  area in the external memory and prints the throughput achieved.
+ *
+ * Parameters:
+ *  fap    - Flash area in the external memory.
+ *  length - Number of bytes to read.
+ *
+ * Return:
+ *  Status of the read operations.
+ *
+ ******************************************************************************/
+cy_rslt_t qspi_info_benchmark(const struct flash_area *fap, uint32_t length)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t start_us = boot_timer_get_us();
+    uint32_t elapsed_us;
+    uint32_t off;
+
+    length = (length > fap->fa_size) ? fap->fa_size : length;
+
+    for (off = 0; (result == CY_RSLT_SUCCESS) && (off < length); off += QSPI_INFO_BENCH_CHUNK_SIZE)
+    {
+        result = psoc6_smif_read(fap, fap->fa_off + off, bench_buf, QSPI_INFO_BENCH_CHUNK_SIZE);
+    }
+
+    elapsed_us = boot_timer_get_us() - start_us;
+
+    if (result != CY_RSLT_SUCCESS)
+    {
+        BOOT_LOG_ERR("QSPI self-test read failed @ offset 0x%08x", (int)off);
+    }
+    else if (elapsed_us != 0)
+    {
+        BOOT_LOG_INF("QSPI read: %u bytes in %u us (%u bytes/s)",
+                (unsigned int)off, (unsigned int)elapsed_us,
+                (unsigned int)(((uint64_t)off * 1000000ULL) / elapsed_us));
+    }
+    else
+    {
+        /* Nothing to report. */
+    }
+
+    return result;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,348 @@
+/******************************************************************************
+ * File Name: rollback_journal.c
+ *
+ * Description: This file implements the rollback journal. The journal occupies
+ * one erase block of the external memory: a header describing the transfer, a
+ * completion marker and one commit word per ROLLBACK_JOURNAL_STRIDE bytes
+ * copied. Words are only ever programmed from the erased state, so the journal
+ * is erased once per rollback.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/bootutil_log.h"
+
+/*  Flash access headers. */
+#include "flash_map_backend/flash_map_backend.h"
+#include "ext_flash_map.h"
+
+/* Local headers. */
+#include "rollback_journal.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Journal header magic: "RBJ1". */
+#define JOURNAL_MAGIC                   (0x314A4252UL)
+
+/* Value of a programmed marker / commit word. */
+#define JOURNAL_WORD_SET                (0x00000000UL)
+
+/* Maximum number of commit words. */
+#define JOURNAL_MAX_COMMITS             ((CY_FACT_APP_SIZE + ROLLBACK_JOURNAL_STRIDE - 1UL) / \
+                                         ROLLBACK_JOURNAL_STRIDE)
+
+/* Offsets of the journal fields. */
+#define JOURNAL_HEADER_OFF              (0UL)
+#define JOURNAL_DONE_OFF                (sizeof(rollback_journal_hdr_t))
+#define JOURNAL_COMMIT_OFF(idx)         (JOURNAL_DONE_OFF + sizeof(uint32_t) + \
+                                         ((idx) * sizeof(uint32_t)))
+
+/*******************************************************************************
+* Data structures
+********************************************************************************/
+/* Journal header, written once when the transfer starts. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t image_size;        /* Number of bytes being transferred. */
+    uint32_t stride;            /* Number of bytes covered by a commit word. */
+    uint8_t image;              /* Index of the image being transferred. */
+    uint8_t source;             /* ROLLBACK_SOURCE_xxx of the image. */
+    uint16_t images;            /* Mask of the images of the rollback. */
+} rollback_journal_hdr_t;
+
+/* Journal content as read from the external memory. */
+typedef struct
+{
+    rollback_journal_hdr_t hdr;
+    uint32_t done;
+    uint32_t commits[JOURNAL_MAX_COMMITS];
+} rollback_journal_t;
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Number of commit words programmed for the ongoing transfer. */
+static uint32_t journal_commits = 0;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t rollback_journal_write(uint32_t off, const void *data, uint32_t len);
+static bool rollback_journal_load(rollback_journal_t *journal);
+
+/******************************************************************************
+ * Function Name: rollback_journal_write
+ ******************************************************************************
+ * Summary:
+ *  Programs data into the journal area.
+ *
+ * Parameters:
+ *  off  - Offset within the journal area.
+ *  data - Data to be programmed.
+ *  len  - Number of bytes to be programmed.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t rollback_journal_write(uint32_t off, const void *data, uint32_t len)
+{
+    cy_rslt_t result;
+    const struct flash_area *fap = NULL;
+
+    result = flash_area_open(FLASH_AREA_ROLLBACK_JOURNAL, &fap);
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = flash_area_write(fap, off, data, len);
+        flash_area_close(fap);
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: rollback_journal_load
+ ******************************************************************************
+ * Summary:
+ *  Reads the journal and reports whether it describes a transfer that was
+ *  started but not completed.
+ *
+ * Parameters:
+ *  journal - Filled with the journal content.
+ *
+ * Return:
+ *  true if a transfer is in progress.
+ *
+ ******************************************************************************/
+static bool rollback_journal_load(rollback_journal_t *journal)
+{
+    const struct flash_area *fap = NULL;
+    bool pending = false;
+
+    if (flash_area_open(FLASH_AREA_ROLLBACK_JOURNAL, &fap) == CY_RSLT_SUCCESS)
+    {
+        if (flash_area_read(fap, JOURNAL_HEADER_OFF, journal, sizeof(*journal)) == CY_RSLT_SUCCESS)
+        {
+            pending = (journal->hdr.magic == JOURNAL_MAGIC) &&
+                      (journal->hdr.stride == ROLLBACK_JOURNAL_STRIDE) &&
+                      (journal->hdr.image_size <= CY_FACT_APP_SIZE) &&
+                      (journal->hdr.image < MCUBOOT_IMAGE_NUMBER) &&
+                      (journal->hdr.source <= ROLLBACK_SOURCE_LKG) &&
+                      (journal->done != JOURNAL_WORD_SET);
+        }
+
+        flash_area_close(fap);
+    }
+
+    return pending;
+}
+
+/******************************************************************************
+ * Function Name: rollback_journal_start
+ ******************************************************************************
+ * Summary:
+ *  Erases the journal and records the start of a new transfer.
+ *
+ * Parameters:
+ *  image      - Index of the image to be transferred.
+ *  images     - Mask of the images rolled back, bit n for image n. The
+ *               images after "image" are transferred next.
+ *  source     - Source of the image (ROLLBACK_SOURCE_xxx).
+ *  image_size - Number of bytes to be transferred.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+cy_rslt_t rollback_journal_start(uint32_t image, uint32_t images, uint32_t source,
+                                 uint32_t image_size)
+{
+    cy_rslt_t result;
+    const struct flash_area *fap = NULL;
+    rollback_journal_hdr_t hdr =
+    {
+        .magic = JOURNAL_MAGIC,
+        .image_size = image_size,
+        .stride = ROLLBACK_JOURNAL_STRIDE,
+        .image = (uint8_t)image,
+        .source = (uint8_t)source,
+        .images = (uint16_t)images
+    };
+
+    journal_commits = 0;
+
+    result = flash_area_open(FLASH_AREA_ROLLBACK_JOURNAL, &fap);
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = flash_area_erase(fap, 0, fap->fa_size);
+        flash_area_close(fap);
+    }
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = rollback_journal_write(JOURNAL_HEADER_OFF, &hdr, sizeof(hdr));
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: rollback_journal_commit
+ ******************************************************************************
+ * Summary:
+ *  Records that the first "bytes_done" bytes of the image are in place.
+ *  The external memory is only written when a stride boundary is crossed,
+ *  so this function can be called after every erase unit of the copy.
+ *  A failure to update the journal is not fatal for the transfer itself.
+ *
+ * Parameters:
+ *  bytes_done - Number of bytes from the start of the image that are copied.
+ *
+ ******************************************************************************/
+void rollback_journal_commit(uint32_t bytes_done)
+{
+    const uint32_t word = JOURNAL_WORD_SET;
+    uint32_t target = bytes_done / ROLLBACK_JOURNAL_STRIDE;
+
+    while ((journal_commits < target) && (journal_commits < JOURNAL_MAX_COMMITS))
+    {
+        if (rollback_journal_write(JOURNAL_COMMIT_OFF(journal_commits), &word,
+                sizeof(word)) != CY_RSLT_SUCCESS)
+        {
+            BOOT_LOG_WRN("Failed to update rollback journal");
+            break;
+        }
+
+        journal_commits++;
+    }
+}
+
+/******************************************************************************
+ * Function Name: rollback_journal_complete
+ ******************************************************************************
+ * Summary:
+ *  Marks the ongoing transfer as completed.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+cy_rslt_t rollback_journal_complete(void)
+{
+    const uint32_t word = JOURNAL_WORD_SET;
+
+    return rollback_journal_write(JOURNAL_DONE_OFF, &word, sizeof(word));
+}
+
+/******************************************************************************
+ * Function Name: rollback_journal_is_pending
+ ******************************************************************************
+ * Summary:
+ *  Checks whether a transfer was interrupted, e.g. by a power failure.
+ *
+ * Parameters:
+ *  images - Filled with the mask of the images left to transfer: the image
+ *           whose transfer was interrupted and the next images of the same
+ *           rollback.
+ *  source - Filled with the source of the interrupted transfer.
+ *
+ * Return:
+ *  true if a transfer was started and not completed.
+ *
+ ******************************************************************************/
+bool rollback_journal_is_pending(uint32_t *images, uint32_t *source)
+{
+    rollback_journal_t journal;
+    bool pending = rollback_journal_load(&journal);
+
+    if (pending)
+    {
+        *images = ((uint32_t)journal.hdr.images | (1UL << journal.hdr.image)) &
+                  ~((1UL << journal.hdr.image) - 1UL);
+        *source = journal.hdr.source;
+    }
+
+    return pending;
+}
+
+/******************************************************************************
+ * Function Name: rollback_journal_get_resume
+ ******************************************************************************
+ * Summary:
+ *  Returns the offset from which an interrupted transfer of the same image
+ *  can be resumed. The journal keeps being updated from that point on.
+ *
+ * Parameters:
+ *  image      - Index of the image about to be transferred.
+ *  source     - Source of the image (ROLLBACK_SOURCE_xxx).
+ *  image_size - Number of bytes of the image about to be transferred.
+ *  offset     - Filled with the offset to resume from.
+ *
+ * Return:
+ *  true if the transfer can be resumed.
+ *
+ ******************************************************************************/
+bool rollback_journal_get_resume(uint32_t image, uint32_t source, uint32_t image_size,
+                                 uint32_t *offset)
+{
+    rollback_journal_t journal;
+    bool resume = false;
+    uint32_t idx = 0;
+
+    if (rollback_journal_load(&journal) && (journal.hdr.image == image) &&
+        (journal.hdr.source == source) && (journal.hdr.image_size == image_size))
+    {
+        /* Commit words are programmed in order. */
+        while ((idx < JOURNAL_MAX_COMMITS) && (journal.commits[idx] == JOURNAL_WORD_SET))
+        {
+            idx++;
+        }
+
+        journal_commits = idx;
+        *offset = ((idx * ROLLBACK_JOURNAL_STRIDE) < image_size) ?
+                (idx * ROLLBACK_JOURNAL_STRIDE) : image_size;
+        resume = true;
+    }
+
+    return resume;
+}
+
+/* [] END OF FILE */
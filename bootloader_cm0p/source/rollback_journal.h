@@ -0,0 +1,66 @@
+/******************************************************************************
+ * File Name: rollback_journal.h
+ *
+ * Description: This file contains declaration of functions related to the
+ * rollback journal. The journal records the progress of a factory app transfer
+ * in external memory so that an interrupted rollback can be resumed on the
+ * next boot.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_ROLLBACK_JOURNAL_H_
+#define SOURCE_ROLLBACK_JOURNAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+
+/* Progress is committed to the journal once per stride. Up to one stride of
+ * copy work is redone after a power failure.
+ */
+#ifndef ROLLBACK_JOURNAL_STRIDE
+#define ROLLBACK_JOURNAL_STRIDE         (0x10000UL)
+#endif
+
+/* Source of the image transferred by a rollback. */
+#define ROLLBACK_SOURCE_FACTORY         (0UL)   /* Factory app. */
+#define ROLLBACK_SOURCE_LKG             (1UL)   /* Last-known-good slot. */
+
+cy_rslt_t rollback_journal_start(uint32_t image, uint32_t images, uint32_t source,
+                                 uint32_t image_size);
+void rollback_journal_commit(uint32_t bytes_done);
+cy_rslt_t rollback_journal_complete(void);
+bool rollback_journal_is_pending(uint32_t *images, uint32_t *source);
+bool rollback_journal_get_resume(uint32_t image, uint32_t source, uint32_t image_size,
+                                 uint32_t *offset);
+
+#endif /* SOURCE_ROLLBACK_JOURNAL_H_ */
@@ -0,0 +1,302 @@
+/******************************************************************************
+ * File Name: smif_cache.c
+ *
+ * Description: This file implements a read-through cache of the external
+ * memory in front of the SMIF functions of the MCUboot flash map backend.
+ * MCUboot reads many small fields of the secondary slot (header, TLV info,
+ * trailer magic and flags), each one costing a full SMIF command transaction.
+ * The cache keeps a few aligned lines of the memory and serves these reads
+ * from RAM. The functions of cy_smif_psoc6.c are wrapped at link time
+ * (--wrap), so that the MCUboot library is not modified.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <stdbool.h>
+#include <string.h>
+
+/* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/bootutil_log.h"
+
+/*  Flash access headers. */
+#include "flash_map_backend/flash_map_backend.h"
+#include "cy_smif_psoc6.h"
+
+/* Local headers. */
+#include "smif_cache.h"
+#include "smif_erase.h"
+
+#ifdef CY_BOOT_SMIF_CACHE
+
+/*******************************************************************************
+* Data types
+********************************************************************************/
+typedef struct
+{
+    bool valid;
+    uint8_t device_id;
+    uint32_t addr;          /* Memory address of the line, aligned. */
+    uint32_t last_use;      /* Value of cache_tick at the last hit. */
+    uint8_t data[SMIF_CACHE_LINE_SIZE];
+} smif_cache_line_t;
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+static smif_cache_line_t cache_lines[CY_BOOT_SMIF_CACHE_LINES];
+static smif_cache_stats_t cache_stats;
+static uint32_t cache_tick;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Functions of cy_smif_psoc6.c, resolved by the linker (--wrap). */
+int __real_psoc6_smif_read(const struct flash_area *fap, off_t addr, void *data, size_t len);
+int __real_psoc6_smif_write(const struct flash_area *fap, off_t addr, const void *data, size_t len);
+int __real_psoc6_smif_erase(off_t addr, size_t size);
+
+int __wrap_psoc6_smif_read(const struct flash_area *fap, off_t addr, void *data, size_t len);
+int __wrap_psoc6_smif_write(const struct flash_area *fap, off_t addr, const void *data, size_t len);
+int __wrap_psoc6_smif_erase(off_t addr, size_t size);
+
+static smif_cache_line_t *smif_cache_lookup(const struct flash_area *fap, uint32_t addr);
+static void smif_cache_drop(uint32_t addr, uint32_t len);
+
+/******************************************************************************
+ * Function Name: smif_cache_lookup
+ ******************************************************************************
+ * Summary:
+ *  Returns the cache line holding "addr", filling the least recently used
+ *  line from the memory on a miss.
+ *
+ * Parameters:
+ *  fap  - Flash area being read.
+ *  addr - Memory address of the line, aligned to SMIF_CACHE_LINE_SIZE.
+ *
+ * Return:
+ *  The line, or NULL if it can't be read.
+ *
+ ******************************************************************************/
+static smif_cache_line_t *smif_cache_lookup(const struct flash_area *fap, uint32_t addr)
+{
+    smif_cache_line_t *victim = &cache_lines[0];
+    uint32_t i;
+
+    cache_tick++;
+
+    for (i = 0; i < CY_BOOT_SMIF_CACHE_LINES; i++)
+    {
+        smif_cache_line_t *line = &cache_lines[i];
+
+        if (line->valid && (line->addr == addr) && (line->device_id == fap->fa_device_id))
+        {
+            line->last_use = cache_tick;
+            cache_stats.hits++;
+            return line;
+        }
+
+        /* Prefer an empty line, then the least recently used one. */
+        if (victim->valid && (!line->valid || (line->last_use < victim->last_use)))
+        {
+            victim = line;
+        }
+    }
+
+    cache_stats.misses++;
+    victim->valid = false;
+
+    if (__real_psoc6_smif_read(fap, (off_t)addr, victim->data, SMIF_CACHE_LINE_SIZE) != 0)
+    {
+        return NULL;
+    }
+
+    victim->valid = true;
+    victim->device_id = fap->fa_device_id;
+    victim->addr = addr;
+    victim->last_use = cache_tick;
+
+    return victim;
+}
+
+/******************************************************************************
+ * Function Name: smif_cache_drop
+ ******************************************************************************
+ * Summary:
+ *  Invalidates the lines overlapping a range of the memory.
+ *
+ ******************************************************************************/
+static void smif_cache_drop(uint32_t addr, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < CY_BOOT_SMIF_CACHE_LINES; i++)
+    {
+        smif_cache_line_t *line = &cache_lines[i];
+
+        if (line->valid && (line->addr < (addr + len)) &&
+            (addr < (line->addr + SMIF_CACHE_LINE_SIZE)))
+        {
+            line->valid = false;
+            cache_stats.invalidated++;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: __wrap_psoc6_smif_read
+ ******************************************************************************
+ * Summary:
+ *  Replaces psoc6_smif_read(). Reads up to a line are served from the cache;
+ *  larger reads (e.g. the copy engine) go to the memory directly.
+ *
+ ******************************************************************************/
+int __wrap_psoc6_smif_read(const struct flash_area *fap, off_t addr, void *data, size_t len)
+{
+    smif_cache_line_t *line;
+    uint8_t *dst = (uint8_t *)data;
+    uint32_t cur = (uint32_t)addr;
+    uint32_t left = (uint32_t)len;
+    uint32_t off;
+    uint32_t chunk;
+
+    if (len > SMIF_CACHE_LINE_SIZE)
+    {
+        cache_stats.bypassed++;
+        return __real_psoc6_smif_read(fap, addr, data, len);
+    }
+
+    cache_stats.reads++;
+
+    while (left > 0U)
+    {
+        line = smif_cache_lookup(fap, cur & ~(SMIF_CACHE_LINE_SIZE - 1UL));
+
+        if (line == NULL)
+        {
+            return -1;
+        }
+
+        off = cur & (SMIF_CACHE_LINE_SIZE - 1UL);
+        chunk = ((SMIF_CACHE_LINE_SIZE - off) < left) ? (SMIF_CACHE_LINE_SIZE - off) : left;
+        memcpy(dst, &line->data[off], chunk);
+
+        dst += chunk;
+        cur += chunk;
+        left -= chunk;
+    }
+
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: __wrap_psoc6_smif_write
+ ******************************************************************************
+ * Summary:
+ *  Replaces psoc6_smif_write(): drops the lines written to.
+ *
+ ******************************************************************************/
+int __wrap_psoc6_smif_write(const struct flash_area *fap, off_t addr, const void *data, size_t len)
+{
+    smif_cache_drop((uint32_t)addr, (uint32_t)len);
+
+    return __real_psoc6_smif_write(fap, addr, data, len);
+}
+
+/******************************************************************************
+ * Function Name: __wrap_psoc6_smif_erase
+ ******************************************************************************
+ * Summary:
+ *  Replaces psoc6_smif_erase(): drops the lines erased. With
+ *  CY_BOOT_SMIF_ERASE, the range is erased with the coalescing erase of
+ *  ../common/smif_erase.c.
+ *
+ ******************************************************************************/
+int __wrap_psoc6_smif_erase(off_t addr, size_t size)
+{
+    smif_cache_drop((uint32_t)addr, (uint32_t)size);
+
+#ifdef CY_BOOT_SMIF_ERASE
+    return smif_erase(addr, size);
+#else
+    return __real_psoc6_smif_erase(addr, size);
+#endif
+}
+
+/******************************************************************************
+ * Function Name: smif_cache_invalidate
+ ******************************************************************************
+ * Summary:
+ *  Drops all the lines. Call it when the external memory is modified without
+ *  the flash map backend, e.g. by the SMIF driver directly.
+ *
+ ******************************************************************************/
+void smif_cache_invalidate(void)
+{
+    memset(cache_lines, 0, sizeof(cache_lines));
+}
+
+/******************************************************************************
+ * Function Name: smif_cache_get_stats
+ ******************************************************************************
+ * Summary:
+ *  Returns the cache counters.
+ *
+ ******************************************************************************/
+const smif_cache_stats_t *smif_cache_get_stats(void)
+{
+    return &cache_stats;
+}
+
+/******************************************************************************
+ * Function Name: smif_cache_print
+ ******************************************************************************
+ * Summary:
+ *  Prints the cache counters. A read spanning two lines takes two line
+ *  lookups: each line hit is served from RAM, each line fill is one SMIF
+ *  transaction.
+ *
+ ******************************************************************************/
+void smif_cache_print(void)
+{
+    uint32_t lookups = cache_stats.hits + cache_stats.misses;
+
+    BOOT_LOG_INF("SMIF cache: %u reads, %u line hits (%u%%), %u line fills, %u bypassed",
+            (unsigned int)cache_stats.reads, (unsigned int)cache_stats.hits,
+            (unsigned int)((lookups != 0U) ? ((cache_stats.hits * 100UL) / lookups) : 0U),
+            (unsigned int)cache_stats.misses, (unsigned int)cache_stats.bypassed);
+}
+
+#endif /* CY_BOOT_SMIF_CACHE */
+
+/* [] END OF FILE */
@@ -0,0 +1,65 @@
+/******************************************************************************
+ * File Name: smif_cache.h
+ *
+ * Description: This file contains the declarations of the read cache of the
+ * external memory used by the flash map backend of MCUboot.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_SMIF_CACHE_H_
+#define SOURCE_SMIF_CACHE_H_
+
+#include <stdint.h>
+
+/* Size of a cache line. Reads larger than a line bypass the cache. */
+#define SMIF_CACHE_LINE_SIZE        (256UL)
+
+/* Number of cache lines. */
+#ifndef CY_BOOT_SMIF_CACHE_LINES
+#define CY_BOOT_SMIF_CACHE_LINES    (4U)
+#endif
+
+/* Cache counters, since reset. */
+typedef struct
+{
+    uint32_t reads;         /* Reads served through the cache. */
+    uint32_t hits;          /* Line lookups found in the cache. */
+    uint32_t misses;        /* Line fills, one SMIF read each. */
+    uint32_t bypassed;      /* Reads larger than a line. */
+    uint32_t invalidated;   /* Lines dropped by a write or an erase. */
+} smif_cache_stats_t;
+
+void smif_cache_invalidate(void);
+const smif_cache_stats_t *smif_cache_get_stats(void);
+void smif_cache_print(void);
+
+#endif /* SOURCE_SMIF_CACHE_H_ */
@@ -0,0 +1,287 @@
+/******************************************************************************
+ * File Name: trial_boot.c
+ *
+ * Description: This file contains the trial boot. The boots of an image
+ * installed by a test upgrade are counted in the boot store until the
+ * application confirms the image in its trailer; the caller rolls the image
+ * back once CY_BOOT_TRIAL_ATTEMPTS boots went unconfirmed.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+/* Standard headers. */
+#include <string.h>
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/* MCUboot header files. */
+#include "bootutil/image.h"
+#include "bootutil/bootutil.h"
+#include "bootutil/bootutil_log.h"
+#include "bootutil_priv.h"
+
+/*  Flash access headers. */
+#include "flash_map_backend/flash_map_backend.h"
+#include "sysflash.h"
+
+/* Local headers. */
+#include "trial_boot.h"
+#include "boot_store.h"
+#include "crc32.h"
+#include "image_info.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Error returned when the image trailer can't be prepared. */
+#define TRIAL_BOOT_RSLT_ERR_TRAILER     (1UL)
+
+/* Round an offset down to a row boundary. */
+#define ROW_ALIGN_DOWN(x)               ((x) & ~(CY_FLASH_SIZEOF_ROW - 1UL))
+
+/*******************************************************************************
+* Data structures
+********************************************************************************/
+/* Identity of an image: its size and the CRC-32 of its TLV area, which holds
+ * the image hash and signature.
+ */
+typedef struct
+{
+    uint32_t length;
+    uint32_t tlv_crc;
+} trial_boot_id_t;
+
+/* Trial record, kept in the boot store while an image is on trial. */
+typedef struct
+{
+    uint32_t magic;
+    trial_boot_id_t id;             /* Image on trial. */
+    uint32_t attempts;              /* Boots of the image so far. */
+} trial_boot_rec_t;
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Image in primary slot before the upgrade, set by trial_boot_arm(). */
+static trial_boot_id_t trial_old_id;
+static bool trial_armed = false;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static bool trial_boot_get_id(const struct flash_area *fap, trial_boot_id_t *id);
+static cy_rslt_t trial_boot_start(const struct flash_area *fap);
+
+/******************************************************************************
+ * Function Name: trial_boot_get_id
+ ******************************************************************************
+ * Summary:
+ *  Computes the identity of the image in primary slot, read through the
+ *  memory map.
+ *
+ * Parameters:
+ *  fap - Primary slot.
+ *  id  - Filled with the identity of the image.
+ *
+ * Return:
+ *  true if primary slot holds an image.
+ *
+ ******************************************************************************/
+static bool trial_boot_get_id(const struct flash_area *fap, trial_boot_id_t *id)
+{
+    struct image_header hdr;
+    uint32_t tlv_off;
+    bool found;
+
+    memset(id, 0, sizeof(*id));
+
+    found = (image_info_read(fap, &hdr, &id->length) == CY_RSLT_SUCCESS) &&
+            (id->length <= fap->fa_size);
+
+    if (found)
+    {
+        tlv_off = (uint32_t)hdr.ih_hdr_size + hdr.ih_img_size;
+        id->tlv_crc = crc32_calc((const void *)(fap->fa_off + tlv_off), id->length - tlv_off);
+    }
+
+    return found;
+}
+
+/******************************************************************************
+ * Function Name: trial_boot_start
+ ******************************************************************************
+ * Summary:
+ *  Prepares the image trailer of primary slot for the confirmation of a new
+ *  image: the trailer is erased and the magic is written, so that
+ *  boot_set_confirmed() called by the application sets the "image ok" flag.
+ *  With MCUBOOT_OVERWRITE_ONLY, MCUboot leaves the trailer of primary slot
+ *  as is after an upgrade.
+ *
+ * Parameters:
+ *  fap - Primary slot.
+ *
+ * Return:
+ *  Status of the operation.
+ *
+ ******************************************************************************/
+static cy_rslt_t trial_boot_start(const struct flash_area *fap)
+{
+    cy_rslt_t result;
+    uint32_t trailer_off;
+
+    trailer_off = ROW_ALIGN_DOWN(fap->fa_size - boot_trailer_sz(flash_area_align(fap)));
+
+    result = flash_area_erase(fap, trailer_off, fap->fa_size - trailer_off);
+
+    if ((result == CY_RSLT_SUCCESS) && (boot_write_magic(fap) != 0))
+    {
+        result = TRIAL_BOOT_RSLT_ERR_TRAILER;
+    }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: trial_boot_arm
+ ******************************************************************************
+ * Summary:
+ *  Called before boot_go() when a test upgrade is pending: records the image
+ *  in primary slot, so that trial_boot_check() starts a trial if boot_go()
+ *  replaced it.
+ *
+ ******************************************************************************/
+void trial_boot_arm(void)
+{
+    const struct flash_area *fap = NULL;
+
+    if (flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fap) == CY_RSLT_SUCCESS)
+    {
+        (void)trial_boot_get_id(fap, &trial_old_id);
+        trial_armed = true;
+        flash_area_close(fap);
+    }
+}
+
+/******************************************************************************
+ * Function Name: trial_boot_check
+ ******************************************************************************
+ * Summary:
+ *  Called once primary slot is validated. Starts the trial of an image
+ *  installed by a test upgrade, and counts the boots of an image on trial
+ *  until the application confirms it. The trial record is cleared when the
+ *  image is confirmed or the trial expires.
+ *
+ * Parameters:
+ *  attempt - Filled with the number of the boot of an image on trial.
+ *
+ * Return:
+ *  State of the image in primary slot.
+ *
+ ******************************************************************************/
+trial_boot_state_t trial_boot_check(uint32_t *attempt)
+{
+    const trial_boot_rec_t *stored = (const trial_boot_rec_t *)boot_store_get(BOOT_STORE_ROW_TRIAL);
+    const struct flash_area *fap = NULL;
+    trial_boot_state_t state = TRIAL_BOOT_NONE;
+    struct boot_swap_state swap_state;
+    trial_boot_rec_t rec = {0};
+
+    *attempt = 0;
+
+    if ((flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fap) != CY_RSLT_SUCCESS) ||
+        !trial_boot_get_id(fap, &rec.id))
+    {
+        /* No image to put on trial. */
+    }
+    else if (trial_armed && (memcmp(&rec.id, &trial_old_id, sizeof(rec.id)) != 0))
+    {
+        /* New image installed by this boot. */
+        BOOT_LOG_INF("New image on trial for %u boots", (unsigned int)CY_BOOT_TRIAL_ATTEMPTS);
+        rec.magic = TRIAL_BOOT_MAGIC;
+        rec.attempts = 1;
+
+        if ((trial_boot_start(fap) == CY_RSLT_SUCCESS) &&
+            (boot_store_write(BOOT_STORE_ROW_TRIAL, &rec, sizeof(rec)) == CY_RSLT_SUCCESS))
+        {
+            state = TRIAL_BOOT_ACTIVE;
+        }
+        else
+        {
+            BOOT_LOG_ERR("Failed to start the trial, image accepted as is");
+        }
+    }
+    else if ((stored->magic != TRIAL_BOOT_MAGIC) ||
+             (memcmp(&rec.id, &stored->id, sizeof(rec.id)) != 0))
+    {
+        /* Image not on trial. */
+    }
+    else if ((boot_read_swap_state_by_id(FLASH_AREA_IMAGE_PRIMARY(0), &swap_state) == 0) &&
+             (swap_state.image_ok == BOOT_FLAG_SET))
+    {
+        BOOT_LOG_INF("Image confirmed after %u boots", (unsigned int)stored->attempts);
+        memset(&rec, 0, sizeof(rec));
+        (void)boot_store_write(BOOT_STORE_ROW_TRIAL, &rec, sizeof(rec));
+        state = TRIAL_BOOT_CONFIRMED;
+    }
+    else if (stored->attempts >= CY_BOOT_TRIAL_ATTEMPTS)
+    {
+        BOOT_LOG_ERR("Image not confirmed after %u boots !", (unsigned int)stored->attempts);
+        memset(&rec, 0, sizeof(rec));
+        (void)boot_store_write(BOOT_STORE_ROW_TRIAL, &rec, sizeof(rec));
+        state = TRIAL_BOOT_EXPIRED;
+    }
+    else
+    {
+        rec.magic = TRIAL_BOOT_MAGIC;
+        rec.attempts = stored->attempts + 1UL;
+
+        /* A boot that can't be counted is still a trial boot. */
+        (void)boot_store_write(BOOT_STORE_ROW_TRIAL, &rec, sizeof(rec));
+        state = TRIAL_BOOT_ACTIVE;
+    }
+
+    if (state == TRIAL_BOOT_ACTIVE)
+    {
+        *attempt = rec.attempts;
+    }
+
+    if (fap != NULL)
+    {
+        flash_area_close(fap);
+    }
+
+    trial_armed = false;
+
+    return state;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,67 @@
+/******************************************************************************
+ * File Name: trial_boot.h
+ *
+ * Description: This file contains declaration of the trial boot: a new image
+ * is booted a bounded number of times until the application confirms it
+ * (boot_set_confirmed()), and rolled back without user action otherwise.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SOURCE_TRIAL_BOOT_H_
+#define SOURCE_TRIAL_BOOT_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+
+/* Number of boots of an image on trial without confirmation by the
+ * application. The image is rolled back on the next boot.
+ */
+#ifndef CY_BOOT_TRIAL_ATTEMPTS
+#define CY_BOOT_TRIAL_ATTEMPTS          (3UL)
+#endif
+
+/* Trial boot record magic: "TRL1". */
+#define TRIAL_BOOT_MAGIC                (0x314C5254UL)
+
+/* State of the image in primary slot, returned by trial_boot_check(). */
+typedef enum
+{
+    TRIAL_BOOT_NONE,                /* Image not on trial. */
+    TRIAL_BOOT_ACTIVE,              /* Image on trial, this boot counted. */
+    TRIAL_BOOT_CONFIRMED,           /* Image confirmed by the application. */
+    TRIAL_BOOT_EXPIRED              /* Image not confirmed in time. */
+} trial_boot_state_t;
+
+void trial_boot_arm(void);
+trial_boot_state_t trial_boot_check(uint32_t *attempt);
+
+#endif /* SOURCE_TRIAL_BOOT_H_ */
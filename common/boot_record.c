@@ -0,0 +1,120 @@
+/******************************************************************************
+ * File Name: boot_record.c
+ *
+ * Description: This file implements the access to the boot record written by
+ * the bootloader, for the CM4 applications.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <stdio.h>
+
+/* Local headers. */
+#include "boot_record.h"
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Stage names, in the order of boot_stage_t. */
+static const char *const boot_stage_names[BOOT_STAGE_COUNT] =
+{
+    "init_cycfg_all",
+    "retarget_io_init",
+    "qspi_init",
+    "boot_go",
+    "transfer_factory_image",
+    "cm4_boot_delay",
+    "deinit_hw",
+};
+
+/******************************************************************************
+ * Function Name: boot_record_get
+ ******************************************************************************
+ * Summary:
+ *  Returns the boot record written by the bootloader.
+ *
+ * Return:
+ *  Pointer to the boot record, or NULL if no valid record is found.
+ *
+ ******************************************************************************/
+const boot_record_t *boot_record_get(void)
+{
+    const boot_record_t *record = (const boot_record_t *)BOOT_RECORD_ADDR;
+
+    if ((record->magic != BOOT_RECORD_MAGIC) ||
+        (record->version != BOOT_RECORD_VERSION) ||
+        (record->size != sizeof(boot_record_t)))
+    {
+        record = NULL;
+    }
+
+    return record;
+}
+
+/******************************************************************************
+ * Function Name: boot_record_print
+ ******************************************************************************
+ * Summary:
+ *  Prints the boot timings recorded by the bootloader, and the row counts
+ *  of the rollback, if any.
+ *
+ ******************************************************************************/
+void boot_record_print(void)
+{
+    const boot_record_t *record = boot_record_get();
+    uint32_t stage;
+
+    if (record == NULL)
+    {
+        printf("No boot record found.\r\n");
+        return;
+    }
+
+    printf("Bootloader: %lu us from reset to CM4 start (flags 0x%02lx)\r\n",
+            (unsigned long)record->total_us, (unsigned long)record->flags);
+
+    for (stage = 0; stage < (uint32_t)BOOT_STAGE_COUNT; stage++)
+    {
+        printf("  %-24s %10lu us\r\n", boot_stage_names[stage],
+                (unsigned long)record->stage_us[stage]);
+    }
+
+    if ((record->flags & BOOT_RECORD_FLAG_ROLLBACK) != 0UL)
+    {
+        printf("  Rollback rows: %lu programmed, %lu blank, %lu unchanged\r\n",
+                (unsigned long)record->rows_programmed, (unsigned long)record->rows_blank,
+                (unsigned long)record->rows_unchanged);
+    }
+}
+
+/* [] END OF FILE */
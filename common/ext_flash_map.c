@@ -41,25 +41,16 @@
 /* header file for flash configuration */
 #include "flash_map_backend/flash_map_backend.h"
 #include "sysflash.h"
+#include "ext_flash_map.h"
 
 /*******************************************************************************
 * Macros
 ********************************************************************************/
-/* All the macros defined here are originated from cy_flash_map.c in MCUBoot.
- * Please refer that file more details.
+/* All the layout macros used here (see ext_flash_map.h) are originated from
+ * cy_flash_map.c in MCUBoot. Please refer that file more details.
  */
 #if defined(CY_FLASH_MAP_EXT_DESC)
 
-/* Bootloader start address. */
-#ifndef CY_BOOTLOADER_START_ADDRESS
-#define CY_BOOTLOADER_START_ADDRESS        (0x10000000)
-#endif
-
-/* Default size of the factory application : 1.75MB. */
-#ifndef CY_FACT_APP_SIZE
-#define CY_FACT_APP_SIZE                   (0x1C0000)
-#endif
-
 /* External flash map definition. */
 static struct flash_area bootloader =
 {
@@ -102,10 +93,17 @@ static struct flash_area primary_2 =
 {
     .fa_id = FLASH_AREA_IMAGE_PRIMARY(1),
     .fa_device_id = FLASH_DEVICE_INTERNAL_FLASH,
+#ifndef CY_BOOT_USE_EXTERNAL_FLASH
     .fa_off = CY_FLASH_BASE +\
                 CY_BOOT_BOOTLOADER_SIZE +\
                 CY_BOOT_PRIMARY_1_SIZE +\
                 CY_BOOT_SECONDARY_1_SIZE,
+#else
+    /* Secondary slots in external memory: follows primary slot of image 1. */
+    .fa_off = CY_FLASH_BASE +\
+                CY_BOOT_BOOTLOADER_SIZE +\
+                CY_BOOT_PRIMARY_1_SIZE,
+#endif
     .fa_size = CY_BOOT_PRIMARY_2_SIZE
 };
 
@@ -127,6 +125,31 @@ static struct flash_area secondary_2 =
 };
 #endif
 
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+static struct flash_area rollback_journal =
+{
+    .fa_id = FLASH_AREA_ROLLBACK_JOURNAL,
+    .fa_device_id = FLASH_DEVICE_EXTERNAL_FLASH(CY_BOOT_EXTERNAL_DEVICE_INDEX),
+#if (MCUBOOT_IMAGE_NUMBER == 1) /* if single-image */
+    .fa_off = (CY_SMIF_BASE_MEM_OFFSET + CY_FACT_APP_SIZE + CY_BOOT_SECONDARY_1_SIZE),
+#elif (MCUBOOT_IMAGE_NUMBER == 2) /* if dual-image */
+    .fa_off = (CY_SMIF_BASE_MEM_OFFSET + CY_FACT_APP_SIZE + CY_BOOT_PRIMARY_1_SIZE +\
+                CY_BOOT_SECONDARY_2_SIZE),
+#endif
+    .fa_size = CY_ROLLBACK_JOURNAL_SIZE
+};
+
+#ifdef CY_BOOT_LKG_SLOT
+static struct flash_area lkg_slot =
+{
+    .fa_id = FLASH_AREA_LKG_SLOT,
+    .fa_device_id = FLASH_DEVICE_EXTERNAL_FLASH(CY_BOOT_EXTERNAL_DEVICE_INDEX),
+    .fa_off = (CY_SMIF_BASE_MEM_OFFSET + CY_BOOT_LKG_OFFSET),
+    .fa_size = CY_BOOT_PRIMARY_1_SIZE
+};
+#endif
+#endif
+
 #ifdef MCUBOOT_SWAP_USING_SCRATCH
 static struct flash_area scratch =
 {
@@ -160,9 +183,91 @@ struct flash_area *boot_area_descs[] =
 #endif
 #ifdef MCUBOOT_SWAP_USING_SCRATCH
     &scratch,
+#endif
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    &rollback_journal,
+#ifdef CY_BOOT_LKG_SLOT
+    &lkg_slot,
+#endif
 #endif
     NULL
 };
 
+#ifdef CY_BOOT_SWAP_MOVE
+#if ((CY_BOOT_PRIMARY_1_SIZE % CY_BOOT_SWAP_SECTOR_SIZE) != 0) || \
+    ((CY_BOOT_SECONDARY_1_SIZE % CY_BOOT_SWAP_SECTOR_SIZE) != 0)
+#error "Image slot sizes must be multiples of CY_BOOT_SWAP_SECTOR_SIZE"
+#endif
+#if (MCUBOOT_IMAGE_NUMBER == 2) && \
+    (((CY_BOOT_PRIMARY_2_SIZE % CY_BOOT_SWAP_SECTOR_SIZE) != 0) || \
+     ((CY_BOOT_SECONDARY_2_SIZE % CY_BOOT_SWAP_SECTOR_SIZE) != 0))
+#error "Image slot sizes must be multiples of CY_BOOT_SWAP_SECTOR_SIZE"
+#endif
+
+int __real_flash_area_get_sectors(int fa_id, uint32_t *count, struct flash_sector *sectors);
+
+/*******************************************************************************
+* Function Name: __wrap_flash_area_get_sectors
+********************************************************************************
+* Summary:
+*  Replaces flash_area_get_sectors() of the flash map backend at link time
+*  (--wrap) for swap-using-move. The image slots are reported as sectors of
+*  CY_BOOT_SWAP_SECTOR_SIZE bytes in both memories, so that MCUboot swaps
+*  them sector by sector and never erases a part of an external memory
+*  sector. Other flash areas are left to the flash map backend.
+*
+* Parameters:
+*  fa_id   - Flash area ID.
+*  count   - In: capacity of "sectors". Out: number of sectors.
+*  sectors - Filled with the sectors of the flash area.
+*
+* Return:
+*  0 on success, -1 otherwise.
+*
+*******************************************************************************/
+int __wrap_flash_area_get_sectors(int fa_id, uint32_t *count, struct flash_sector *sectors)
+{
+    int rc;
+    const struct flash_area *fa = NULL;
+    uint32_t num;
+    uint32_t i;
+
+    if ((fa_id != FLASH_AREA_IMAGE_PRIMARY(0)) && (fa_id != FLASH_AREA_IMAGE_SECONDARY(0))
+#if (MCUBOOT_IMAGE_NUMBER == 2) /* if dual-image */
+        && (fa_id != FLASH_AREA_IMAGE_PRIMARY(1)) && (fa_id != FLASH_AREA_IMAGE_SECONDARY(1))
+#endif
+       )
+    {
+        return __real_flash_area_get_sectors(fa_id, count, sectors);
+    }
+
+    rc = flash_area_open((uint8_t)fa_id, &fa);
+
+    if (rc == 0)
+    {
+        num = fa->fa_size / CY_BOOT_SWAP_SECTOR_SIZE;
+
+        if (num > *count)
+        {
+            rc = -1;
+        }
+        else
+        {
+            for (i = 0; i < num; i++)
+            {
+                sectors[i].fs_off = i * CY_BOOT_SWAP_SECTOR_SIZE;
+                sectors[i].fs_size = CY_BOOT_SWAP_SECTOR_SIZE;
+            }
+
+            *count = num;
+        }
+
+        flash_area_close(fa);
+    }
+
+    return rc;
+}
+#endif /* CY_BOOT_SWAP_MOVE */
+
 #endif /* CY_FLASH_MAP_EXT_DESC */
 
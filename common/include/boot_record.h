@@ -0,0 +1,93 @@
+/******************************************************************************
+ * File Name: boot_record.h
+ *
+ * Description: This file contains the layout of the boot record written by the
+ * bootloader to a fixed RAM location before starting CM4. It is shared by the
+ * bootloader and the CM4 applications.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef BOOT_RECORD_H_
+#define BOOT_RECORD_H_
+
+#include <stdint.h>
+
+/* Address and size of the RAM area holding the boot record. The area is
+ * reserved at the start of the bootloader RAM ("boot_shared" region of the
+ * bootloader linker script), which is not used by the CM4 apps.
+ */
+#define BOOT_RECORD_ADDR                   (0x08000000UL)
+#define BOOT_RECORD_AREA_SIZE              (0x100UL)
+
+/* Boot record magic: "BREC". */
+#define BOOT_RECORD_MAGIC                  (0x43455242UL)
+
+/* Boot record layout version. */
+#define BOOT_RECORD_VERSION                (4U)
+
+/* Boot flags. */
+#define BOOT_RECORD_FLAG_ROLLBACK          (1UL << 0)  /* Factory app was copied. */
+#define BOOT_RECORD_FLAG_SFDP_CACHED       (1UL << 1)  /* SFDP cache was used. */
+#define BOOT_RECORD_FLAG_FUSED_VERIFY      (1UL << 3)  /* Image verified during copy. */
+#define BOOT_RECORD_FLAG_TRIAL             (1UL << 5)  /* Image on trial, WDT running. */
+
+/* Bootloader stages timed in the boot record. */
+typedef enum
+{
+    BOOT_STAGE_INIT_CYCFG,          /* init_cycfg_all() */
+    BOOT_STAGE_RETARGET_IO,         /* cy_retarget_io_pdl_init() */
+    BOOT_STAGE_QSPI_INIT,           /* External memory initialization. */
+    BOOT_STAGE_BOOT_GO,             /* boot_go() */
+    BOOT_STAGE_TRANSFER,            /* transfer_factory_image() */
+    BOOT_STAGE_CM4_DELAY,           /* Wait for the console (CM4_BOOT_DELAY_MS). */
+    BOOT_STAGE_DEINIT,              /* Hardware de-initialization in do_boot(). */
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+/* Boot record. Durations are in microseconds. */
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                  /* sizeof(boot_record_t). */
+    uint32_t flags;
+    uint32_t total_us;              /* Reset to CM4 start. */
+    uint32_t stage_us[BOOT_STAGE_COUNT];
+    uint32_t rows_programmed;       /* Internal flash rows programmed by a rollback. */
+    uint32_t rows_blank;            /* Rows left erased: blank in the image. */
+    uint32_t rows_unchanged;        /* Rows already holding the image. */
+} boot_record_t;
+
+const boot_record_t *boot_record_get(void);
+void boot_record_print(void);
+
+#endif /* BOOT_RECORD_H_ */
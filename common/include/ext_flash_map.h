@@ -0,0 +1,118 @@
+/******************************************************************************
+ * File Name: ext_flash_map.h
+ *
+ * Description: This file contains the layout parameters of the custom flash
+ * map used for Rollback using external flash memory. It is shared by the
+ * bootloader and the CM4 applications.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef EXT_FLASH_MAP_H_
+#define EXT_FLASH_MAP_H_
+
+/* Bootloader start address. */
+#ifndef CY_BOOTLOADER_START_ADDRESS
+#define CY_BOOTLOADER_START_ADDRESS        (0x10000000)
+#endif
+
+/* Default size of the factory application : 1.75MB.
+ * Factory application is placed at the beginning of the external memory
+ * i.e. at CY_SMIF_BASE_MEM_OFFSET.
+ */
+#ifndef CY_FACT_APP_SIZE
+#define CY_FACT_APP_SIZE                   (0x1C0000)
+#endif
+
+/* Erase block size of the external memory. Areas that are erased
+ * independently must be aligned to, and sized in multiples of, this value.
+ * Default matches the 256 KB sectors of the S25FL512S on the supported kits.
+ */
+#ifndef CY_EXT_FLASH_ERASE_SIZE
+#define CY_EXT_FLASH_ERASE_SIZE            (0x40000)
+#endif
+
+/* Sector size of the image slots reported to MCUboot with swap-using-move
+ * (CY_BOOT_SWAP_MOVE). Both slots of an image must have the same sectors, and
+ * the secondary slot can't be erased in units smaller than the external
+ * memory erase size. The internal flash is erased by rows, so any multiple
+ * of the row size works for the primary slot.
+ */
+#ifndef CY_BOOT_SWAP_SECTOR_SIZE
+#define CY_BOOT_SWAP_SECTOR_SIZE           (CY_EXT_FLASH_ERASE_SIZE)
+#endif
+
+/* Size of the rollback journal. The journal records the progress of an
+ * in-progress factory app transfer and is placed in external memory right
+ * after the secondary slot(s).
+ */
+#ifndef CY_ROLLBACK_JOURNAL_SIZE
+#define CY_ROLLBACK_JOURNAL_SIZE           (CY_EXT_FLASH_ERASE_SIZE)
+#endif
+
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+/* Size of the factory app of image 2. Default matches its secondary slot. */
+#ifndef CY_FACT_APP_2_SIZE
+#define CY_FACT_APP_2_SIZE                 (CY_BOOT_SECONDARY_2_SIZE)
+#endif
+
+/* Offset of the factory app of image 2 from CY_SMIF_BASE_MEM_OFFSET. It is
+ * placed after the rollback journal, so that the layout of the areas updated
+ * by MCUboot is the same as with a single image.
+ */
+#ifndef CY_FACT_APP_2_OFFSET
+#define CY_FACT_APP_2_OFFSET               (CY_FACT_APP_SIZE + CY_BOOT_PRIMARY_1_SIZE +\
+                                            CY_BOOT_SECONDARY_2_SIZE + CY_ROLLBACK_JOURNAL_SIZE)
+#endif
+#endif
+
+/* Offset of the last-known-good slot (CY_BOOT_LKG_SLOT) from
+ * CY_SMIF_BASE_MEM_OFFSET: after the rollback journal, or after the factory
+ * app of image 2. It holds a copy of the image of primary slot 1.
+ */
+#ifndef CY_BOOT_LKG_OFFSET
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+#define CY_BOOT_LKG_OFFSET                 (CY_FACT_APP_2_OFFSET + CY_FACT_APP_2_SIZE)
+#else
+#define CY_BOOT_LKG_OFFSET                 (CY_FACT_APP_SIZE + CY_BOOT_SECONDARY_1_SIZE +\
+                                            CY_ROLLBACK_JOURNAL_SIZE)
+#endif
+#endif
+
+/* Flash area ID of the rollback journal. Must not clash with the IDs in
+ * sysflash.h.
+ */
+#define FLASH_AREA_ROLLBACK_JOURNAL        (0x10)
+
+/* Flash area ID of the last-known-good slot. */
+#define FLASH_AREA_LKG_SLOT                (0x11)
+
+#endif /* EXT_FLASH_MAP_H_ */
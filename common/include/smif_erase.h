@@ -0,0 +1,73 @@
+/******************************************************************************
+ * File Name: smif_erase.h
+ *
+ * Description: This file contains the interface of the coalescing erase of the
+ * external memory: aligned ranges are erased with the largest erase types
+ * advertised by SFDP.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef SMIF_ERASE_H_
+#define SMIF_ERASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include "cy_result.h"
+
+/* Number of erase types of the JEDEC Basic Flash Parameter Table. */
+#define SMIF_ERASE_MAX_TYPES        (4UL)
+
+/* Erase command of the external memory. */
+typedef struct
+{
+    uint32_t size;              /* Bytes erased, a power of 2. */
+    uint32_t max_time_ms;       /* Maximum erase time. */
+    uint8_t cmd;                /* Opcode, for the address width in use. */
+} smif_erase_type_t;
+
+/* Erase types usable on the whole memory, largest first. */
+typedef struct
+{
+    uint32_t count;
+    smif_erase_type_t types[SMIF_ERASE_MAX_TYPES];
+} smif_erase_table_t;
+
+cy_rslt_t smif_erase_build_table(const uint32_t *bfpt, uint32_t bfpt_dwords,
+                                 const uint32_t *fbait, uint32_t fbait_dwords,
+                                 uint32_t addr_bytes, uint32_t min_size,
+                                 smif_erase_table_t *table);
+const smif_erase_type_t *smif_erase_next(const smif_erase_table_t *table,
+                                         uint32_t addr, uint32_t len);
+int smif_erase(off_t addr, size_t size);
+
+#endif /* SMIF_ERASE_H_ */
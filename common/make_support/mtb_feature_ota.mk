@@ -123,8 +123,15 @@ ifneq ($(CY_TFM_PSA_SUPPORTED),1)
 CY_AFR_MCUBOOT_SCRIPT_FILE_DIR=$(CY_AFR_OTA_DIR)/scripts
 CY_AFR_MCUBOOT_KEY_DIR=$(CY_AFR_MCUBOOT_DIR)/keys
 CY_AFR_SIGN_SCRIPT_FILE_PATH=$(CY_AFR_MCUBOOT_SCRIPT_FILE_DIR)/sign_script.bash
+# EN_SIGN_EC256 (shared_config.mk) signs the image for a bootloader built
+# with MCUBOOT_SIGN_EC256.
+ifeq ($(EN_SIGN_EC256),1)
+IMGTOOL_COMMAND_ARG=sign
+CY_SIGNING_KEY_ARG="-k $(MCUBOOT_KEY_FILE)"
+else
 IMGTOOL_COMMAND_ARG=create
 CY_SIGNING_KEY_ARG=" "
+endif
 else
 CY_AFR_MCUBOOT_SCRIPT_FILE_DIR=$(CY_EXTAPP_PATH)/psoc6/psoc64tfm/security
 CY_AFR_MCUBOOT_KEY_DIR=$(CY_AFR_MCUBOOT_SCRIPT_FILE_DIR)/keys
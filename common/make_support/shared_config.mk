@@ -55,5 +55,45 @@ MCUBOOT_HEADER_SIZE=0x400
 # Define MCUBoot specific parameters for flash layout.
 # One slot = MCUboot Header + App + TLV + Trailer (Trailer is not present for BOOT image).
 #
+# Number of images updated by MCUboot: 1 or 2.
+# With 2 images, the internal flash is shared by the primary slots of both
+# images. Image 1 is the CM4 app, image 2 is an additional image (e.g. a
+# coprocessor firmware) with its own slots and factory image.
+MCUBOOT_IMAGE_NUMBER?=1
+
+ifeq ($(MCUBOOT_IMAGE_NUMBER),2)
+MCUBOOT_SLOT_SIZE=0x180000          # Slot sizes of image 1, 1.5MB max app size.
+MCUBOOT_SLOT_2_SIZE=0x40000         # Slot sizes of image 2, 256KB max image size.
+else ifeq ($(MCUBOOT_IMAGE_NUMBER),1)
 MCUBOOT_SLOT_SIZE=0x1C0000          # Defines the MCUBoot slot sizes (slot1 and Slot-2), 1.75MB max app size.
-MAX_IMG_SECTORS=3584                # MCUBOOT_SLOT_SIZE/FLASH_SECTOR_SIZE 
\ No newline at end of file
+else
+$(error MCUBOOT_IMAGE_NUMBER must be 1 or 2)
+endif
+
+# MCUboot upgrade mode. Shared by the bootloader and the signing of the CM4
+# apps, as the size of the image trailer depends on it.
+#
+# OVERWRITE -- the image in the secondary slot overwrites the primary slot.
+# SWAP_MOVE -- the slots are swapped without a scratch area, and the previous
+#              image is restored if the new one is not confirmed. Both slots
+#              are handled in sectors of the external memory erase size
+#              (CY_EXT_FLASH_ERASE_SIZE): the image must leave the last two
+#              sectors of the slot free, i.e. 0x140000 bytes max.
+MCUBOOT_UPGRADE_MODE?=OVERWRITE
+
+ifeq ($(MCUBOOT_UPGRADE_MODE),SWAP_MOVE)
+MAX_IMG_SECTORS=7                   # MCUBOOT_SLOT_SIZE/CY_EXT_FLASH_ERASE_SIZE
+else ifeq ($(MCUBOOT_UPGRADE_MODE),OVERWRITE)
+MAX_IMG_SECTORS=3584                # MCUBOOT_SLOT_SIZE/FLASH_SECTOR_SIZE 
+else
+$(error MCUBOOT_UPGRADE_MODE must be OVERWRITE or SWAP_MOVE)
+endif
+
+# Image signing. Shared by the bootloader, which verifies the ECDSA P-256
+# signature of the images (MCUBOOT_SIGN_EC256), and the signing of the CM4
+# apps with MCUBOOT_KEY_FILE. The bootloader checks the signatures with the
+# public key compiled in MCUBootApp/keys.c of the MCUboot library, which
+# matches the MCUboot test key cypress-test-ec-p256.pem. To use your own key
+# pair, set MCUBOOT_KEY_FILE and regenerate keys.c with "imgtool.py getpub".
+EN_SIGN_EC256?=0
+MCUBOOT_KEY_FILE?=$(CY_AFR_MCUBOOT_DIR)/keys/cypress-test-ec-p256.pem
@@ -0,0 +1,215 @@
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#     http://www.apache.org/licenses/LICENSE-2.0
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+#
+# Generates a delta image: the difference between the signed image running on
+# the kit (old) and a new signed image, in the format expanded by the
+# bootloader (bootloader_cm0p/source/delta_patch.c). The delta image is sent
+# through OTA instead of the new image.
+#
+# Format: an 84-byte header (magic, sizes, SHA-256 of both images, CRC-32)
+# followed by a patch compressed with the container of factory_compress.py.
+# The patch is a sequence of bsdiff-style records:
+#
+#   add_len (u32), extra_len (u32), seek (s32)
+#   add_len bytes:   new[i] = old[old_pos + i] + diff[i] (mod 256)
+#   extra_len bytes: inserted as is
+#   old_pos += add_len + seek
+#
+# Usage:
+#   python delta_patch.py <old.bin> <new.bin> <out.bin> [--verify]
+#
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+import factory_compress
+
+MAGIC = 0x31544C44          # "DLT1"
+HDR_FMT = '<IIII32s32s'     # Followed by the CRC-32.
+WINDOW = 4096               # LZ_STREAM_WINDOW_SIZE of the bootloader.
+IMAGE_MAGIC = 0x96f3b83d
+TLV_INFO_MAGIC = 0x6907
+TLV_PROT_INFO_MAGIC = 0x6908
+
+SEED_LEN = 8                # Length of the exact match starting a region.
+SCORE_WINDOW = 16           # Approximate extension: bytes considered...
+SCORE_MIN = 8               # ...and matching bytes required among them.
+
+
+def image_length(data):
+    """Length of an MCUboot image (header + payload + TLVs), without padding."""
+    if len(data) < 32 or struct.unpack_from('<I', data)[0] != IMAGE_MAGIC:
+        return len(data)
+    hdr_size, _, img_size = struct.unpack_from('<HHI', data, 8)
+    off = hdr_size + img_size
+    for magic in (TLV_PROT_INFO_MAGIC, TLV_INFO_MAGIC):
+        if off + 4 <= len(data):
+            tlv_magic, tlv_tot = struct.unpack_from('<HH', data, off)
+            if tlv_magic == magic:
+                off += tlv_tot
+    return min(off, len(data))
+
+
+def extend(old, new, pos, delta):
+    """Extends a region of 'new' aligned with 'old' at offset 'delta',
+    tolerating scattered differences. Returns the end of the region."""
+    end = pos
+    score = 0
+    hist = []
+    i = pos
+    while i < len(new) and 0 <= i + delta < len(old):
+        same = old[i + delta] == new[i]
+        hist.append(same)
+        score += same
+        if len(hist) > SCORE_WINDOW:
+            score -= hist[-SCORE_WINDOW - 1]
+        if len(hist) >= SCORE_WINDOW and score < SCORE_MIN:
+            break
+        if same:
+            end = i + 1
+        i += 1
+    return end
+
+
+def diff(old, new):
+    """Returns the aligned regions (start, end, delta) of 'new'."""
+    index = {}
+    for i in range(len(old) - SEED_LEN, -1, -1):
+        index[old[i:i + SEED_LEN]] = i
+
+    regions = []
+    delta = None
+    pos = 0
+    while pos < len(new) - SEED_LEN:
+        seed = new[pos:pos + SEED_LEN]
+        # Prefer the current alignment, then any exact match.
+        if delta is not None and old[pos + delta:pos + delta + SEED_LEN] == seed:
+            cand = delta
+        elif seed in index:
+            cand = index[seed] - pos
+        else:
+            pos += 1
+            continue
+        start = pos
+        while start > (regions[-1][1] if regions else 0) and start + cand > 0 and \
+                old[start + cand - 1] == new[start - 1]:
+            start -= 1
+        end = extend(old, new, pos, cand)
+        regions.append((start, end, cand))
+        delta = cand
+        pos = end
+    return regions
+
+
+def make_patch(old, new):
+    regions = diff(old, new)
+    out = bytearray()
+    old_pos = 0
+    new_pos = 0
+
+    # Leading bytes not covered by a region.
+    if not regions or regions[0][0] > 0:
+        first = regions[0][0] if regions else len(new)
+        seek = (regions[0][0] + regions[0][2]) if regions else 0
+        out += struct.pack('<IIi', 0, first, seek)
+        out += new[:first]
+        old_pos, new_pos = seek, first
+
+    for n, (start, end, delta) in enumerate(regions):
+        assert start == new_pos and start + delta == old_pos
+        nxt = regions[n + 1] if n + 1 < len(regions) else None
+        extra_end = nxt[0] if nxt else len(new)
+        seek = (nxt[0] + nxt[2] - (end + delta)) if nxt else 0
+        out += struct.pack('<IIi', end - start, extra_end - end, seek)
+        out += bytes((new[i] - old[i + delta]) & 0xFF for i in range(start, end))
+        out += new[end:extra_end]
+        old_pos = end + delta + seek
+        new_pos = extra_end
+    return bytes(out)
+
+
+def apply_patch(old, patch, new_size):
+    """Reference decoder, mirrors delta_patch.c."""
+    out = bytearray()
+    pos = 0
+    old_pos = 0
+    while len(out) < new_size:
+        add_len, extra_len, seek = struct.unpack_from('<IIi', patch, pos)
+        pos += 12
+        if add_len + extra_len == 0 or len(out) + add_len + extra_len > new_size or \
+                old_pos + add_len > len(old):
+            raise ValueError('invalid record at {}'.format(pos - 12))
+        out += bytes((patch[pos + i] + old[old_pos + i]) & 0xFF for i in range(add_len))
+        pos += add_len
+        out += patch[pos:pos + extra_len]
+        pos += extra_len
+        old_pos += add_len + seek
+        if not 0 <= old_pos <= len(old):
+            raise ValueError('invalid seek at {}'.format(pos))
+    return bytes(out)
+
+
+def make_delta(old, new):
+    old = old[:image_length(old)]
+    new = new[:image_length(new)]
+    patch = make_patch(old, new)
+    comp = factory_compress.compress(patch, WINDOW)
+    lz = struct.pack('<IIII', factory_compress.MAGIC, len(comp), len(patch), WINDOW) + comp
+    hdr = struct.pack(HDR_FMT, MAGIC, len(lz), len(old), len(new),
+                      hashlib.sha256(old).digest(), hashlib.sha256(new).digest())
+    crc = zlib.crc32(lz, zlib.crc32(hdr)) & 0xFFFFFFFF
+    return hdr + struct.pack('<I', crc) + lz, old, new
+
+
+def verify_delta(delta, old, new):
+    hdr_len = struct.calcsize(HDR_FMT) + 4
+    lz = delta[hdr_len:]
+    _, comp_size, patch_size, window = struct.unpack_from('<IIII', lz)
+    patch = factory_compress.decompress(lz[16:16 + comp_size], patch_size, window)
+    return apply_patch(old, patch, len(new)) == new
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate a delta image for the bootloader')
+    parser.add_argument('old', help='signed image running on the kit (.bin)')
+    parser.add_argument('new', help='new signed image (.bin)')
+    parser.add_argument('output', help='delta image (.bin), sent through OTA')
+    parser.add_argument('--verify', action='store_true',
+                        help='expand the result and compare it with the new image')
+    args = parser.parse_args()
+
+    with open(args.old, 'rb') as f:
+        old = f.read()
+    with open(args.new, 'rb') as f:
+        new = f.read()
+
+    for path, data in ((args.old, old), (args.new, new)):
+        if len(data) < 4 or struct.unpack_from('<I', data)[0] != IMAGE_MAGIC:
+            print('warning: {} does not start with an MCUboot image header'.format(path))
+
+    delta, old, new = make_delta(old, new)
+
+    if args.verify:
+        if not verify_delta(delta, old, new):
+            sys.exit('round-trip verification failed')
+        print('round-trip verification passed')
+
+    with open(args.output, 'wb') as f:
+        f.write(delta)
+
+    print('{}: {} -> {} bytes ({:.1f}x smaller)'.format(args.output, len(new), len(delta),
+                                                       float(len(new)) / max(len(delta), 1)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,210 @@
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#     http://www.apache.org/licenses/LICENSE-2.0
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+#
+# Generates the precomputed ECDSA P-256 data of the bootloader
+# (bootloader_cm0p/source/ec_precomp.c):
+#
+#   key  - the image signing public key(s), decoded into the mbedTLS point
+#          representation (32-bit limbs), with the key hash matched against
+#          the IMAGE_TLV_KEYHASH TLV of the images. Run by the bootloader
+#          build when EN_EC_PRECOMP=1.
+#   comb - the comb table used by mbedTLS for multiplying the P-256 base
+#          point (bootloader_cm0p/source/ec_p256_comb.c). It only depends on
+#          the curve, so the generated file is part of the sources.
+#
+# Usage:
+#   python ec_precomp.py key <key.pem> [<key2.pem> ...] -o ec_key_data.c
+#   python ec_precomp.py comb -o ec_p256_comb.c
+#
+
+import argparse
+import base64
+import hashlib
+import re
+import sys
+
+# NIST P-256 domain parameters.
+P = 0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff
+A = P - 3
+B = 0x5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b
+GX = 0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296
+GY = 0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5
+NBITS = 256
+
+# Comb parameters used by mbedTLS for the base point: window of 4 bits for a
+# 256-bit curve, plus one with MBEDTLS_ECP_FIXED_POINT_OPTIM (ecp_pick_window).
+COMB_W = 5
+COMB_D = (NBITS + COMB_W - 1) // COMB_W
+COMB_SIZE = 1 << (COMB_W - 1)
+
+LIMB_BITS = 32
+LIMBS = NBITS // LIMB_BITS
+
+# DER prefix of a P-256 SubjectPublicKeyInfo, as stored in MCUboot keys.c.
+SPKI_PREFIX = bytes.fromhex('3059301306072a8648ce3d020106082a8648ce3d030107034200')
+
+HEADER = '''/******************************************************************************
+ * File Name: {name}
+ *
+ * Description: {desc}
+ *
+ * Generated by common/script/ec_precomp.py. Do not edit.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************/
+
+#include "ec_precomp.h"
+'''
+
+
+def inv(x):
+    return pow(x, P - 2, P)
+
+
+def add(p, q):
+    if p is None:
+        return q
+    if q is None:
+        return p
+    if p[0] == q[0]:
+        if (p[1] + q[1]) % P == 0:
+            return None
+        lam = (3 * p[0] * p[0] + A) * inv(2 * p[1]) % P
+    else:
+        lam = (q[1] - p[1]) * inv(q[0] - p[0]) % P
+    x = (lam * lam - p[0] - q[0]) % P
+    return (x, (lam * (p[0] - x) - p[1]) % P)
+
+
+def mul(k, p):
+    r = None
+    while k:
+        if k & 1:
+            r = add(r, p)
+        p = add(p, p)
+        k >>= 1
+    return r
+
+
+def on_curve(p):
+    return (p[1] * p[1] - (p[0] * p[0] * p[0] + A * p[0] + B)) % P == 0
+
+
+def limbs(value):
+    words = [(value >> (LIMB_BITS * i)) & 0xffffffff for i in range(LIMBS)]
+    return ', '.join('0x%08xU' % w for w in words)
+
+
+def comb_table():
+    # T[i] = P + i_1 2^d P + ... + i_{w-1} 2^{(w-1)d} P, i = i_{w-1} ... i_1
+    # (ecp_precompute_comb), in affine coordinates.
+    g = (GX, GY)
+    steps = [mul(1 << (COMB_D * l), g) for l in range(1, COMB_W)]
+    table = []
+    for i in range(COMB_SIZE):
+        pt = g
+        for bit in range(COMB_W - 1):
+            if i & (1 << bit):
+                pt = add(pt, steps[bit])
+        assert pt is not None and on_curve(pt)
+        table.append(pt)
+    return table
+
+
+def read_point(path):
+    text = open(path).read()
+    blocks = re.findall(r'-----BEGIN [A-Z ]+-----(.*?)-----END', text, re.S)
+    if not blocks:
+        raise ValueError('%s: no PEM block found' % path)
+    der = base64.b64decode(''.join(blocks[-1].split()))
+    # Uncompressed point: BIT STRING (0x03 0x42 0x00) 0x04 X Y.
+    pos = der.find(b'\x03\x42\x00\x04')
+    if pos < 0:
+        raise ValueError('%s: no uncompressed P-256 public key found' % path)
+    raw = der[pos + 4:pos + 4 + 64]
+    pt = (int.from_bytes(raw[:32], 'big'), int.from_bytes(raw[32:], 'big'))
+    if not on_curve(pt):
+        raise ValueError('%s: public key is not on P-256' % path)
+    return pt
+
+
+def gen_key(paths):
+    out = [HEADER.format(name='ec_key_data.c',
+                         desc='Image signing public keys of the bootloader, decoded.')]
+    out.append('const ec_precomp_key_t ec_precomp_keys[] =\n{')
+    for path in paths:
+        x, y = read_point(path)
+        spki = SPKI_PREFIX + b'\x04' + x.to_bytes(32, 'big') + y.to_bytes(32, 'big')
+        digest = hashlib.sha256(spki).digest()
+        out.append('    /* %s */' % path.replace('\\', '/').split('/')[-1])
+        out.append('    {')
+        out.append('        .key_hash = { %s },' % ', '.join('0x%02x' % b for b in digest))
+        out.append('        .x = { %s },' % limbs(x))
+        out.append('        .y = { %s },' % limbs(y))
+        out.append('    },')
+    out.append('};\n')
+    out.append('const uint32_t ec_precomp_key_count = sizeof(ec_precomp_keys) / sizeof(ec_precomp_keys[0]);\n')
+    out.append('/* [] END OF FILE */\n')
+    return '\n'.join(out)
+
+
+def gen_comb():
+    out = [HEADER.format(name='ec_p256_comb.c',
+                         desc='Comb table of the NIST P-256 base point (w = %d), in the '
+                              'point representation of mbedTLS.' % COMB_W)]
+    out.append('#if !defined(MBEDTLS_ECP_ALT)\n')
+    out.append('static const mbedtls_mpi_uint ec_p256_comb_one[1] = { 1U };\n')
+    out.append('static const mbedtls_mpi_uint ec_p256_comb_xy[EC_P256_COMB_SIZE][2][EC_PRECOMP_LIMBS] =\n{')
+    for x, y in comb_table():
+        out.append('    {')
+        out.append('        { %s },' % limbs(x))
+        out.append('        { %s },' % limbs(y))
+        out.append('    },')
+    out.append('};\n')
+    out.append('#define EC_P256_COMB_MPI(v)     { .s = 1, .n = EC_PRECOMP_LIMBS, .p = (mbedtls_mpi_uint *)(v) }')
+    out.append('#define EC_P256_COMB_ONE        { .s = 1, .n = 1U, .p = (mbedtls_mpi_uint *)ec_p256_comb_one }')
+    out.append('#define EC_P256_COMB_POINT(i)   { .X = EC_P256_COMB_MPI(ec_p256_comb_xy[i][0]), \\')
+    out.append('                                  .Y = EC_P256_COMB_MPI(ec_p256_comb_xy[i][1]), \\')
+    out.append('                                  .Z = EC_P256_COMB_ONE }\n')
+    out.append('const mbedtls_ecp_point ec_p256_comb[EC_P256_COMB_SIZE] =\n{')
+    for i in range(0, COMB_SIZE, 4):
+        out.append('    ' + ' '.join('EC_P256_COMB_POINT(%d),' % j for j in range(i, i + 4)))
+    out.append('};\n')
+    out.append('#endif /* !MBEDTLS_ECP_ALT */\n')
+    out.append('/* [] END OF FILE */\n')
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the precomputed ECDSA P-256 data of the bootloader')
+    parser.add_argument('what', choices=['key', 'comb'])
+    parser.add_argument('keys', nargs='*', help='PEM files holding the signing public keys (key)')
+    parser.add_argument('-o', '--output', required=True, help='C file to write')
+    args = parser.parse_args()
+
+    try:
+        if args.what == 'key':
+            if not args.keys:
+                parser.error('no key file given')
+            text = gen_key(args.keys)
+        else:
+            text = gen_comb()
+    except (IOError, ValueError) as err:
+        print('ec_precomp: %s' % err)
+        return 1
+
+    with open(args.output, 'w') as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,139 @@
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#     http://www.apache.org/licenses/LICENSE-2.0
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+#
+# Generates the image encryption key of the bootloader (ECIES-P256, as used
+# by imgtool --encrypt) from a P-256 private key in PEM format (SEC1 or
+# PKCS#8). The C file holds the private scalar, used by
+# bootloader_cm0p/source/enc_image.c, and its PKCS#8 encoding, used by
+# MCUboot (bootutil_enc_key). Run by the bootloader build when EN_ENC_IMAGES=1.
+# The public key, to be passed to imgtool --encrypt, can be written as well.
+#
+# Usage:
+#   python enc_key.py <enc-priv.pem> -o enc_key_data.c [--pub enc-pub.pem]
+#
+
+import argparse
+import base64
+import re
+import sys
+
+from ec_precomp import GX, GY, SPKI_PREFIX, mul
+
+# Order of the P-256 base point.
+N = 0xffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551
+
+# AlgorithmIdentifier of a P-256 key: id-ecPublicKey, prime256v1.
+EC_ALG_ID = bytes.fromhex('301306072a8648ce3d020106082a8648ce3d030107')
+
+# Start of the ECPrivateKey structure (RFC 5915): version 1, 32-byte key.
+EC_PRIV_PREFIX = bytes.fromhex('0201010420')
+
+HEADER = '''/******************************************************************************
+ * File Name: enc_key_data.c
+ *
+ * Description: Image encryption private key of the bootloader.
+ *
+ * Generated by common/script/enc_key.py. Do not edit.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************/
+
+#include "bootutil/sign_key.h"
+#include "enc_image.h"
+'''
+
+
+def der(tag, body):
+    assert len(body) < 0x80
+    return bytes([tag, len(body)]) + body
+
+
+def read_scalar(path):
+    text = open(path).read()
+    blocks = re.findall(r'-----BEGIN ([A-Z ]*PRIVATE KEY)-----(.*?)-----END', text, re.S)
+    if not blocks:
+        raise ValueError('%s: no private key PEM block found' % path)
+    if blocks[-1][0] not in ('EC PRIVATE KEY', 'PRIVATE KEY'):
+        raise ValueError('%s: unsupported key type %s' % (path, blocks[-1][0]))
+    data = base64.b64decode(''.join(blocks[-1][1].split()))
+    if blocks[-1][0] == 'PRIVATE KEY' and EC_ALG_ID not in data:
+        raise ValueError('%s: not a P-256 key' % path)
+    pos = data.find(EC_PRIV_PREFIX)
+    if pos < 0:
+        raise ValueError('%s: no EC private key found' % path)
+    d = int.from_bytes(data[pos + len(EC_PRIV_PREFIX):pos + len(EC_PRIV_PREFIX) + 32], 'big')
+    if not 0 < d < N:
+        raise ValueError('%s: invalid P-256 private key' % path)
+    return d
+
+
+def pkcs8(d):
+    ec_priv = der(0x30, EC_PRIV_PREFIX + d.to_bytes(32, 'big'))
+    return der(0x30, bytes.fromhex('020100') + EC_ALG_ID + der(0x04, ec_priv))
+
+
+def c_array(data):
+    lines = []
+    for i in range(0, len(data), 12):
+        lines.append('    ' + ', '.join('0x%02x' % b for b in data[i:i + 12]) + ',')
+    return '\n'.join(lines)
+
+
+def gen_c(path, d):
+    out = [HEADER]
+    out.append('/* %s */' % path.replace('\\', '/').split('/')[-1])
+    out.append('const uint8_t enc_image_priv_key[BOOT_EC_P256_SIZE] =\n{')
+    out.append(c_array(d.to_bytes(32, 'big')))
+    out.append('};\n')
+    out.append('/* PKCS#8 encoding of the same key, parsed by MCUboot. */')
+    out.append('static const unsigned char enc_key_der[] =\n{')
+    out.append(c_array(pkcs8(d)))
+    out.append('};\n')
+    out.append('static const unsigned int enc_key_der_len = sizeof(enc_key_der);\n')
+    out.append('const struct bootutil_key bootutil_enc_key =\n{')
+    out.append('    .key = enc_key_der,')
+    out.append('    .len = &enc_key_der_len,')
+    out.append('};\n')
+    out.append('/* [] END OF FILE */\n')
+    return '\n'.join(out)
+
+
+def gen_pub(d):
+    x, y = mul(d, (GX, GY))
+    spki = SPKI_PREFIX + b'\x04' + x.to_bytes(32, 'big') + y.to_bytes(32, 'big')
+    b64 = base64.b64encode(spki).decode()
+    lines = [b64[i:i + 64] for i in range(0, len(b64), 64)]
+    return '-----BEGIN PUBLIC KEY-----\n%s\n-----END PUBLIC KEY-----\n' % '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the image encryption key of the bootloader')
+    parser.add_argument('key', help='PEM file holding the P-256 private key')
+    parser.add_argument('-o', '--output', required=True, help='C file to write')
+    parser.add_argument('--pub', help='PEM file to write the public key to, for imgtool --encrypt')
+    args = parser.parse_args()
+
+    try:
+        d = read_scalar(args.key)
+    except (IOError, ValueError) as err:
+        print('enc_key: %s' % err)
+        return 1
+
+    with open(args.output, 'w') as f:
+        f.write(gen_c(args.key, d))
+    if args.pub:
+        with open(args.pub, 'w') as f:
+            f.write(gen_pub(d))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,126 @@
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#     http://www.apache.org/licenses/LICENSE-2.0
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+#
+# Host simulation of the coalescing erase of common/smif_erase.c. An erase
+# range is split into the largest erase types of the external memory that are
+# aligned and fit in the rest of the range, as smif_erase() does with the erase
+# types read from SFDP. For each erase-type table, reports the erase commands
+# issued for the ranges erased by this code example (secondary slot, rollback
+# journal, image trailer) and, when typical erase times are given, the
+# estimated erase time compared with erasing one smallest type at a time.
+#
+# This is an estimator only: the C code is tested on the host by
+# common/test/smif_erase_test.c.
+#
+# Erase types are given as <size>[:<typical ms>], comma-separated, e.g.
+#   python erase_sim.py --types 4K:45,32K:120,64K:150
+#
+# Usage:
+#   python erase_sim.py [--types ...]
+#
+
+import argparse
+
+SLOT_SIZE = 0x1C0000        # MCUBOOT_SLOT_SIZE
+EXT_ERASE_SIZE = 0x40000    # CY_EXT_FLASH_ERASE_SIZE
+
+# Example erase-type tables (sizes only): uniform sectors of the S25FL512S of
+# the supported kits, and the common layouts of other SPI NOR parts.
+TABLES = {
+    'uniform-256K': '256K',
+    '4K-32K-64K': '4K,32K,64K',
+    '4K-64K': '4K,64K',
+    '4K-64K-256K': '4K,64K,256K',
+}
+
+
+def parse_size(text):
+    text = text.strip().upper()
+    if text.endswith('K'):
+        return int(text[:-1], 0) * 1024
+    if text.endswith('M'):
+        return int(text[:-1], 0) * 1024 * 1024
+    return int(text, 0)
+
+
+def parse_types(text):
+    """smif_erase_build_table(): largest first, one type per size."""
+    types = {}
+    for item in text.split(','):
+        size, _, time_ms = item.partition(':')
+        size = parse_size(size)
+        if size & (size - 1):
+            raise ValueError('erase size 0x%x is not a power of 2' % size)
+        types.setdefault(size, float(time_ms) if time_ms else None)
+    return sorted(types.items(), reverse=True)
+
+
+def plan(types, addr, length):
+    """smif_erase(): list of (address, size) erase commands, or None if the
+    range is left to psoc6_smif_erase()."""
+    min_size = types[-1][0]
+    if len(types) < 2 or (addr | length) & (min_size - 1):
+        return None
+    cmds = []
+    while length:
+        # smif_erase_next(): largest aligned type that fits.
+        size = next(s for s, _ in types if addr % s == 0 and length >= s)
+        cmds.append((addr, size))
+        addr += size
+        length -= size
+    return cmds
+
+
+def report(name, types, ranges):
+    sizes = ','.join('%dK' % (s // 1024) for s, _ in types)
+    print('%s (%s):' % (name, sizes))
+    min_size, min_time = types[-1]
+    for label, addr, length in ranges:
+        cmds = plan(types, addr, length)
+        if cmds is None:
+            print('  %-26s 0x%07x bytes: not coalesced, %d commands of %dK'
+                  % (label, length, length // min_size, min_size // 1024))
+            continue
+        counts = {}
+        for _, size in cmds:
+            counts[size] = counts.get(size, 0) + 1
+        mix = ', '.join('%d x %dK' % (counts[s], s // 1024) for s in sorted(counts, reverse=True))
+        line = '  %-26s 0x%07x bytes: %d commands (%s) instead of %d' % (
+            label, length, len(cmds), mix, length // min_size)
+        if all(t is not None for _, t in types):
+            est = sum(dict(types)[s] for _, s in cmds)
+            base = (length // min_size) * min_time
+            line += ', ~%d ms instead of ~%d ms (x%.1f)' % (est, base, base / est)
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Simulate the coalescing erase of the external memory')
+    parser.add_argument('--types', default=None,
+                        help='erase types <size>[:<typical ms>], comma-separated (default: example tables)')
+    args = parser.parse_args()
+
+    # Ranges erased by this code example: the whole secondary slot by the OTA
+    # agent, the rollback journal, and the image trailer of the slot.
+    ranges = [
+        ('secondary slot', 0x1C0000, SLOT_SIZE),
+        ('rollback journal', 0x1C0000 + SLOT_SIZE, EXT_ERASE_SIZE),
+        ('slot trailer (last sector)', 0x1C0000 + SLOT_SIZE - EXT_ERASE_SIZE, EXT_ERASE_SIZE),
+    ]
+
+    if args.types:
+        report('--types', parse_types(args.types), ranges)
+    else:
+        for name, text in TABLES.items():
+            report(name, parse_types(text), ranges)
+
+
+if __name__ == '__main__':
+    main()
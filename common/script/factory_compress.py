@@ -0,0 +1,191 @@
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#     http://www.apache.org/licenses/LICENSE-2.0
+# or in the "license" file accompanying this file. This file is distributed 
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either 
+# express or implied. See the License for the specific language governing 
+# permissions and limitations under the License.
+#
+# Compresses a signed factory app image (imgtool output, .bin) into the
+# container format decompressed by the bootloader (bootloader_cm0p/source/
+# lz_stream.c): a 16-byte header followed by an LZ4 block stream whose match
+# offsets are limited to the bootloader history window.
+#
+# Usage:
+#   python factory_compress.py <in.bin> <out.bin> [--hex <out.hex>]
+#                              [--addr 0x18000000] [--window 4096] [--verify]
+#
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x345A4C46          # "FLZ4"
+MIN_MATCH = 4
+MAX_OFFSET = 0xFFFF
+LEN_EXT = 15
+IMAGE_MAGIC = 0x96f3b83d    # MCUboot image header magic
+
+
+def _write_len(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def _emit(out, literals, match_len, offset):
+    lit_len = len(literals)
+    token = (min(lit_len, LEN_EXT) << 4)
+    if match_len:
+        token |= min(match_len - MIN_MATCH, LEN_EXT)
+    out.append(token)
+    if lit_len >= LEN_EXT:
+        _write_len(out, lit_len - LEN_EXT)
+    out += literals
+    if match_len:
+        out += struct.pack('<H', offset)
+        if match_len - MIN_MATCH >= LEN_EXT:
+            _write_len(out, match_len - MIN_MATCH - LEN_EXT)
+
+
+def compress(data, window):
+    """Greedy LZ4 block compression with a hash chain limited to 'window'."""
+    out = bytearray()
+    head = {}
+    prev = [0] * len(data)
+    anchor = 0
+    pos = 0
+    end = len(data) - MIN_MATCH
+
+    while pos <= end:
+        key = data[pos:pos + MIN_MATCH]
+        best_len, best_off = 0, 0
+        cand = head.get(key, -1)
+        chain = 16
+        while cand >= 0 and pos - cand <= window and chain:
+            length = MIN_MATCH
+            while pos + length < len(data) and data[cand + length] == data[pos + length]:
+                length += 1
+            if length > best_len:
+                best_len, best_off = length, pos - cand
+            cand = prev[cand]
+            chain -= 1
+
+        prev[pos] = head.get(key, -1)
+        head[key] = pos
+
+        if best_len >= MIN_MATCH:
+            _emit(out, data[anchor:pos], best_len, best_off)
+            for i in range(pos + 1, min(pos + best_len, end + 1)):
+                k = data[i:i + MIN_MATCH]
+                prev[i] = head.get(k, -1)
+                head[k] = i
+            pos += best_len
+            anchor = pos
+        else:
+            pos += 1
+
+    # The last sequence only holds literals.
+    _emit(out, data[anchor:], 0, 0)
+    return bytes(out)
+
+
+def decompress(comp, size, window):
+    """Reference decoder, mirrors lz_stream.c."""
+    out = bytearray()
+    pos = 0
+    while pos < len(comp):
+        token = comp[pos]
+        pos += 1
+        lit = token >> 4
+        if lit == LEN_EXT:
+            while True:
+                b = comp[pos]
+                pos += 1
+                lit += b
+                if b != 255:
+                    break
+        out += comp[pos:pos + lit]
+        pos += lit
+        if pos >= len(comp):
+            break
+        offset = struct.unpack_from('<H', comp, pos)[0]
+        pos += 2
+        mlen = (token & 0x0F) + MIN_MATCH
+        if (token & 0x0F) == LEN_EXT:
+            while True:
+                b = comp[pos]
+                pos += 1
+                mlen += b
+                if b != 255:
+                    break
+        if offset == 0 or offset > window or offset > len(out):
+            raise ValueError('invalid match offset {} at {}'.format(offset, len(out)))
+        for _ in range(mlen):
+            out.append(out[-offset])
+    if len(out) != size:
+        raise ValueError('size mismatch: {} != {}'.format(len(out), size))
+    return bytes(out)
+
+
+def write_hex(path, data, addr):
+    """Writes 'data' at 'addr' as Intel HEX."""
+    def record(rtype, raddr, payload):
+        rec = bytes([len(payload), (raddr >> 8) & 0xFF, raddr & 0xFF, rtype]) + payload
+        return ':' + rec.hex().upper() + '{:02X}'.format((-sum(rec)) & 0xFF) + '\n'
+
+    with open(path, 'w') as f:
+        upper = None
+        for off in range(0, len(data), 16):
+            cur = addr + off
+            if (cur >> 16) != upper:
+                upper = cur >> 16
+                f.write(record(4, 0, struct.pack('>H', upper)))
+            f.write(record(0, cur & 0xFFFF, data[off:off + 16]))
+        f.write(record(1, 0, b''))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compress a factory app image for the bootloader')
+    parser.add_argument('input', help='signed factory app image (.bin)')
+    parser.add_argument('output', help='compressed container (.bin)')
+    parser.add_argument('--hex', help='also write the container as Intel HEX')
+    parser.add_argument('--addr', type=lambda x: int(x, 0), default=0x18000000,
+                        help='load address of the HEX output (default: 0x18000000)')
+    parser.add_argument('--window', type=int, default=4096,
+                        help='history window, must match LZ_STREAM_WINDOW_SIZE (default: 4096)')
+    parser.add_argument('--verify', action='store_true',
+                        help='decompress the result and compare it with the input')
+    args = parser.parse_args()
+
+    if args.window > MAX_OFFSET or args.window & (args.window - 1):
+        sys.exit('window must be a power of two <= 32768')
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    if len(data) < 4 or struct.unpack_from('<I', data)[0] != IMAGE_MAGIC:
+        print('warning: {} does not start with an MCUboot image header'.format(args.input))
+
+    comp = compress(data, args.window)
+    container = struct.pack('<IIII', MAGIC, len(comp), len(data), args.window) + comp
+
+    if args.verify:
+        if decompress(comp, len(data), args.window) != data:
+            sys.exit('round-trip verification failed')
+        print('round-trip verification passed')
+
+    with open(args.output, 'wb') as f:
+        f.write(container)
+    if args.hex:
+        write_hex(args.hex, container, args.addr)
+
+    print('{}: {} -> {} bytes ({:.1f}%)'.format(args.output, len(data), len(container),
+                                               100.0 * len(container) / max(len(data), 1)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,252 @@
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#     http://www.apache.org/licenses/LICENSE-2.0
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+#
+# Prints the flash and RAM used by each module of an application, from the
+# map file written by the GCC linker (e.g. build/<TARGET>/<CONFIG>/
+# bootloader_cm0p.map). Only the input sections kept by the linker are
+# counted.
+#
+# A section is classified by the memory regions of the "Memory Configuration"
+# of the map file that hold it, not by its name: it uses flash if its load
+# address is in a flash region ('flash' by default), and RAM if its run
+# address is in a RAM region (the writable regions by default). Initialized
+# data and RAM functions (.data, .cy_ramfunc) therefore count in both, NOLOAD
+# sections (.bss, .cy_boot_shared, ...) in RAM only. Sections placed in other
+# regions (emulated EEPROM, supervisory flash, eFuse, XIP) are left out unless
+# --flash-regions names them.
+#
+# With several map files (e.g. one per CRYPTO_BACKEND of the bootloader), the
+# module sizes of the builds are printed side by side.
+#
+# Usage:
+#   python size_report.py <app.map> [--objects] [--top 20]
+#                                   [--flash-budget 0x18000] [--ram-budget 0x20000]
+#                                   [--flash-regions flash,em_eeprom] [--ram-regions ram]
+#   python size_report.py <a.map> <b.map> ... [--labels a,b,...]
+#
+
+import argparse
+import collections
+import os
+import re
+import sys
+
+# Module of an object file, from the first matching pattern of its path.
+MODULES = [
+    ('mbedtls',     r'[/\\]mbedtls[/\\]'),
+    ('mbedtls-acc', r'cy-mbedtls-acceleration'),
+    ('tinycrypt',   r'[/\\]tinycrypt[/\\]'),
+    ('mcuboot',     r'[/\\]mcuboot[/\\]'),
+    ('pdl',         r'psoc6pdl'),
+    ('retarget-io', r'retarget-io'),
+    ('bsp',         r'TARGET_CY8C|GeneratedSource'),
+    ('libc',        r'arm-none-eabi|libc_nano|libgcc|libnosys|libc\.a|libm\.a'),
+]
+
+DEFAULT_FLASH_REGIONS = ('flash',)
+
+# A memory region of the "Memory Configuration": "name  0xORIGIN  0xLENGTH  xrw".
+REGION_RE = re.compile(r'^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S+))?\s*$')
+
+# An output section line: ".text  0xADDR  0xSIZE [load address 0xLMA]" (the
+# section name may be on the preceding line when it is long).
+OUTPUT_RE = re.compile(r'^(\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)'
+                       r'(?:\s+load address 0x([0-9a-fA-F]+))?\s*$')
+
+# An input section line: " .text.name  0xADDR  0xSIZE  object" (the section
+# name may be on the preceding line when it is long).
+SECTION_RE = re.compile(r'^\s(\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+
+
+def module_of(obj):
+    for name, pattern in MODULES:
+        if re.search(pattern, obj):
+            return name
+    return 'app'
+
+
+def object_name(obj):
+    # "libfoo.a(bar.o)" or a path to an object file.
+    match = re.search(r'\(([^)]+)\)$', obj)
+    return match.group(1) if match else os.path.basename(obj)
+
+
+def region_of(regions, addr):
+    for name, origin, length, _ in regions:
+        if origin <= addr < origin + length:
+            return name
+    return None
+
+
+def parse_map(path, flash_regions=None, ram_regions=None):
+    sizes = collections.defaultdict(lambda: [0, 0])
+    regions = []
+    pending = None
+    out_pending = False
+    out_addr = out_load = 0
+    in_regions = False
+    in_map = False
+
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip('\n')
+
+            if not in_map:
+                # Collect the memory regions, then skip the discarded input
+                # sections.
+                if line.startswith('Memory Configuration'):
+                    in_regions = True
+                elif line.startswith('Linker script and memory map'):
+                    in_map = True
+                elif in_regions:
+                    match = REGION_RE.match(line)
+                    if match and match.group(1) not in ('Name', '*default*'):
+                        regions.append((match.group(1), int(match.group(2), 16),
+                                        int(match.group(3), 16), match.group(4) or ''))
+                continue
+
+            # Output section: remember its run and load addresses.
+            if re.match(r'^\S+$', line):
+                out_pending = True
+                continue
+
+            match = OUTPUT_RE.match(line)
+            if match and (match.group(1) is not None or out_pending):
+                out_addr = int(match.group(2), 16)
+                out_load = int(match.group(4), 16) if match.group(4) else out_addr
+                out_pending = False
+                pending = None
+                continue
+            out_pending = False
+
+            if re.match(r'^\s\S+$', line):
+                pending = line.strip()
+                continue
+
+            match = SECTION_RE.match(line)
+            if not match:
+                pending = None
+                continue
+
+            section = match.group(1) or pending
+            pending = None
+            addr = int(match.group(2), 16)
+            size = int(match.group(3), 16)
+            obj = match.group(4).strip()
+
+            if section is None or size == 0 or section.startswith('*'):
+                continue
+
+            load_region = region_of(regions, addr - out_addr + out_load)
+            run_region = region_of(regions, addr)
+            flash = load_region in (flash_regions or DEFAULT_FLASH_REGIONS)
+            ram = (run_region in ram_regions) if ram_regions else \
+                any(name == run_region and 'w' in attr for name, _, _, attr in regions)
+
+            if not (flash or ram):
+                continue
+
+            key = (module_of(obj), object_name(obj))
+            sizes[key][0] += size if flash else 0
+            sizes[key][1] += size if ram else 0
+
+    return sizes
+
+
+def print_table(title, rows, top):
+    print('%-32s %10s %10s' % (title, 'flash', 'ram'))
+    for name, (flash, ram) in rows[:top]:
+        print('%-32s %10d %10d' % (name, flash, ram))
+    if len(rows) > top:
+        rest = rows[top:]
+        print('%-32s %10d %10d' % ('(%d more)' % len(rest),
+              sum(r[1][0] for r in rest), sum(r[1][1] for r in rest)))
+    print('')
+
+
+def module_sizes(sizes):
+    modules = collections.defaultdict(lambda: [0, 0])
+    for (module, _), (flash, ram) in sizes.items():
+        modules[module][0] += flash
+        modules[module][1] += ram
+    return modules
+
+
+def compare(maps, labels, flash_regions, ram_regions):
+    builds = [module_sizes(parse_map(path, flash_regions, ram_regions)) for path in maps]
+    names = sorted(set(m for b in builds for m in b),
+                   key=lambda m: max(b[m][0] for b in builds if m in b), reverse=True)
+
+    print('%-16s' % 'flash / ram' + ''.join(' %21s' % label[-21:] for label in labels))
+    for name in names + ['total']:
+        cells = []
+        for build in builds:
+            flash, ram = (sum(s[0] for s in build.values()), sum(s[1] for s in build.values())) \
+                if name == 'total' else build.get(name, (0, 0))
+            cells.append(' %10d %10d' % (flash, ram))
+        print('%-16s' % name + ''.join(cells))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Report the flash and RAM used by each module')
+    parser.add_argument('map', nargs='+', help='linker map file(s) (.map)')
+    parser.add_argument('--labels',
+                        help='comma-separated names of the builds compared (default: map file paths)')
+    parser.add_argument('--objects', action='store_true',
+                        help='also list the object files of each module')
+    parser.add_argument('--top', type=int, default=20,
+                        help='number of object files listed per module')
+    parser.add_argument('--flash-budget', type=lambda x: int(x, 0),
+                        help='flash size of the application, e.g. 0x18000')
+    parser.add_argument('--ram-budget', type=lambda x: int(x, 0),
+                        help='RAM size of the application, e.g. 0x20000')
+    parser.add_argument('--flash-regions', type=lambda x: x.split(','),
+                        help='comma-separated memory regions counted as flash (default: flash)')
+    parser.add_argument('--ram-regions', type=lambda x: x.split(','),
+                        help='comma-separated memory regions counted as RAM (default: writable regions)')
+    args = parser.parse_args()
+
+    if len(args.map) > 1:
+        labels = args.labels.split(',') if args.labels else args.map
+        if len(labels) != len(args.map):
+            parser.error('--labels must name each map file')
+        return compare(args.map, labels, args.flash_regions, args.ram_regions)
+
+    sizes = parse_map(args.map[0], args.flash_regions, args.ram_regions)
+    if not sizes:
+        print('No input sections found in %s' % args.map[0])
+        return 1
+
+    modules = module_sizes(sizes)
+
+    rows = sorted(modules.items(), key=lambda r: r[1][0], reverse=True)
+    print_table('module', rows, len(rows))
+
+    if args.objects:
+        for module, _ in rows:
+            objs = sorted(((obj, s) for (m, obj), s in sizes.items() if m == module),
+                          key=lambda r: r[1][0], reverse=True)
+            print_table(module, objs, args.top)
+
+    total_flash = sum(s[0] for s in modules.values())
+    total_ram = sum(s[1] for s in modules.values())
+    print('%-32s %10d %10d' % ('total', total_flash, total_ram))
+
+    if args.flash_budget:
+        print('flash budget 0x%x: %d bytes free' % (args.flash_budget, args.flash_budget - total_flash))
+    if args.ram_budget:
+        print('ram budget 0x%x: %d bytes free (static data only)' % (args.ram_budget, args.ram_budget - total_ram))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
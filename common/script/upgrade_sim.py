@@ -0,0 +1,269 @@
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#     http://www.apache.org/licenses/LICENSE-2.0
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+#
+# Host simulation of one MCUboot upgrade with the flash layout of this code
+# example: primary slot in internal flash (erased by 512-byte rows), secondary
+# slot in the external memory (erased by CY_EXT_FLASH_ERASE_SIZE sectors).
+# Replays the erase/program sequence of the MCUboot 1.6 upgrade modes and
+# reports the erase and program counts of each memory:
+#
+#   overwrite - MCUBOOT_OVERWRITE_ONLY (MCUBOOT_UPGRADE_MODE=OVERWRITE)
+#   scratch   - MCUBOOT_SWAP_USING_SCRATCH, 512-byte sectors in both slots and
+#               a scratch area in internal flash
+#   move      - MCUBOOT_SWAP_USING_MOVE, sectors of CY_EXT_FLASH_ERASE_SIZE in
+#               both slots (MCUBOOT_UPGRADE_MODE=SWAP_MOVE)
+#
+# An erase request smaller than the erase unit of a memory is counted as an
+# erase of the whole unit, as done by the external memory. Writes of the image
+# trailer (swap status, flags) are counted separately.
+#
+# Usage:
+#   python upgrade_sim.py [--image-size 0x100000] [--mode all]
+#
+
+import argparse
+import sys
+
+ROW_SIZE = 0x200            # Internal flash row.
+EXT_ERASE_SIZE = 0x40000    # CY_EXT_FLASH_ERASE_SIZE
+SLOT_SIZE = 0x1C0000        # MCUBOOT_SLOT_SIZE
+SCRATCH_SIZE = 0x1000       # MCUBOOT_SCRATCH_SIZE
+WRITE_SIZE = 8              # BOOT_MAX_ALIGN, trailer write unit.
+
+# Image trailer of MCUboot 1.6: magic, swap status (3 entries per sector),
+# swap size, swap info, copy done, image ok.
+TRAILER_MAGIC_SIZE = 16
+BOOT_STATUS_STATE_COUNT = 3
+
+
+class Memory(object):
+    """Erase and program counters of a memory with a fixed erase unit."""
+
+    def __init__(self, name, size, erase_unit):
+        self.name = name
+        self.erase_unit = erase_unit
+        self.unit_erases = [0] * ((size + erase_unit - 1) // erase_unit)
+        self.erase_ops = 0
+        self.bytes_programmed = 0
+        self.trailer_writes = 0
+
+    def erase(self, off, length):
+        self.erase_ops += 1
+        first = off // self.erase_unit
+        last = (off + length - 1) // self.erase_unit
+        for unit in range(first, last + 1):
+            self.unit_erases[unit] += 1
+
+    def program(self, length):
+        self.bytes_programmed += length
+
+    def trailer_write(self):
+        self.trailer_writes += 1
+        self.bytes_programmed += WRITE_SIZE
+
+    def units_erased(self):
+        return sum(self.unit_erases)
+
+    def max_unit_erases(self):
+        return max(self.unit_erases) if self.unit_erases else 0
+
+
+class Slot(object):
+    """Image slot: a window of a memory, with the sector size reported to MCUboot."""
+
+    def __init__(self, mem, off, size, sector_size):
+        self.mem = mem
+        self.off = off
+        self.size = size
+        self.sector_size = sector_size
+        self.num_sectors = size // sector_size
+
+    def erase(self, off, length):
+        self.mem.erase(self.off + off, length)
+
+    def program(self, length):
+        self.mem.program(length)
+
+    def trailer_write(self):
+        self.mem.trailer_write()
+
+
+def trailer_size(max_sectors):
+    return (TRAILER_MAGIC_SIZE + BOOT_STATUS_STATE_COUNT * max_sectors * WRITE_SIZE +
+            4 * WRITE_SIZE)
+
+
+def copy(dst, length):
+    """boot_copy_region(): only the programming of the destination is counted."""
+    dst.program(length)
+
+
+def erase_trailer_sectors(slot, max_sectors):
+    size = trailer_size(max_sectors)
+    off = slot.size - slot.sector_size
+    while off >= 0 and size > 0:
+        slot.erase(off, slot.sector_size)
+        size -= slot.sector_size
+        off -= slot.sector_size
+
+
+def layout(sector_size):
+    internal = Memory('internal flash', SLOT_SIZE + SCRATCH_SIZE, ROW_SIZE)
+    external = Memory('external memory', SLOT_SIZE, EXT_ERASE_SIZE)
+    primary = Slot(internal, 0, SLOT_SIZE, sector_size)
+    secondary = Slot(external, 0, SLOT_SIZE, sector_size)
+    scratch = Slot(internal, SLOT_SIZE, SCRATCH_SIZE, ROW_SIZE)
+    return internal, external, primary, secondary, scratch
+
+
+def sim_overwrite(image_size):
+    """loader.c, boot_copy_image() with MCUBOOT_OVERWRITE_ONLY."""
+    internal, external, primary, secondary, _ = layout(ROW_SIZE)
+    primary.erase(0, primary.size)
+    copy(primary, image_size)
+    # Header and trailer of the secondary slot are erased.
+    secondary.erase(0, secondary.sector_size)
+    secondary.erase(secondary.size - secondary.sector_size, secondary.sector_size)
+    return internal, external, None
+
+
+def sim_scratch(image_size, old_size):
+    """swap_scratch.c, swap_run(): chunks of up to SCRATCH_SIZE, from the end."""
+    internal, external, primary, secondary, scratch = layout(ROW_SIZE)
+    max_sectors = primary.num_sectors
+    copy_size = max(image_size, old_size)
+    chunks = (copy_size + SCRATCH_SIZE - 1) // SCRATCH_SIZE
+
+    # Status initialization in the primary trailer.
+    erase_trailer_sectors(primary, max_sectors)
+    for _ in range(4):
+        primary.trailer_write()
+
+    for idx in reversed(range(chunks)):
+        off = idx * SCRATCH_SIZE
+        size = min(SCRATCH_SIZE, primary.size - off)
+        # State 0: secondary -> scratch.
+        scratch.erase(0, scratch.size)
+        copy(scratch, size)
+        primary.trailer_write()
+        # State 1: primary -> secondary.
+        secondary.erase(off, size)
+        copy(secondary, size)
+        primary.trailer_write()
+        # State 2: scratch -> primary.
+        primary.erase(off, size)
+        copy(primary, size)
+        primary.trailer_write()
+
+    # Swap done: copy done and image ok flags.
+    primary.trailer_write()
+    primary.trailer_write()
+    return internal, external, None
+
+
+def sim_move(image_size, old_size):
+    """swap_move.c, swap_run(): move the primary image up by one sector, then
+    swap sector by sector."""
+    internal, external, primary, secondary, _ = layout(EXT_ERASE_SIZE)
+    max_sectors = primary.num_sectors
+    sector = primary.sector_size
+    copy_size = max(image_size, old_size)
+
+    last_idx = (copy_size + sector - 1) // sector
+    first_trailer_idx = primary.num_sectors - 1
+    size = sector
+    while size < trailer_size(max_sectors):
+        size += sector
+        first_trailer_idx -= 1
+    if last_idx >= first_trailer_idx:
+        return internal, external, 'image of 0x%x bytes too large, max 0x%x' % (
+            copy_size, (first_trailer_idx - 1) * sector)
+
+    # Status initialization in the primary trailer.
+    erase_trailer_sectors(primary, max_sectors)
+    for _ in range(4):
+        primary.trailer_write()
+
+    # Move up.
+    for idx in range(last_idx, 0, -1):
+        if idx == last_idx:
+            erase_trailer_sectors(secondary, max_sectors)
+        primary.erase(idx * sector, sector)
+        copy(primary, sector)
+        primary.trailer_write()
+
+    # Swap.
+    for idx in range(last_idx):
+        primary.erase(idx * sector, sector)
+        copy(primary, sector)
+        primary.trailer_write()
+        secondary.erase(idx * sector, sector)
+        copy(secondary, sector)
+        primary.trailer_write()
+
+    primary.trailer_write()
+    primary.trailer_write()
+    return internal, external, None
+
+
+def report(name, result):
+    internal, external, error = result
+    print('%s:' % name)
+    if error:
+        print('  not possible: %s' % error)
+        return
+    for mem in (internal, external):
+        print('  %-16s erase requests %5d, erase units erased %5d (max %3d per unit), '
+              'bytes programmed 0x%07x, trailer writes %d'
+              % (mem.name, mem.erase_ops, mem.units_erased(), mem.max_unit_erases(),
+                 mem.bytes_programmed, mem.trailer_writes))
+    if name == 'scratch':
+        hot = max(internal.unit_erases[SLOT_SIZE // ROW_SIZE:])
+        print('  scratch rows erased %d times each' % hot)
+        if external.erase_unit > ROW_SIZE:
+            print('  note: 512-byte erases of the external memory erase a whole '
+                  '0x%x-byte sector, destroying the rest of it' % external.erase_unit)
+
+
+def main():
+    global EXT_ERASE_SIZE, SLOT_SIZE, SCRATCH_SIZE
+
+    parser = argparse.ArgumentParser(description='Simulate the flash operations of one MCUboot upgrade')
+    parser.add_argument('--image-size', type=lambda x: int(x, 0), default=0x100000,
+                        help='size of the new image (header + image + TLVs)')
+    parser.add_argument('--old-size', type=lambda x: int(x, 0), default=None,
+                        help='size of the image in primary slot (default: --image-size)')
+    parser.add_argument('--slot-size', type=lambda x: int(x, 0), default=SLOT_SIZE)
+    parser.add_argument('--ext-erase-size', type=lambda x: int(x, 0), default=EXT_ERASE_SIZE)
+    parser.add_argument('--scratch-size', type=lambda x: int(x, 0), default=SCRATCH_SIZE)
+    parser.add_argument('--mode', choices=['all', 'overwrite', 'scratch', 'move'], default='all')
+    args = parser.parse_args()
+
+    SLOT_SIZE = args.slot_size
+    EXT_ERASE_SIZE = args.ext_erase_size
+    SCRATCH_SIZE = args.scratch_size
+    old_size = args.image_size if args.old_size is None else args.old_size
+
+    if args.image_size > SLOT_SIZE or old_size > SLOT_SIZE:
+        sys.exit('image larger than the slot')
+
+    print('Slot 0x%x, image 0x%x (old 0x%x), external erase 0x%x, scratch 0x%x'
+          % (SLOT_SIZE, args.image_size, old_size, EXT_ERASE_SIZE, SCRATCH_SIZE))
+
+    if args.mode in ('all', 'overwrite'):
+        report('overwrite', sim_overwrite(args.image_size))
+    if args.mode in ('all', 'scratch'):
+        report('scratch', sim_scratch(args.image_size, old_size))
+    if args.mode in ('all', 'move'):
+        report('move', sim_move(args.image_size, old_size))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,544 @@
+/******************************************************************************
+ * File Name: smif_erase.c
+ *
+ * Description: This file implements the coalescing erase of the external
+ * memory, shared by the bootloader and the CM4 apps. psoc6_smif_erase() of the
+ * flash map backend is replaced at link time (--wrap): an aligned range is
+ * erased with the largest erase types that the memory advertises in its SFDP
+ * Basic Flash Parameter Table, instead of one erase sector at a time.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <string.h>
+
+/* Driver header files. */
+#include "cy_pdl.h"
+
+/*  Flash access headers. */
+#include "cy_smif_psoc6.h"
+
+/* Local headers. */
+#include "smif_erase.h"
+
+#ifdef CY_BOOT_SMIF_ERASE
+/* MCUboot header files. */
+#include "mcuboot_config/mcuboot_config.h"
+#endif
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Index of the SMIF memory configuration of the external memory. */
+#define SMIF_ERASE_MEM_CONFIG_INDEX     (0U)
+
+/* Fed between the erase commands of a range and while an erase is polled.
+ * The bootloader (CY_BOOT_SMIF_ERASE) services the WDT; the CM4 apps of this
+ * example don't.
+ */
+#ifdef CY_BOOT_SMIF_ERASE
+#define SMIF_ERASE_WATCHDOG_FEED()      MCUBOOT_WATCHDOG_FEED()
+#else
+#define SMIF_ERASE_WATCHDOG_FEED()      do { } while (0)
+#endif
+
+/* JEDEC "Read SFDP" command: 3-byte address, 8 dummy cycles, single SPI. */
+#define SMIF_ERASE_CMD_READ_SFDP        (0x5AU)
+#define SMIF_ERASE_SFDP_ADDR_SIZE       (3UL)
+#define SMIF_ERASE_SFDP_DUMMY_CYCLES    (8UL)
+
+/* SFDP header signature ("SFDP") and size of the SFDP and parameter headers. */
+#define SMIF_ERASE_SFDP_SIGNATURE       (0x50444653UL)
+#define SMIF_ERASE_SFDP_HEADER_SIZE     (8UL)
+#define SMIF_ERASE_SFDP_MAX_HEADERS     (8UL)
+
+/* Parameter table IDs: Basic Flash Parameter Table, Sector Map Parameter
+ * Table and 4-Byte Address Instruction Table.
+ */
+#define SMIF_ERASE_ID_BFPT              (0xFF00U)
+#define SMIF_ERASE_ID_SECTOR_MAP        (0xFF81U)
+#define SMIF_ERASE_ID_4BAIT             (0xFF84U)
+
+/* Number of DWORDs used from the Basic Flash Parameter Table: the erase
+ * types are in DWORDs 8 and 9, their erase times in DWORD 10 (JESD216A).
+ */
+#define SMIF_ERASE_BFPT_MIN_DWORDS      (9UL)
+#define SMIF_ERASE_BFPT_DWORDS          (10UL)
+#define SMIF_ERASE_BFPT_TYPES_DWORD     (7UL)
+#define SMIF_ERASE_BFPT_TIMES_DWORD     (9UL)
+
+/* Number of DWORDs used from the 4-Byte Address Instruction Table: erase
+ * type support bits (9 to 12) in DWORD 1, erase opcodes in DWORD 2.
+ */
+#define SMIF_ERASE_4BAIT_DWORDS         (2UL)
+#define SMIF_ERASE_4BAIT_SUPPORT_POS    (9UL)
+
+/* Error returned when the SFDP tables can't be used for coalescing. */
+#define SMIF_ERASE_RSLT_ERR_SFDP        (1UL)
+
+/* Error returned when an erase doesn't complete within its maximum time. */
+#define SMIF_ERASE_RSLT_ERR_TIMEOUT     (2UL)
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Units of the typical erase times of the Basic Flash Parameter Table. */
+static const uint32_t smif_erase_time_units_ms[4] = { 1UL, 16UL, 128UL, 1000UL };
+
+/* Erase types of the external memory, read from SFDP on the first erase.
+ * An empty table leaves every erase to the flash map backend.
+ */
+static smif_erase_table_t erase_table;
+static bool erase_table_read;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Function of cy_smif_psoc6.c, resolved by the linker (--wrap). */
+int __real_psoc6_smif_erase(off_t addr, size_t size);
+#ifndef CY_BOOT_SMIF_CACHE
+int __wrap_psoc6_smif_erase(off_t addr, size_t size);
+#endif
+
+static cy_rslt_t smif_erase_read_sfdp(uint32_t addr, void *buf, uint32_t len);
+static void smif_erase_read_table(void);
+static cy_rslt_t smif_erase_unit(const smif_erase_type_t *type, uint32_t addr);
+
+/******************************************************************************
+ * Function Name: smif_erase_build_table
+ ******************************************************************************
+ * Summary:
+ *  Builds the table of erase types from the SFDP parameter tables. The erase
+ *  types smaller than "min_size" are left out, and the table is sorted from
+ *  the largest type to the smallest one. With 4-byte addresses, the opcodes
+ *  of the 4-Byte Address Instruction Table are used if it is provided.
+ *  The SFDP tables are little-endian, as is the CPU.
+ *
+ * Parameters:
+ *  bfpt         - Basic Flash Parameter Table.
+ *  bfpt_dwords  - Number of DWORDs of "bfpt".
+ *  fbait        - 4-Byte Address Instruction Table. Can be NULL.
+ *  fbait_dwords - Number of DWORDs of "fbait".
+ *  addr_bytes   - Number of address bytes of the erase commands.
+ *  min_size     - Size of the smallest erase type to be used.
+ *  table        - Filled with the erase types.
+ *
+ * Return:
+ *  CY_RSLT_SUCCESS if at least one erase type was found.
+ *
+ ******************************************************************************/
+cy_rslt_t smif_erase_build_table(const uint32_t *bfpt, uint32_t bfpt_dwords,
+                                 const uint32_t *fbait, uint32_t fbait_dwords,
+                                 uint32_t addr_bytes, uint32_t min_size,
+                                 smif_erase_table_t *table)
+{
+    smif_erase_type_t type;
+    uint32_t times = 0;
+    uint32_t field;
+    uint32_t i, j;
+
+    table->count = 0;
+
+    if (bfpt_dwords < SMIF_ERASE_BFPT_MIN_DWORDS)
+    {
+        return SMIF_ERASE_RSLT_ERR_SFDP;
+    }
+
+    if (bfpt_dwords > SMIF_ERASE_BFPT_TIMES_DWORD)
+    {
+        times = bfpt[SMIF_ERASE_BFPT_TIMES_DWORD];
+    }
+
+    for (i = 0; i < SMIF_ERASE_MAX_TYPES; i++)
+    {
+        /* Size exponent and opcode of each type, two types per DWORD. */
+        field = bfpt[SMIF_ERASE_BFPT_TYPES_DWORD + (i / 2UL)] >> (16UL * (i % 2UL));
+
+        if (((field & 0xFFUL) == 0UL) || ((field & 0xFFUL) >= 32UL))
+        {
+            continue;
+        }
+
+        type.size = 1UL << (field & 0xFFUL);
+        type.cmd = (uint8_t)(field >> 8U);
+
+        if ((addr_bytes == 4UL) && (fbait != NULL) && (fbait_dwords >= SMIF_ERASE_4BAIT_DWORDS))
+        {
+            if ((fbait[0] & (1UL << (SMIF_ERASE_4BAIT_SUPPORT_POS + i))) == 0UL)
+            {
+                continue;
+            }
+
+            type.cmd = (uint8_t)(fbait[1] >> (8UL * i));
+        }
+
+        /* Typical time: (count + 1) units, 7 bits per type from bit 4.
+         * Maximum time: 2 * (multiplier + 1) times the typical time.
+         * 0 when the table doesn't give the erase times.
+         */
+        type.max_time_ms = 0;
+
+        if (times != 0UL)
+        {
+            field = times >> (4UL + (7UL * i));
+            type.max_time_ms = ((field & 0x1FUL) + 1UL) *
+                               smif_erase_time_units_ms[(field >> 5U) & 0x3UL] *
+                               (2UL * ((times & 0xFUL) + 1UL));
+        }
+
+        if (type.size < min_size)
+        {
+            continue;
+        }
+
+        /* Insert, largest first. A second type of the same size is ignored. */
+        for (j = 0; (j < table->count) && (table->types[j].size > type.size); j++)
+        {
+        }
+
+        if ((j < table->count) && (table->types[j].size == type.size))
+        {
+            continue;
+        }
+
+        memmove(&table->types[j + 1UL], &table->types[j],
+                (table->count - j) * sizeof(smif_erase_type_t));
+        table->types[j] = type;
+        table->count++;
+    }
+
+    return (table->count != 0UL) ? CY_RSLT_SUCCESS : SMIF_ERASE_RSLT_ERR_SFDP;
+}
+
+/******************************************************************************
+ * Function Name: smif_erase_next
+ ******************************************************************************
+ * Summary:
+ *  Selects the erase type for the next step of a range erase: the largest
+ *  type that is aligned at "addr" and doesn't go past the end of the range.
+ *
+ * Parameters:
+ *  table - Erase types, largest first.
+ *  addr  - Address of the rest of the range.
+ *  len   - Length of the rest of the range.
+ *
+ * Return:
+ *  The erase type, or NULL if none fits.
+ *
+ ******************************************************************************/
+const smif_erase_type_t *smif_erase_next(const smif_erase_table_t *table,
+                                         uint32_t addr, uint32_t len)
+{
+    const smif_erase_type_t *type = NULL;
+    uint32_t i;
+
+    for (i = 0; (i < table->count) && (type == NULL); i++)
+    {
+        if (((addr & (table->types[i].size - 1UL)) == 0UL) && (len >= table->types[i].size))
+        {
+            type = &table->types[i];
+        }
+    }
+
+    return type;
+}
+
+/******************************************************************************
+ * Function Name: smif_erase_read_sfdp
+ ******************************************************************************
+ * Summary:
+ *  Reads "len" bytes of the SFDP area of the external memory at "addr".
+ *
+ ******************************************************************************/
+static cy_rslt_t smif_erase_read_sfdp(uint32_t addr, void *buf, uint32_t len)
+{
+    cy_stc_smif_mem_config_t *mem_cfg = qspi_get_memory_config(SMIF_ERASE_MEM_CONFIG_INDEX);
+    uint8_t addr_buf[SMIF_ERASE_SFDP_ADDR_SIZE];
+    cy_en_smif_status_t status;
+
+    addr_buf[0] = (uint8_t)(addr >> 16U);
+    addr_buf[1] = (uint8_t)(addr >> 8U);
+    addr_buf[2] = (uint8_t)addr;
+
+    status = Cy_SMIF_TransmitCommand(qspi_get_device(), SMIF_ERASE_CMD_READ_SFDP,
+            CY_SMIF_WIDTH_SINGLE, addr_buf, SMIF_ERASE_SFDP_ADDR_SIZE, CY_SMIF_WIDTH_SINGLE,
+            mem_cfg->slaveSelect, CY_SMIF_TX_NOT_LAST_BYTE, qspi_get_context());
+
+    if (status == CY_SMIF_SUCCESS)
+    {
+        status = Cy_SMIF_SendDummyCycles(qspi_get_device(), SMIF_ERASE_SFDP_DUMMY_CYCLES);
+    }
+
+    if (status == CY_SMIF_SUCCESS)
+    {
+        status = Cy_SMIF_ReceiveDataBlocking(qspi_get_device(), (uint8_t *)buf, len,
+                CY_SMIF_WIDTH_SINGLE, qspi_get_context());
+    }
+
+    return (status == CY_SMIF_SUCCESS) ? CY_RSLT_SUCCESS : (cy_rslt_t)status;
+}
+
+/******************************************************************************
+ * Function Name: smif_erase_read_table
+ ******************************************************************************
+ * Summary:
+ *  Reads the SFDP parameter tables and builds the table of erase types
+ *  usable on the whole memory. The table is left empty, and the erases are
+ *  left to the flash map backend, if:
+ *  - the memory has a Sector Map Parameter Table (hybrid sectors: an erase
+ *    type doesn't apply to the whole memory), or
+ *  - the smallest type doesn't match the erase command selected by the SFDP
+ *    detection of the SMIF driver, e.g. for 4-byte addresses without a
+ *    4-Byte Address Instruction Table.
+ *
+ ******************************************************************************/
+static void smif_erase_read_table(void)
+{
+    cy_stc_smif_mem_device_cfg_t *dev_cfg =
+            qspi_get_memory_config(SMIF_ERASE_MEM_CONFIG_INDEX)->deviceCfg;
+    uint8_t headers[SMIF_ERASE_SFDP_HEADER_SIZE * (SMIF_ERASE_SFDP_MAX_HEADERS + 1UL)];
+    uint32_t bfpt[SMIF_ERASE_BFPT_DWORDS];
+    uint32_t fbait[SMIF_ERASE_4BAIT_DWORDS];
+    uint32_t bfpt_dwords = 0, fbait_dwords = 0;
+    uint32_t num_headers, i, id, dwords, ptr;
+    const uint8_t *hdr;
+    bool hybrid = false;
+    cy_rslt_t result;
+
+    erase_table.count = 0;
+
+    result = smif_erase_read_sfdp(0, headers, SMIF_ERASE_SFDP_HEADER_SIZE);
+
+    if ((result != CY_RSLT_SUCCESS) ||
+        ((headers[0] | ((uint32_t)headers[1] << 8U) | ((uint32_t)headers[2] << 16U) |
+          ((uint32_t)headers[3] << 24U)) != SMIF_ERASE_SFDP_SIGNATURE))
+    {
+        return;
+    }
+
+    num_headers = (uint32_t)headers[6] + 1UL;
+    if (num_headers > SMIF_ERASE_SFDP_MAX_HEADERS)
+    {
+        num_headers = SMIF_ERASE_SFDP_MAX_HEADERS;
+    }
+
+    result = smif_erase_read_sfdp(SMIF_ERASE_SFDP_HEADER_SIZE, &headers[SMIF_ERASE_SFDP_HEADER_SIZE],
+            num_headers * SMIF_ERASE_SFDP_HEADER_SIZE);
+
+    for (i = 0; (i < num_headers) && (result == CY_RSLT_SUCCESS); i++)
+    {
+        /* Parameter header: ID LSB, minor and major revisions, length in
+         * DWORDs, 24-bit table pointer, ID MSB.
+         */
+        hdr = &headers[SMIF_ERASE_SFDP_HEADER_SIZE * (i + 1UL)];
+        id = ((uint32_t)hdr[7] << 8U) | hdr[0];
+        dwords = hdr[3];
+        ptr = hdr[4] | ((uint32_t)hdr[5] << 8U) | ((uint32_t)hdr[6] << 16U);
+
+        if ((id == SMIF_ERASE_ID_BFPT) && (bfpt_dwords == 0UL))
+        {
+            bfpt_dwords = (dwords < SMIF_ERASE_BFPT_DWORDS) ? dwords : SMIF_ERASE_BFPT_DWORDS;
+            result = smif_erase_read_sfdp(ptr, bfpt, bfpt_dwords * sizeof(uint32_t));
+        }
+        else if ((id == SMIF_ERASE_ID_4BAIT) && (fbait_dwords == 0UL))
+        {
+            fbait_dwords = (dwords < SMIF_ERASE_4BAIT_DWORDS) ? dwords : SMIF_ERASE_4BAIT_DWORDS;
+            result = smif_erase_read_sfdp(ptr, fbait, fbait_dwords * sizeof(uint32_t));
+        }
+        else if (id == SMIF_ERASE_ID_SECTOR_MAP)
+        {
+            hybrid = true;
+        }
+        else
+        {
+            /* Vendor tables are not used. */
+        }
+    }
+
+    if ((result != CY_RSLT_SUCCESS) || hybrid ||
+        (smif_erase_build_table(bfpt, bfpt_dwords, (fbait_dwords != 0UL) ? fbait : NULL,
+                fbait_dwords, dev_cfg->numOfAddrBytes, dev_cfg->eraseSize,
+                &erase_table) != CY_RSLT_SUCCESS) ||
+        (erase_table.types[erase_table.count - 1UL].size != dev_cfg->eraseSize) ||
+        (erase_table.types[erase_table.count - 1UL].cmd != (uint8_t)dev_cfg->eraseCmd->command))
+    {
+        erase_table.count = 0;
+        return;
+    }
+
+    /* Without erase times in SFDP, scale the time of the erase command of the
+     * SMIF driver, which is an upper bound for the larger types.
+     */
+    for (i = 0; i < erase_table.count; i++)
+    {
+        if (erase_table.types[i].max_time_ms == 0UL)
+        {
+            erase_table.types[i].max_time_ms = dev_cfg->eraseTime *
+                    (erase_table.types[i].size / dev_cfg->eraseSize);
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: smif_erase_unit
+ ******************************************************************************
+ * Summary:
+ *  Erases one unit of an erase type and waits until the memory is ready.
+ *  The command and address widths are those of the erase command of the
+ *  SMIF driver.
+ *
+ * Parameters:
+ *  type - Erase type.
+ *  addr - Address of the unit in the memory, aligned to its size.
+ *
+ * Return:
+ *  Status of the erase.
+ *
+ ******************************************************************************/
+static cy_rslt_t smif_erase_unit(const smif_erase_type_t *type, uint32_t addr)
+{
+    cy_stc_smif_mem_config_t *mem_cfg = qspi_get_memory_config(SMIF_ERASE_MEM_CONFIG_INDEX);
+    cy_stc_smif_mem_device_cfg_t *dev_cfg = mem_cfg->deviceCfg;
+    uint8_t addr_buf[4];
+    uint32_t elapsed_ms = 0;
+    cy_en_smif_status_t status;
+    uint32_t i;
+
+    /* Address, MSB first. */
+    for (i = 0; i < dev_cfg->numOfAddrBytes; i++)
+    {
+        addr_buf[i] = (uint8_t)(addr >> (8UL * (dev_cfg->numOfAddrBytes - 1UL - i)));
+    }
+
+    status = Cy_SMIF_MemCmdWriteEnable(qspi_get_device(), mem_cfg, qspi_get_context());
+
+    if (status == CY_SMIF_SUCCESS)
+    {
+        status = Cy_SMIF_TransmitCommand(qspi_get_device(), type->cmd,
+                dev_cfg->eraseCmd->cmdWidth, addr_buf, dev_cfg->numOfAddrBytes,
+                dev_cfg->eraseCmd->addrWidth, mem_cfg->slaveSelect,
+                CY_SMIF_TX_LAST_BYTE, qspi_get_context());
+    }
+
+    if (status != CY_SMIF_SUCCESS)
+    {
+        return (cy_rslt_t)status;
+    }
+
+    while (Cy_SMIF_MemIsBusy(qspi_get_device(), mem_cfg, qspi_get_context()))
+    {
+        if (elapsed_ms >= type->max_time_ms)
+        {
+            return SMIF_ERASE_RSLT_ERR_TIMEOUT;
+        }
+
+        Cy_SysLib_Delay(1U);
+        SMIF_ERASE_WATCHDOG_FEED();
+        elapsed_ms++;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: smif_erase
+ ******************************************************************************
+ * Summary:
+ *  Erases a range of the external memory. A range aligned to the erase size
+ *  of the SMIF driver is erased with the largest erase types that fit, e.g.
+ *  64 KB blocks in the middle of a range and 4 KB sectors at its ends.
+ *  Other ranges, and all ranges if the memory has a single usable erase
+ *  type, are erased by psoc6_smif_erase() of the flash map backend.
+ *
+ * Parameters:
+ *  addr - Memory-mapped address of the range (CY_SMIF_BASE_MEM_OFFSET based).
+ *  size - Size of the range.
+ *
+ * Return:
+ *  0 on success, -1 otherwise.
+ *
+ ******************************************************************************/
+int smif_erase(off_t addr, size_t size)
+{
+    const smif_erase_type_t *type;
+    uint32_t mem_addr = (uint32_t)addr - CY_SMIF_BASE_MEM_OFFSET;
+    uint32_t len = (uint32_t)size;
+    uint32_t min_size;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (!erase_table_read)
+    {
+        smif_erase_read_table();
+        erase_table_read = true;
+    }
+
+    if (erase_table.count < 2UL)
+    {
+        return __real_psoc6_smif_erase(addr, size);
+    }
+
+    min_size = erase_table.types[erase_table.count - 1UL].size;
+
+    if (((mem_addr | len) & (min_size - 1UL)) != 0UL)
+    {
+        return __real_psoc6_smif_erase(addr, size);
+    }
+
+    while ((len != 0UL) && (result == CY_RSLT_SUCCESS))
+    {
+        type = smif_erase_next(&erase_table, mem_addr, len);
+        result = smif_erase_unit(type, mem_addr);
+        SMIF_ERASE_WATCHDOG_FEED();
+        mem_addr += type->size;
+        len -= type->size;
+    }
+
+    return (result == CY_RSLT_SUCCESS) ? 0 : -1;
+}
+
+#ifndef CY_BOOT_SMIF_CACHE
+/******************************************************************************
+ * Function Name: __wrap_psoc6_smif_erase
+ ******************************************************************************
+ * Summary:
+ *  Replaces psoc6_smif_erase(). With CY_BOOT_SMIF_CACHE, the bootloader
+ *  read cache (smif_cache.c) replaces it and calls smif_erase().
+ *
+ ******************************************************************************/
+int __wrap_psoc6_smif_erase(off_t addr, size_t size)
+{
+    return smif_erase(addr, size);
+}
+#endif
+
+/* [] END OF FILE */
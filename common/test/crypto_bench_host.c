@@ -0,0 +1,131 @@
+/******************************************************************************
+ * File Name: crypto_bench_host.c
+ *
+ * Description: Host build of the crypto self-test of the bootloader
+ * (bootloader_cm0p/source/crypto_bench.c) against the software mbedTLS
+ * backend: SHA-256 throughput for each chunk size, and ECDSA P-256
+ * verification without and with the comb table of ec_p256_comb.c. The data
+ * hashed is a RAM buffer mapped at the device address of the internal flash.
+ * The results are those of the host CPU: they compare the chunk sizes and
+ * the comb table, not the timings of the PSoC 6.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/mman.h>
+
+/* Module under test. */
+#include "cy_pdl.h"
+#include "crypto_bench.h"
+#include "boot_timer.h"
+#include "image_info.h"
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* Not known on the host: reported as 0 kHz. */
+uint32_t SystemCoreClock = 0;
+
+/*******************************************************************************
+* Host drivers
+********************************************************************************/
+void Cy_WDT_ClearWatchdog(void)
+{
+}
+
+uint32_t boot_timer_get_us(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000ULL));
+}
+
+/* There is no primary slot: the verification of the image is skipped. */
+int flash_area_open(uint8_t id, const struct flash_area **fap)
+{
+    (void)id;
+    *fap = NULL;
+    return -1;
+}
+
+void flash_area_close(const struct flash_area *fap)
+{
+    (void)fap;
+}
+
+cy_rslt_t image_info_read(const struct flash_area *fap, struct image_header *hdr,
+                          uint32_t *extent)
+{
+    (void)fap;
+    (void)hdr;
+    *extent = 0;
+    return 1UL;
+}
+
+cy_rslt_t image_verify_mapped(image_verify_t *ctx, const struct flash_area *fap,
+                              uint32_t length)
+{
+    (void)ctx;
+    (void)fap;
+    (void)length;
+    return 1UL;
+}
+
+int main(void)
+{
+    uint8_t *flash;
+    uint32_t i;
+
+    /* The self-test hashes the internal flash at its device address. */
+    flash = mmap((void *)CY_FLASH_BASE, CRYPTO_BENCH_HASH_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (flash != (uint8_t *)CY_FLASH_BASE)
+    {
+        perror("mmap");
+        return 2;
+    }
+
+    srand(1);
+    for (i = 0; i < CRYPTO_BENCH_HASH_SIZE; i++)
+    {
+        flash[i] = (uint8_t)rand();
+    }
+
+    return (crypto_bench_run() == CY_RSLT_SUCCESS) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,381 @@
+/******************************************************************************
+ * File Name: flash_copy_sim.c
+ *
+ * Description: Host test of the copy engine of the bootloader
+ * (bootloader_cm0p/source/flash_copy.c) with simulated latencies. The internal
+ * flash is a RAM buffer mapped at its device address, and the flash driver
+ * and the source reads advance a simulated clock by the program, erase and
+ * QSPI read times given on the command line.
+ * 
+ * Each scenario checks the content of the destination, that no row is
+ * programmed without being erased first, that operations are started only
+ * when the previous one is complete, and the status returned on errors. The
+ * simulated duration of the copy is reported, together with the duration
+ * it would have if the read of each row were fully overlapped with the
+ * programming of the previous one.
+ * 
+ * Usage:
+ *   flash_copy_sim [-p <program us>] [-r <row erase us>] [-e <subsector erase us>]
+ *                  [-q <QSPI kB/s>] [-o <read overhead us>]
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* Module under test. */
+#include "cy_pdl.h"
+#include "flash_copy.h"
+#include "boot_timer.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Simulated destination: 512 KB of internal flash at its device address. */
+#define SIM_FLASH_SIZE              (0x80000UL)
+
+/* Erased value of the internal flash. */
+#define SIM_ERASED_VAL              (0x00U)
+
+/* Default simulated latencies: model inputs, to be set from the datasheets of
+ * the device and of the external memory.
+ */
+#define SIM_DEFAULT_PROGRAM_US      (5000UL)
+#define SIM_DEFAULT_ROW_ERASE_US    (11000UL)
+#define SIM_DEFAULT_SUB_ERASE_US    (11000UL)
+#define SIM_DEFAULT_QSPI_KBPS       (20000UL)
+#define SIM_DEFAULT_READ_OVH_US     (20UL)
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+static uint8_t *sim_flash;
+static uint8_t sim_src[SIM_FLASH_SIZE];
+static bool sim_erased[SIM_FLASH_SIZE / CY_FLASH_SIZEOF_ROW];
+
+static uint32_t program_us = SIM_DEFAULT_PROGRAM_US;
+static uint32_t row_erase_us = SIM_DEFAULT_ROW_ERASE_US;
+static uint32_t sub_erase_us = SIM_DEFAULT_SUB_ERASE_US;
+static uint32_t qspi_kbps = SIM_DEFAULT_QSPI_KBPS;
+static uint32_t read_ovh_us = SIM_DEFAULT_READ_OVH_US;
+
+/* Simulated clock and state of the flash controller. */
+static uint64_t now_ns;
+static uint64_t busy_until_ns;
+static bool busy;
+static uint32_t busy_polls;
+static cy_en_flashdrv_status_t op_status;
+
+/* Fault injection: address of the row whose program fails, offset of the
+ * source read that fails. UINT32_MAX when disabled.
+ */
+static uint32_t fail_program_addr = UINT32_MAX;
+static uint32_t fail_read_off = UINT32_MAX;
+
+/* Counters of a scenario. */
+static uint32_t n_programs;
+static uint32_t n_row_erases;
+static uint32_t n_sub_erases;
+static uint32_t n_wdt_feeds;
+static uint64_t last_read_ns;
+static uint64_t overlap_ns;
+static int failures;
+
+/*******************************************************************************
+* Simulated drivers
+********************************************************************************/
+#define SIM_CHECK(cond, ...)        do { if (!(cond)) { printf("  FAIL: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static uint32_t sim_offset(uint32_t addr)
+{
+    return addr - CY_FLASH_BASE;
+}
+
+static cy_en_flashdrv_status_t sim_start(uint32_t latency_us, cy_en_flashdrv_status_t status)
+{
+    SIM_CHECK(!busy, "operation started while the flash controller is busy");
+    busy = true;
+    busy_polls = 0;
+    busy_until_ns = now_ns + (uint64_t)latency_us * 1000ULL;
+    op_status = status;
+
+    return CY_FLASH_DRV_OPERATION_STARTED;
+}
+
+cy_en_flashdrv_status_t Cy_Flash_StartProgram(uint32_t rowAddr, const uint32_t *data)
+{
+    uint32_t off = sim_offset(rowAddr);
+
+    SIM_CHECK((off % CY_FLASH_SIZEOF_ROW) == 0, "unaligned program @ 0x%x", (unsigned int)off);
+    SIM_CHECK(sim_erased[off / CY_FLASH_SIZEOF_ROW], "program of a row not erased @ 0x%x", (unsigned int)off);
+
+    if (rowAddr == fail_program_addr)
+    {
+        return sim_start(program_us, CY_FLASH_DRV_ERR_UNC);
+    }
+
+    memcpy(&sim_flash[off], data, CY_FLASH_SIZEOF_ROW);
+    sim_erased[off / CY_FLASH_SIZEOF_ROW] = false;
+    n_programs++;
+
+    /* Time the read of this row could have been hidden behind. */
+    overlap_ns += (last_read_ns < (uint64_t)program_us * 1000ULL) ?
+                  last_read_ns : (uint64_t)program_us * 1000ULL;
+
+    return sim_start(program_us, CY_FLASH_DRV_SUCCESS);
+}
+
+static void sim_erase(uint32_t off, uint32_t size)
+{
+    uint32_t i;
+
+    memset(&sim_flash[off], SIM_ERASED_VAL, size);
+    for (i = 0; i < size; i += CY_FLASH_SIZEOF_ROW)
+    {
+        sim_erased[(off + i) / CY_FLASH_SIZEOF_ROW] = true;
+    }
+}
+
+cy_en_flashdrv_status_t Cy_Flash_StartEraseRow(uint32_t rowAddr)
+{
+    uint32_t off = sim_offset(rowAddr);
+
+    SIM_CHECK((off % CY_FLASH_SIZEOF_ROW) == 0, "unaligned row erase @ 0x%x", (unsigned int)off);
+    sim_erase(off, CY_FLASH_SIZEOF_ROW);
+    n_row_erases++;
+
+    return sim_start(row_erase_us, CY_FLASH_DRV_SUCCESS);
+}
+
+cy_en_flashdrv_status_t Cy_Flash_StartEraseSubsector(uint32_t subSectorAddr)
+{
+    uint32_t off = sim_offset(subSectorAddr);
+
+    SIM_CHECK((off % FLASH_COPY_ERASE_SIZE) == 0, "unaligned subsector erase @ 0x%x", (unsigned int)off);
+    sim_erase(off, FLASH_COPY_ERASE_SIZE);
+    n_sub_erases++;
+
+    return sim_start(sub_erase_us, CY_FLASH_DRV_SUCCESS);
+}
+
+/* The CPU spins on the status: the clock runs to the end of the operation,
+ * after reporting it busy at least once.
+ */
+cy_en_flashdrv_status_t Cy_Flash_IsOperationComplete(void)
+{
+    if (!busy)
+    {
+        return CY_FLASH_DRV_SUCCESS;
+    }
+
+    if (busy_polls++ == 0)
+    {
+        return CY_FLASH_DRV_OPCODE_BUSY;
+    }
+
+    now_ns = busy_until_ns;
+    busy = false;
+
+    return op_status;
+}
+
+void Cy_WDT_ClearWatchdog(void)
+{
+    n_wdt_feeds++;
+}
+
+uint32_t boot_timer_get_us(void)
+{
+    return (uint32_t)(now_ns / 1000ULL);
+}
+
+int flash_area_read(const struct flash_area *fap, uint32_t off, void *dst, uint32_t len)
+{
+    (void)fap;
+    memcpy(dst, &sim_src[off], len);
+    return 0;
+}
+
+uint8_t flash_area_erased_val(const struct flash_area *fap)
+{
+    (void)fap;
+    return SIM_ERASED_VAL;
+}
+
+/* Source of the copy: a QSPI read of "len" bytes. */
+static cy_rslt_t sim_read(void *ctx, uint32_t off, void *buf, uint32_t len)
+{
+    (void)ctx;
+
+    SIM_CHECK(!busy, "source read while the flash controller is busy");
+
+    last_read_ns = ((uint64_t)read_ovh_us * 1000ULL) +
+                   (((uint64_t)len * 1000000ULL) / qspi_kbps);
+    now_ns += last_read_ns;
+
+    if (off == fail_read_off)
+    {
+        return 1UL;
+    }
+
+    memcpy(buf, &sim_src[off], len);
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Scenarios
+********************************************************************************/
+static void run(const char *name, uint32_t off, uint32_t len, bool expect_ok)
+{
+    struct flash_area fa = { .fa_id = 1, .fa_off = CY_FLASH_BASE, .fa_size = SIM_FLASH_SIZE };
+    flash_copy_src_t src = { .read = sim_read, .ctx = NULL, .name = "sim" };
+    flash_copy_stats_t stats = { 0 };
+    cy_rslt_t result;
+    uint32_t rows = len / CY_FLASH_SIZEOF_ROW;
+    uint32_t ms;
+    int before = failures;
+
+    printf("%s\n", name);
+
+    n_programs = n_row_erases = n_sub_erases = n_wdt_feeds = 0;
+    overlap_ns = last_read_ns = 0;
+    now_ns = 0;
+
+    result = flash_copy_to_int(&src, off, &fa, off, len, NULL, &stats);
+
+    SIM_CHECK(!busy, "flash operation left running");
+
+    if (expect_ok)
+    {
+        SIM_CHECK(result == CY_RSLT_SUCCESS, "copy failed: 0x%x", (unsigned int)result);
+        SIM_CHECK(memcmp(&sim_flash[off], &sim_src[off], len) == 0, "destination differs from the source");
+        SIM_CHECK(stats.bytes_copied == len, "bytes_copied %u", (unsigned int)stats.bytes_copied);
+        SIM_CHECK(n_programs * CY_FLASH_SIZEOF_ROW == len - stats.bytes_blank - stats.bytes_unchanged,
+                  "%u rows programmed", (unsigned int)n_programs);
+        SIM_CHECK(n_wdt_feeds >= rows, "watchdog fed %u times for %u rows",
+                  (unsigned int)n_wdt_feeds, (unsigned int)rows);
+    }
+    else
+    {
+        SIM_CHECK(result != CY_RSLT_SUCCESS, "copy didn't report the error");
+    }
+
+    ms = stats.elapsed_us / 1000UL;
+    printf("  rows %u: programmed %u, blank %u, unchanged %u; erases: %u subsector, %u row\n",
+           (unsigned int)rows, (unsigned int)n_programs,
+           (unsigned int)(stats.bytes_blank / CY_FLASH_SIZEOF_ROW),
+           (unsigned int)(stats.bytes_unchanged / CY_FLASH_SIZEOF_ROW),
+           (unsigned int)n_sub_erases, (unsigned int)n_row_erases);
+    printf("  simulated time %u ms (%u kB/s), %u ms with the reads overlapped\n",
+           (unsigned int)ms,
+           (unsigned int)((stats.elapsed_us != 0) ? (((uint64_t)len * 1000ULL) / stats.elapsed_us) : 0),
+           (unsigned int)((stats.elapsed_us - (uint32_t)(overlap_ns / 1000ULL)) / 1000UL));
+    printf("  %s\n", (failures == before) ? "PASS" : "FAIL");
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    uint32_t i;
+
+    while ((opt = getopt(argc, argv, "p:r:e:q:o:")) != -1)
+    {
+        uint32_t val = (uint32_t)strtoul(optarg, NULL, 0);
+
+        switch (opt)
+        {
+            case 'p': program_us = val; break;
+            case 'r': row_erase_us = val; break;
+            case 'e': sub_erase_us = val; break;
+            case 'q': qspi_kbps = (val != 0) ? val : 1UL; break;
+            case 'o': read_ovh_us = val; break;
+            default:
+                fprintf(stderr, "usage: %s [-p us] [-r us] [-e us] [-q kB/s] [-o us]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    printf("program %u us, row erase %u us, subsector erase %u us, QSPI %u kB/s + %u us per read\n\n",
+           (unsigned int)program_us, (unsigned int)row_erase_us, (unsigned int)sub_erase_us,
+           (unsigned int)qspi_kbps, (unsigned int)read_ovh_us);
+
+    /* The copy engine accesses the destination at its device address. */
+    sim_flash = mmap((void *)CY_FLASH_BASE, SIM_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (sim_flash != (uint8_t *)CY_FLASH_BASE)
+    {
+        perror("mmap");
+        return 2;
+    }
+
+    /* Image with a blank gap, e.g. padding between sections. */
+    srand(1);
+    for (i = 0; i < SIM_FLASH_SIZE; i++)
+    {
+        sim_src[i] = (uint8_t)rand();
+    }
+    memset(&sim_src[0x4000], SIM_ERASED_VAL, 0x2200);
+    memset(sim_flash, 0x5A, SIM_FLASH_SIZE);
+    memset(sim_erased, 0, sizeof(sim_erased));
+
+    run("full copy", 0, SIM_FLASH_SIZE - 0x400, true);
+    run("repeated copy", 0, SIM_FLASH_SIZE - 0x400, true);
+
+    sim_flash[0x100] ^= 0x01;
+    sim_flash[0x1400] ^= 0x01;
+    run("two corrupted rows", 0, SIM_FLASH_SIZE - 0x400, true);
+
+    memset(sim_flash, 0x5A, SIM_FLASH_SIZE);
+    memset(sim_erased, 0, sizeof(sim_erased));
+    run("unaligned start and end", CY_FLASH_SIZEOF_ROW, 0x3000 - CY_FLASH_SIZEOF_ROW, true);
+
+    memset(sim_flash, 0x5A, SIM_FLASH_SIZE);
+    memset(sim_erased, 0, sizeof(sim_erased));
+    fail_program_addr = CY_FLASH_BASE + 0x2200;
+    run("program error", 0, 0x4000, false);
+    fail_program_addr = UINT32_MAX;
+
+    fail_read_off = 0x1000;
+    run("read error", 0, 0x4000, false);
+    fail_read_off = UINT32_MAX;
+
+    printf("\n%s\n", (failures == 0) ? "All scenarios passed" : "FAILED");
+
+    return (failures == 0) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,149 @@
+/******************************************************************************
+ * File Name: cy_pdl.h
+ *
+ * Description: Host replacement of the subset of the PSoC 6 Peripheral Driver Library
+ * used by the modules under test. The drivers themselves are implemented by
+ * each test.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+#ifndef HOST_CY_PDL_H_
+#define HOST_CY_PDL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+#include "cy_result.h"
+
+#define CY_ASSERT(x)                assert(x)
+
+/*******************************************************************************
+* Flash driver
+********************************************************************************/
+#define CY_FLASH_BASE               (0x10000000UL)
+#define CY_FLASH_SIZEOF_ROW         (512UL)
+
+typedef enum
+{
+    CY_FLASH_DRV_SUCCESS                  = 0x00,
+    CY_FLASH_DRV_INVALID_INPUT_PARAMETERS = 0x01,
+    CY_FLASH_DRV_ERR_UNC                  = 0x03,
+    CY_FLASH_DRV_PROGRESS_NO_ERROR        = 0x40,
+    CY_FLASH_DRV_OPERATION_STARTED        = 0x41,
+    CY_FLASH_DRV_OPCODE_BUSY              = 0x42,
+} cy_en_flashdrv_status_t;
+
+cy_en_flashdrv_status_t Cy_Flash_StartProgram(uint32_t rowAddr, const uint32_t *data);
+cy_en_flashdrv_status_t Cy_Flash_StartEraseRow(uint32_t rowAddr);
+cy_en_flashdrv_status_t Cy_Flash_StartEraseSubsector(uint32_t subSectorAddr);
+cy_en_flashdrv_status_t Cy_Flash_IsOperationComplete(void);
+
+/*******************************************************************************
+* SMIF driver
+********************************************************************************/
+#define CY_SMIF_BASE_MEM_OFFSET     (0x18000000UL)
+
+typedef struct { uint32_t reserved; } SMIF_Type;
+typedef struct { uint32_t reserved; } cy_stc_smif_context_t;
+
+typedef enum
+{
+    CY_SMIF_SUCCESS = 0x00,
+    CY_SMIF_EXCEED_TIMEOUT = 0x02,
+} cy_en_smif_status_t;
+
+typedef enum
+{
+    CY_SMIF_WIDTH_SINGLE = 0,
+    CY_SMIF_WIDTH_DUAL = 1,
+    CY_SMIF_WIDTH_QUAD = 2,
+    CY_SMIF_WIDTH_OCTAL = 3,
+} cy_en_smif_txfr_width_t;
+
+typedef enum
+{
+    CY_SMIF_TX_NOT_LAST_BYTE = 0,
+    CY_SMIF_TX_LAST_BYTE = 1,
+} cy_en_smif_txfr_last_byte_t;
+
+typedef enum
+{
+    CY_SMIF_SLAVE_SELECT_0 = 1,
+} cy_en_smif_slave_select_t;
+
+typedef struct
+{
+    uint32_t command;
+    cy_en_smif_txfr_width_t cmdWidth;
+    cy_en_smif_txfr_width_t addrWidth;
+} cy_stc_smif_mem_cmd_t;
+
+typedef struct
+{
+    uint32_t numOfAddrBytes;
+    cy_stc_smif_mem_cmd_t *eraseCmd;
+    uint32_t eraseSize;
+    uint32_t eraseTime;
+} cy_stc_smif_mem_device_cfg_t;
+
+typedef struct
+{
+    cy_en_smif_slave_select_t slaveSelect;
+    cy_stc_smif_mem_device_cfg_t *deviceCfg;
+} cy_stc_smif_mem_config_t;
+
+cy_en_smif_status_t Cy_SMIF_TransmitCommand(SMIF_Type *base, uint8_t cmd,
+        cy_en_smif_txfr_width_t cmdTxfrWidth, uint8_t const cmdParam[], uint32_t paramSize,
+        cy_en_smif_txfr_width_t paramTxfrWidth, cy_en_smif_slave_select_t slaveSelect,
+        cy_en_smif_txfr_last_byte_t cmpltTxfr, cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_SendDummyCycles(SMIF_Type *base, uint32_t cycles);
+cy_en_smif_status_t Cy_SMIF_ReceiveDataBlocking(SMIF_Type *base, uint8_t *rxBuffer,
+        uint32_t size, cy_en_smif_txfr_width_t transferWidth, cy_stc_smif_context_t const *context);
+cy_en_smif_status_t Cy_SMIF_MemCmdWriteEnable(SMIF_Type *base,
+        cy_stc_smif_mem_config_t const *memDevice, cy_stc_smif_context_t const *context);
+bool Cy_SMIF_MemIsBusy(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+        cy_stc_smif_context_t const *context);
+
+/*******************************************************************************
+* System library
+********************************************************************************/
+extern uint32_t SystemCoreClock;
+
+void Cy_SysLib_Delay(uint32_t milliseconds);
+
+/*******************************************************************************
+* Watchdog
+********************************************************************************/
+void Cy_WDT_ClearWatchdog(void);
+
+#endif /* HOST_CY_PDL_H_ */
@@ -0,0 +1,534 @@
+/******************************************************************************
+ * File Name: smif_erase_test.c
+ *
+ * Description: Host test of the coalescing erase of the external memory
+ * (common/smif_erase.c). The erase-type tables are built from raw SFDP Basic
+ * Flash Parameter Table and 4-Byte Address Instruction Table DWORDs, and a
+ * range erase runs against a simulated memory behind the SMIF driver calls.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ *******************************************************************************/
+
+/* Standard headers. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Module under test. */
+#include "cy_pdl.h"
+#include "cy_smif_psoc6.h"
+#include "smif_erase.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of DWORDs of the Basic Flash Parameter Table given to the module. */
+#define TEST_BFPT_DWORDS            (10UL)
+
+/* Erase type of the Basic Flash Parameter Table: size exponent and opcode.
+ * DWORDs 8 and 9 hold two types each, the first one in the low half.
+ */
+#define BFPT_TYPE(exp, op)          ((uint32_t)(exp) | ((uint32_t)(op) << 8U))
+#define BFPT_TYPES(t1, t2)          ((t1) | ((t2) << 16U))
+
+/* DWORD 10: maximum time multiplier, then the typical time of each type as a
+ * count (5 bits) of units (2 bits: 1 ms, 16 ms, 128 ms, 1 s).
+ */
+#define BFPT_TIME(type, count, unit) ((((uint32_t)(count) - 1UL) | ((uint32_t)(unit) << 5U)) << \
+                                      (4UL + (7UL * ((type) - 1UL))))
+
+/* 4-Byte Address Instruction Table: support bit and opcode of each type. */
+#define FBAIT_SUPPORT(type)         (1UL << (8UL + (type)))
+#define FBAIT_OPCODE(type, op)      ((uint32_t)(op) << (8UL * ((type) - 1UL)))
+
+/* Simulated external memory: 2 MB, SFDP area of 256 bytes. */
+#define SIM_MEM_SIZE                (0x200000UL)
+#define SIM_SFDP_SIZE               (0x100UL)
+#define SIM_SFDP_BFPT_PTR           (0x30UL)
+#define SIM_ERASED_VAL              (0xFFU)
+
+/* Polls of the busy status before an erase completes. */
+#define SIM_BUSY_POLLS              (3UL)
+
+#define TEST_CHECK(cond, ...)       do { if (!(cond)) { printf("  FAIL: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+/*******************************************************************************
+* Global variables
+********************************************************************************/
+/* 4-KB sectors and 32-KB/64-KB blocks, 3-byte opcodes, listed out of order.
+ * Typical times: 4 KB 48 ms, 64 KB 256 ms, 32 KB 160 ms; maximum time
+ * multiplier 2 * (1 + 1).
+ */
+static const uint32_t bfpt_4k_32k_64k[TEST_BFPT_DWORDS] =
+{
+    [7] = BFPT_TYPES(BFPT_TYPE(12, 0x20), BFPT_TYPE(16, 0xD8)),
+    [8] = BFPT_TYPES(BFPT_TYPE(15, 0x52), 0UL),
+    [9] = 1UL | BFPT_TIME(1, 3, 1) | BFPT_TIME(2, 2, 2) | BFPT_TIME(3, 10, 1),
+};
+
+/* 4-byte opcodes of the same types. */
+static const uint32_t fbait_4k_32k_64k[2] =
+{
+    FBAIT_SUPPORT(1) | FBAIT_SUPPORT(2) | FBAIT_SUPPORT(3),
+    FBAIT_OPCODE(1, 0x21) | FBAIT_OPCODE(2, 0xDC) | FBAIT_OPCODE(3, 0x5C),
+};
+
+/* S25FL512S of the supported kits: uniform 256-KB sectors, a single type. */
+static const uint32_t bfpt_uniform_256k[TEST_BFPT_DWORDS] =
+{
+    [7] = BFPT_TYPES(BFPT_TYPE(18, 0xD8), 0UL),
+};
+
+static uint8_t sim_mem[SIM_MEM_SIZE];
+static uint8_t sim_sfdp[SIM_SFDP_SIZE];
+
+static SMIF_Type sim_smif;
+static cy_stc_smif_context_t sim_context;
+static cy_stc_smif_mem_cmd_t sim_erase_cmd = { .command = 0x20, .cmdWidth = CY_SMIF_WIDTH_SINGLE,
+                                               .addrWidth = CY_SMIF_WIDTH_SINGLE };
+static cy_stc_smif_mem_device_cfg_t sim_dev_cfg = { .numOfAddrBytes = 3, .eraseCmd = &sim_erase_cmd,
+                                                    .eraseSize = 0x1000, .eraseTime = 400 };
+static cy_stc_smif_mem_config_t sim_mem_cfg = { .slaveSelect = CY_SMIF_SLAVE_SELECT_0,
+                                                .deviceCfg = &sim_dev_cfg };
+
+/* State of the simulated memory. */
+static uint32_t sfdp_addr;
+static bool write_enabled;
+static uint32_t busy_polls;
+
+/* Counters of a scenario. */
+static uint32_t n_erases[3];
+static uint32_t n_backend_erases;
+static int failures;
+
+/*******************************************************************************
+* Simulated drivers
+********************************************************************************/
+SMIF_Type *qspi_get_device(void)
+{
+    return &sim_smif;
+}
+
+cy_stc_smif_context_t *qspi_get_context(void)
+{
+    return &sim_context;
+}
+
+cy_stc_smif_mem_config_t *qspi_get_memory_config(uint8_t index)
+{
+    TEST_CHECK(index == 0U, "memory configuration %u", (unsigned int)index);
+    return &sim_mem_cfg;
+}
+
+/* Index in n_erases[] of a 3-byte erase opcode, -1 if unknown. */
+static int sim_erase_index(uint8_t cmd, uint32_t *size)
+{
+    static const uint8_t opcodes[3] = { 0x20, 0x52, 0xD8 };
+    static const uint32_t sizes[3] = { 0x1000, 0x8000, 0x10000 };
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (opcodes[i] == cmd)
+        {
+            *size = sizes[i];
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+cy_en_smif_status_t Cy_SMIF_TransmitCommand(SMIF_Type *base, uint8_t cmd,
+        cy_en_smif_txfr_width_t cmdTxfrWidth, uint8_t const cmdParam[], uint32_t paramSize,
+        cy_en_smif_txfr_width_t paramTxfrWidth, cy_en_smif_slave_select_t slaveSelect,
+        cy_en_smif_txfr_last_byte_t cmpltTxfr, cy_stc_smif_context_t const *context)
+{
+    uint32_t addr = 0;
+    uint32_t size = 0;
+    uint32_t i;
+    int idx;
+
+    (void)base;
+    (void)cmdTxfrWidth;
+    (void)paramTxfrWidth;
+    (void)context;
+
+    TEST_CHECK(slaveSelect == CY_SMIF_SLAVE_SELECT_0, "slave select %u", (unsigned int)slaveSelect);
+    TEST_CHECK(busy_polls == 0UL, "command 0x%02x while the memory is busy", cmd);
+
+    for (i = 0; i < paramSize; i++)
+    {
+        addr = (addr << 8U) | cmdParam[i];
+    }
+
+    if (cmd == 0x5AU)
+    {
+        TEST_CHECK((paramSize == 3UL) && (cmpltTxfr == CY_SMIF_TX_NOT_LAST_BYTE), "Read SFDP command");
+        sfdp_addr = addr;
+        return CY_SMIF_SUCCESS;
+    }
+
+    idx = sim_erase_index(cmd, &size);
+    TEST_CHECK(idx >= 0, "unknown opcode 0x%02x", cmd);
+    TEST_CHECK(paramSize == sim_dev_cfg.numOfAddrBytes, "%u address bytes", (unsigned int)paramSize);
+    TEST_CHECK(write_enabled, "erase without write enable");
+
+    if ((idx < 0) || ((addr % size) != 0UL) || ((addr + size) > SIM_MEM_SIZE))
+    {
+        TEST_CHECK(false, "erase 0x%02x @ 0x%06x", cmd, (unsigned int)addr);
+        return CY_SMIF_SUCCESS;
+    }
+
+    memset(&sim_mem[addr], SIM_ERASED_VAL, size);
+    n_erases[idx]++;
+    write_enabled = false;
+    busy_polls = SIM_BUSY_POLLS;
+
+    return CY_SMIF_SUCCESS;
+}
+
+cy_en_smif_status_t Cy_SMIF_SendDummyCycles(SMIF_Type *base, uint32_t cycles)
+{
+    (void)base;
+    TEST_CHECK(cycles == 8UL, "%u dummy cycles", (unsigned int)cycles);
+    return CY_SMIF_SUCCESS;
+}
+
+cy_en_smif_status_t Cy_SMIF_ReceiveDataBlocking(SMIF_Type *base, uint8_t *rxBuffer,
+        uint32_t size, cy_en_smif_txfr_width_t transferWidth, cy_stc_smif_context_t const *context)
+{
+    (void)base;
+    (void)transferWidth;
+    (void)context;
+
+    TEST_CHECK((sfdp_addr + size) <= SIM_SFDP_SIZE, "SFDP read @ 0x%x", (unsigned int)sfdp_addr);
+    memcpy(rxBuffer, &sim_sfdp[sfdp_addr], size);
+    return CY_SMIF_SUCCESS;
+}
+
+cy_en_smif_status_t Cy_SMIF_MemCmdWriteEnable(SMIF_Type *base,
+        cy_stc_smif_mem_config_t const *memDevice, cy_stc_smif_context_t const *context)
+{
+    (void)base;
+    (void)memDevice;
+    (void)context;
+
+    write_enabled = true;
+    return CY_SMIF_SUCCESS;
+}
+
+bool Cy_SMIF_MemIsBusy(SMIF_Type *base, cy_stc_smif_mem_config_t const *memDevice,
+        cy_stc_smif_context_t const *context)
+{
+    (void)base;
+    (void)memDevice;
+    (void)context;
+
+    if (busy_polls != 0UL)
+    {
+        busy_polls--;
+        return true;
+    }
+
+    return false;
+}
+
+void Cy_SysLib_Delay(uint32_t milliseconds)
+{
+    (void)milliseconds;
+}
+
+/* Erase of the flash map backend: one erase sector of the SMIF driver at a time. */
+int __real_psoc6_smif_erase(off_t addr, size_t size)
+{
+    uint32_t mem_addr = (uint32_t)addr - CY_SMIF_BASE_MEM_OFFSET;
+
+    if (((mem_addr | (uint32_t)size) & (sim_dev_cfg.eraseSize - 1UL)) != 0UL)
+    {
+        mem_addr &= ~(sim_dev_cfg.eraseSize - 1UL);
+        size = ((size + sim_dev_cfg.eraseSize - 1UL) & ~(sim_dev_cfg.eraseSize - 1UL)) + sim_dev_cfg.eraseSize;
+    }
+
+    memset(&sim_mem[mem_addr], SIM_ERASED_VAL, size);
+    n_backend_erases++;
+    return 0;
+}
+
+/* SFDP area: header, parameter headers of the BFPT and of the 4BAIT, tables. */
+static void sim_sfdp_init(const uint32_t *bfpt, const uint32_t *fbait)
+{
+    uint8_t *hdr;
+
+    memset(sim_sfdp, 0xFF, sizeof(sim_sfdp));
+    memcpy(sim_sfdp, "SFDP", 4);
+    sim_sfdp[4] = 6U;
+    sim_sfdp[5] = 1U;
+    sim_sfdp[6] = 1U;
+
+    hdr = &sim_sfdp[8];
+    hdr[0] = 0x00U;
+    hdr[1] = 6U;
+    hdr[2] = 1U;
+    hdr[3] = 16U;
+    hdr[4] = (uint8_t)SIM_SFDP_BFPT_PTR;
+    hdr[5] = hdr[6] = 0U;
+    hdr[7] = 0xFFU;
+    memset(&sim_sfdp[SIM_SFDP_BFPT_PTR], 0, 16UL * sizeof(uint32_t));
+    memcpy(&sim_sfdp[SIM_SFDP_BFPT_PTR], bfpt, TEST_BFPT_DWORDS * sizeof(uint32_t));
+
+    hdr = &sim_sfdp[16];
+    hdr[0] = 0x84U;
+    hdr[1] = 0U;
+    hdr[2] = 1U;
+    hdr[3] = 2U;
+    hdr[4] = (uint8_t)(SIM_SFDP_BFPT_PTR + (16UL * sizeof(uint32_t)));
+    hdr[5] = hdr[6] = 0U;
+    hdr[7] = 0xFFU;
+    memcpy(&sim_sfdp[hdr[4]], fbait, 2UL * sizeof(uint32_t));
+}
+
+/*******************************************************************************
+* Scenarios
+********************************************************************************/
+static void check_type(const smif_erase_table_t *table, uint32_t i, uint32_t size,
+                       uint8_t cmd, uint32_t max_time_ms)
+{
+    if (i >= table->count)
+    {
+        TEST_CHECK(false, "type %u missing", (unsigned int)i);
+        return;
+    }
+
+    TEST_CHECK((table->types[i].size == size) && (table->types[i].cmd == cmd) &&
+               (table->types[i].max_time_ms == max_time_ms),
+               "type %u: size 0x%x cmd 0x%02x max %u ms, expected 0x%x 0x%02x %u ms", (unsigned int)i,
+               (unsigned int)table->types[i].size, table->types[i].cmd,
+               (unsigned int)table->types[i].max_time_ms, (unsigned int)size, cmd,
+               (unsigned int)max_time_ms);
+}
+
+static void test_build_table(void)
+{
+    smif_erase_table_t table;
+    uint32_t bfpt[TEST_BFPT_DWORDS];
+    uint32_t fbait[2];
+    cy_rslt_t result;
+
+    printf("smif_erase_build_table\n");
+
+    /* Sorted largest first; maximum time 4 * typical time. */
+    result = smif_erase_build_table(bfpt_4k_32k_64k, TEST_BFPT_DWORDS, NULL, 0, 3, 0x1000, &table);
+    TEST_CHECK((result == CY_RSLT_SUCCESS) && (table.count == 3UL), "3-byte: count %u", (unsigned int)table.count);
+    check_type(&table, 0, 0x10000, 0xD8, 1024);
+    check_type(&table, 1, 0x8000, 0x52, 640);
+    check_type(&table, 2, 0x1000, 0x20, 192);
+
+    /* Without DWORD 10, the maximum times are left to the caller. */
+    result = smif_erase_build_table(bfpt_4k_32k_64k, 9, NULL, 0, 3, 0x1000, &table);
+    TEST_CHECK((result == CY_RSLT_SUCCESS) && (table.count == 3UL), "9 DWORDs: count %u", (unsigned int)table.count);
+    check_type(&table, 0, 0x10000, 0xD8, 0);
+    check_type(&table, 2, 0x1000, 0x20, 0);
+
+    /* Types smaller than the erase size of the SMIF driver are left out. */
+    result = smif_erase_build_table(bfpt_4k_32k_64k, TEST_BFPT_DWORDS, NULL, 0, 3, 0x10000, &table);
+    TEST_CHECK((result == CY_RSLT_SUCCESS) && (table.count == 1UL), "64-KB minimum: count %u", (unsigned int)table.count);
+    check_type(&table, 0, 0x10000, 0xD8, 1024);
+
+    /* 4-byte addresses: opcodes of the 4BAIT. */
+    result = smif_erase_build_table(bfpt_4k_32k_64k, TEST_BFPT_DWORDS, fbait_4k_32k_64k, 2, 4, 0x1000, &table);
+    TEST_CHECK((result == CY_RSLT_SUCCESS) && (table.count == 3UL), "4BAIT: count %u", (unsigned int)table.count);
+    check_type(&table, 0, 0x10000, 0xDC, 1024);
+    check_type(&table, 1, 0x8000, 0x5C, 640);
+    check_type(&table, 2, 0x1000, 0x21, 192);
+
+    /* A type without a 4-byte opcode is left out. */
+    memcpy(fbait, fbait_4k_32k_64k, sizeof(fbait));
+    fbait[0] &= ~FBAIT_SUPPORT(3);
+    result = smif_erase_build_table(bfpt_4k_32k_64k, TEST_BFPT_DWORDS, fbait, 2, 4, 0x1000, &table);
+    TEST_CHECK((result == CY_RSLT_SUCCESS) && (table.count == 2UL), "4BAIT without 32 KB: count %u", (unsigned int)table.count);
+    check_type(&table, 0, 0x10000, 0xDC, 1024);
+    check_type(&table, 1, 0x1000, 0x21, 192);
+
+    /* 4-byte addresses without a 4BAIT: the 3-byte opcodes are returned, and
+     * smif_erase() falls back as they don't match the command of the driver.
+     */
+    result = smif_erase_build_table(bfpt_4k_32k_64k, TEST_BFPT_DWORDS, NULL, 0, 4, 0x1000, &table);
+    TEST_CHECK((result == CY_RSLT_SUCCESS) && (table.count == 3UL), "no 4BAIT: count %u", (unsigned int)table.count);
+    check_type(&table, 2, 0x1000, 0x20, 192);
+
+    /* A second type of the same size is ignored. */
+    memcpy(bfpt, bfpt_4k_32k_64k, sizeof(bfpt));
+    bfpt[8] = BFPT_TYPES(BFPT_TYPE(15, 0x52), BFPT_TYPE(12, 0x81));
+    result = smif_erase_build_table(bfpt, 9, NULL, 0, 3, 0x1000, &table);
+    TEST_CHECK((result == CY_RSLT_SUCCESS) && (table.count == 3UL), "same size: count %u", (unsigned int)table.count);
+    check_type(&table, 2, 0x1000, 0x20, 0);
+
+    /* Invalid size exponents are skipped. */
+    bfpt[8] = BFPT_TYPES(BFPT_TYPE(32, 0x52), BFPT_TYPE(0, 0x81));
+    result = smif_erase_build_table(bfpt, 9, NULL, 0, 3, 0x1000, &table);
+    TEST_CHECK((result == CY_RSLT_SUCCESS) && (table.count == 2UL), "invalid exponents: count %u", (unsigned int)table.count);
+
+    /* S25FL512S: one type, so smif_erase() always leaves the erases to the
+     * flash map backend (erase_table.count < 2).
+     */
+    result = smif_erase_build_table(bfpt_uniform_256k, TEST_BFPT_DWORDS, NULL, 0, 3, 0x40000, &table);
+    TEST_CHECK((result == CY_RSLT_SUCCESS) && (table.count == 1UL), "uniform 256 KB: count %u", (unsigned int)table.count);
+    check_type(&table, 0, 0x40000, 0xD8, 0);
+
+    /* No usable type, or a table too short for the erase types. */
+    memset(bfpt, 0, sizeof(bfpt));
+    result = smif_erase_build_table(bfpt, TEST_BFPT_DWORDS, NULL, 0, 3, 0x1000, &table);
+    TEST_CHECK((result != CY_RSLT_SUCCESS) && (table.count == 0UL), "no type: result 0x%x", (unsigned int)result);
+    result = smif_erase_build_table(bfpt_4k_32k_64k, 8, NULL, 0, 3, 0x1000, &table);
+    TEST_CHECK((result != CY_RSLT_SUCCESS) && (table.count == 0UL), "8 DWORDs: result 0x%x", (unsigned int)result);
+}
+
+/* Splits a range with smif_erase_next() and counts the types used. */
+static void walk(const smif_erase_table_t *table, uint32_t addr, uint32_t len,
+                 uint32_t n_64k, uint32_t n_32k, uint32_t n_4k)
+{
+    const smif_erase_type_t *type;
+    uint32_t n[3] = { 0 };
+    uint32_t i;
+
+    while (len != 0UL)
+    {
+        type = smif_erase_next(table, addr, len);
+        if (type == NULL)
+        {
+            TEST_CHECK(false, "no type @ 0x%06x", (unsigned int)addr);
+            return;
+        }
+
+        TEST_CHECK(((addr % type->size) == 0UL) && (type->size <= len), "0x%x @ 0x%06x",
+                   (unsigned int)type->size, (unsigned int)addr);
+
+        /* The largest aligned type that fits. */
+        for (i = 0; i < table->count; i++)
+        {
+            if (table->types[i].size <= type->size)
+            {
+                break;
+            }
+            TEST_CHECK(((addr % table->types[i].size) != 0UL) || (table->types[i].size > len),
+                       "0x%x @ 0x%06x instead of 0x%x", (unsigned int)type->size, (unsigned int)addr,
+                       (unsigned int)table->types[i].size);
+        }
+
+        n[(type->size == 0x10000UL) ? 0 : ((type->size == 0x8000UL) ? 1 : 2)]++;
+        addr += type->size;
+        len -= type->size;
+    }
+
+    TEST_CHECK((n[0] == n_64k) && (n[1] == n_32k) && (n[2] == n_4k),
+               "%u x 64 KB, %u x 32 KB, %u x 4 KB", (unsigned int)n[0], (unsigned int)n[1], (unsigned int)n[2]);
+}
+
+static void test_next(void)
+{
+    smif_erase_table_t table;
+
+    printf("smif_erase_next\n");
+
+    (void)smif_erase_build_table(bfpt_4k_32k_64k, TEST_BFPT_DWORDS, NULL, 0, 3, 0x1000, &table);
+
+    TEST_CHECK(smif_erase_next(&table, 0x000800, 0x1000) == NULL, "unaligned address");
+    TEST_CHECK(smif_erase_next(&table, 0x001000, 0x0800) == NULL, "short range");
+    TEST_CHECK(smif_erase_next(&table, 0x001000, 0) == NULL, "empty range");
+
+    walk(&table, 0x000000, 0x1C0000, 28, 0, 0);
+    walk(&table, 0x001000, 0x1BE000, 26, 2, 14);
+    walk(&table, 0x03F000, 0x003000, 0, 0, 3);
+    walk(&table, 0x010000, 0x009000, 0, 1, 1);
+}
+
+static void test_erase(void)
+{
+    static const struct { uint32_t addr; uint32_t len; uint32_t n_64k; uint32_t n_32k; uint32_t n_4k;
+                          uint32_t n_backend; } ranges[] =
+    {
+        { 0x000000, 0x1C0000, 28, 0, 0, 0 },
+        { 0x001000, 0x1BE000, 26, 2, 14, 0 },
+        { 0x1FF000, 0x001000, 0, 0, 1, 0 },
+        { 0x000800, 0x001000, 0, 0, 0, 1 },
+    };
+    uint32_t i, j;
+    int rc;
+
+    printf("smif_erase, 3-byte 4 KB/32 KB/64 KB\n");
+
+    sim_sfdp_init(bfpt_4k_32k_64k, fbait_4k_32k_64k);
+
+    for (i = 0; i < (sizeof(ranges) / sizeof(ranges[0])); i++)
+    {
+        memset(sim_mem, 0, sizeof(sim_mem));
+        memset(n_erases, 0, sizeof(n_erases));
+        n_backend_erases = 0;
+
+        rc = smif_erase((off_t)(CY_SMIF_BASE_MEM_OFFSET + ranges[i].addr), ranges[i].len);
+
+        TEST_CHECK(rc == 0, "0x%06x+0x%x: rc %d", (unsigned int)ranges[i].addr, (unsigned int)ranges[i].len, rc);
+        TEST_CHECK((n_erases[2] == ranges[i].n_64k) && (n_erases[1] == ranges[i].n_32k) &&
+                   (n_erases[0] == ranges[i].n_4k) && (n_backend_erases == ranges[i].n_backend),
+                   "0x%06x+0x%x: %u x 64 KB, %u x 32 KB, %u x 4 KB, %u backend", (unsigned int)ranges[i].addr,
+                   (unsigned int)ranges[i].len, (unsigned int)n_erases[2], (unsigned int)n_erases[1],
+                   (unsigned int)n_erases[0], (unsigned int)n_backend_erases);
+
+        /* The range is erased, and only the range for the SFDP erases. */
+        for (j = 0; j < SIM_MEM_SIZE; j++)
+        {
+            if (((j >= ranges[i].addr) && (j < (ranges[i].addr + ranges[i].len)) &&
+                 (sim_mem[j] != SIM_ERASED_VAL)) ||
+                ((ranges[i].n_backend == 0UL) && ((j < ranges[i].addr) || (j >= (ranges[i].addr + ranges[i].len))) &&
+                 (sim_mem[j] != 0U)))
+            {
+                TEST_CHECK(false, "0x%06x+0x%x: byte @ 0x%06x", (unsigned int)ranges[i].addr,
+                           (unsigned int)ranges[i].len, (unsigned int)j);
+                break;
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    test_build_table();
+    test_next();
+    test_erase();
+
+    printf("\n%s\n", (failures == 0) ? "All scenarios passed" : "FAILED");
+
+    return (failures == 0) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -64,6 +64,7 @@
 
 /* Local includes. */
 #include "state_mgr.h"
+#include "boot_record.h"
 
 /* AWS library includes. */
 #include "iot_system_init.h"
@@ -146,6 +147,9 @@ static void prvMiscInitialization(void)
     printf("\r\n**Booting to Factory Application ");
     printf("Version: %d.%d.%d ** \r\n \r\n", APP_VERSION_MAJOR,
             APP_VERSION_MINOR, APP_VERSION_BUILD);
+
+    /* Print the boot timings handed over by the bootloader. */
+    boot_record_print();
 }
 
 /**